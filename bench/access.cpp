@@ -0,0 +1,125 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// access.cpp - element access: operator() with an index list, chained
+// operator[], operator() with the indices as arguments, and a raw
+// pointer walk of the same elements for comparison.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+
+namespace {
+
+using bench::index;
+using bench::size_type;
+
+template <typename T, std::size_t NumDims>
+void paren(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const boost::multi_array<T,NumDims>& ca = a;
+  const size_type* extents = a.shape();
+  const index last = index(extents[NumDims - 1]);
+  while (s.keep_running()) {
+    T sum = T();
+    boost::array<index,NumDims> idx;
+    idx.assign(0);
+    do {
+      for (idx[NumDims - 1] = 0; idx[NumDims - 1] != last;
+           ++idx[NumDims - 1])
+        sum += ca(idx);
+    } while (bench::next_row<NumDims>(idx,extents));
+    bench::keep(sum);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+void brackets(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const boost::multi_array<T,NumDims>& ca = a;
+  const size_type* extents = a.shape();
+  const index last = index(extents[NumDims - 1]);
+  while (s.keep_running()) {
+    T sum = T();
+    boost::array<index,NumDims> idx;
+    idx.assign(0);
+    do {
+      for (idx[NumDims - 1] = 0; idx[NumDims - 1] != last;
+           ++idx[NumDims - 1])
+        sum += bench::chained<NumDims>::get(ca,idx.data());
+    } while (bench::next_row<NumDims>(idx,extents));
+    bench::keep(sum);
+  }
+  s.set_items(a.num_elements());
+}
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+template <typename T, std::size_t NumDims>
+void indices(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const boost::multi_array<T,NumDims>& ca = a;
+  const size_type* extents = a.shape();
+  const index last = index(extents[NumDims - 1]);
+  while (s.keep_running()) {
+    T sum = T();
+    boost::array<index,NumDims> idx;
+    idx.assign(0);
+    do {
+      for (idx[NumDims - 1] = 0; idx[NumDims - 1] != last;
+           ++idx[NumDims - 1])
+        sum += bench::unpacked<NumDims>::get(ca,idx.data());
+    } while (bench::next_row<NumDims>(idx,extents));
+    bench::keep(sum);
+  }
+  s.set_items(a.num_elements());
+}
+#endif
+
+template <typename T, std::size_t NumDims>
+void pointer(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const size_type* extents = a.shape();
+  const index* strides = a.strides();
+  const index last = index(extents[NumDims - 1]);
+  while (s.keep_running()) {
+    T sum = T();
+    boost::array<index,NumDims> idx;
+    idx.assign(0);
+    do {
+      const T* row = a.origin();
+      for (std::size_t n = 0; n + 1 < NumDims; ++n)
+        row += idx[n] * strides[n];
+      for (index i = 0; i != last; ++i)
+        sum += row[i];
+    } while (bench::next_row<NumDims>(idx,extents));
+    bench::keep(sum);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"paren",NumDims,type,&paren<T,NumDims>);
+    bench::add_sizes<T>(group,"brackets",NumDims,type,&brackets<T,NumDims>);
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    bench::add_sizes<T>(group,"indices",NumDims,type,&indices<T,NumDims>);
+#endif
+    bench::add_sizes<T>(group,"pointer",NumDims,type,&pointer<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("access"), true);
+
+} // unnamed namespace
@@ -0,0 +1,128 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_BENCH_ARRAYS_HPP
+#define BOOST_MULTI_ARRAY_BENCH_ARRAYS_HPP
+
+//
+// arrays.hpp - shapes, contents and rank-independent loops for the
+// benchmarks.
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/array.hpp>
+#include <cstddef>
+
+namespace bench {
+
+typedef boost::multi_array_types::index index;
+typedef boost::multi_array_types::size_type size_type;
+
+// The extents of an array of about the given number of elements, as
+// close to a cube as whole extents allow.
+template <std::size_t NumDims>
+boost::array<size_type,NumDims> cube(std::size_t elements) {
+  size_type side = 1;
+  for (;;) {
+    size_type volume = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      volume *= side + 1;
+    if (volume > elements)
+      break;
+    ++side;
+  }
+  boost::array<size_type,NumDims> extents;
+  extents.assign(side);
+  size_type rest = 1;
+  for (std::size_t n = 0; n + 1 < NumDims; ++n)
+    rest *= side;
+  extents[NumDims - 1] = elements / rest == 0 ? 1 : elements / rest;
+  return extents;
+}
+
+// Gives the elements distinct values.
+template <typename Array>
+void iota(Array& a) {
+  typedef typename Array::element element;
+  for (std::size_t i = 0; i != a.num_elements(); ++i)
+    a.data()[i] = element(i % 1000);
+}
+
+// Steps idx to the start of the next row (every index but the last),
+// returning false after the last row.
+template <std::size_t NumDims>
+bool next_row(boost::array<index,NumDims>& idx, const size_type* extents) {
+  for (std::size_t n = NumDims - 1; n != 0; --n) {
+    if (size_type(++idx[n - 1]) != extents[n - 1])
+      return true;
+    idx[n - 1] = 0;
+  }
+  return false;
+}
+
+// a[idx[0]][idx[1]]...[idx[K-1]]
+template <std::size_t K>
+struct chained {
+  template <typename Array>
+  static typename Array::element get(const Array& a, const index* idx) {
+    return chained<K - 1>::get(a[idx[0]],idx + 1);
+  }
+};
+
+template <>
+struct chained<1> {
+  template <typename Array>
+  static typename Array::element get(const Array& a, const index* idx) {
+    return a[idx[0]];
+  }
+};
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+// a(idx[0],idx[1],...,idx[K-1])
+template <std::size_t K>
+struct unpacked {
+  template <typename Array, typename... Indices>
+  static typename Array::element get(const Array& a, const index* idx,
+                                     Indices... indices) {
+    return unpacked<K - 1>::get(a,idx + 1,indices...,idx[0]);
+  }
+};
+
+template <>
+struct unpacked<0> {
+  template <typename Array, typename... Indices>
+  static typename Array::element get(const Array& a, const index*,
+                                     Indices... indices) {
+    return a(indices...);
+  }
+};
+#endif
+
+// indices[range(1,extent-1)]... over every dimension: a view of all but
+// the border elements
+template <std::size_t K>
+struct interior {
+  typedef boost::detail::multi_array::index_gen<K,K> type;
+
+  static type get(const size_type* extents) {
+    typedef boost::multi_array_types::index_range range;
+    const index last = index(extents[K - 1]);
+    return interior<K - 1>::get(extents)[last > 2 ? range(1,last - 1) :
+                                                    range(0,last)];
+  }
+};
+
+template <>
+struct interior<0> {
+  typedef boost::detail::multi_array::index_gen<0,0> type;
+
+  static type get(const size_type*) { return type(); }
+};
+
+} // namespace bench
+
+#endif
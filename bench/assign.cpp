@@ -0,0 +1,61 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// assign.cpp - assignment between arrays of the same and of different
+// storage orders.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+
+namespace {
+
+template <typename T, std::size_t NumDims>
+void same_order(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  const boost::array<bench::size_type,NumDims> extents =
+    bench::cube<NumDims>(s.elements());
+  array a(extents);
+  array b(extents);
+  bench::iota(a);
+  while (s.keep_running()) {
+    b = a;
+    bench::keep(b.data()[0]);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+void fortran_to_c(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  const boost::array<bench::size_type,NumDims> extents =
+    bench::cube<NumDims>(s.elements());
+  array a(extents,boost::fortran_storage_order());
+  array b(extents);
+  bench::iota(a);
+  while (s.keep_running()) {
+    b = a;
+    bench::keep(b.data()[0]);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"same_order",NumDims,type,
+                        &same_order<T,NumDims>);
+    bench::add_sizes<T>(group,"fortran_to_c",NumDims,type,
+                        &fortran_to_c<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("assign"), true);
+
+} // unnamed namespace
@@ -0,0 +1,55 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// compare.cpp - operator== and operator< between equal arrays, which
+// visit every element.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+
+namespace {
+
+template <typename T, std::size_t NumDims>
+void equal(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  array a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const array b = a;
+  while (s.keep_running()) {
+    bench::clobber();
+    bench::keep(a == b);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+void less(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  array a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const array b = a;
+  while (s.keep_running()) {
+    bench::clobber();
+    bench::keep(a < b);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"equal",NumDims,type,&equal<T,NumDims>);
+    bench::add_sizes<T>(group,"less",NumDims,type,&less<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("compare"), true);
+
+} // unnamed namespace
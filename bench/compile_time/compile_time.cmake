@@ -0,0 +1,94 @@
+# Use, modification and distribution is subject to the Boost Software
+# License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+#
+# compile_time.cmake - times the compilation of views.cpp at each rank
+# and view count, reporting the fastest of REPETITIONS compilations:
+#
+#   cmake -DCXX=g++ "-DFLAGS=-std=c++11;-O2" "-DINCLUDES=include;/boost"
+#         [-DRANKS=1;2;3] [-DVIEWS=1;16] [-DREPETITIONS=3]
+#         [-DJSON=compile_time.json] -P compile_time.cmake
+#
+# The multi_array_compile_time target of bench/CMakeLists.txt runs it
+# with the compiler and flags of the build.
+
+cmake_minimum_required(VERSION 3.23)    # string(TIMESTAMP) with %f
+
+if(NOT CXX)
+  message(FATAL_ERROR "compile_time.cmake: CXX is not set")
+endif()
+if(NOT RANKS)
+  set(RANKS 1 2 3 4 5 6)
+endif()
+if(NOT VIEWS)
+  set(VIEWS 1 16 64)
+endif()
+if(NOT REPETITIONS)
+  set(REPETITIONS 3)
+endif()
+
+set(source ${CMAKE_CURRENT_LIST_DIR}/views.cpp)
+set(include_flags)
+foreach(dir IN LISTS INCLUDES)
+  list(APPEND include_flags -I${dir})
+endforeach()
+if(CMAKE_HOST_WIN32)
+  set(object NUL)
+else()
+  set(object /dev/null)
+endif()
+
+# The time since the epoch, in microseconds.
+function(now var)
+  string(TIMESTAMP result "%s%f" UTC)
+  set(${var} ${result} PARENT_SCOPE)
+endfunction()
+
+list(JOIN FLAGS " " flags)
+message(STATUS "compiler: ${CXX} ${flags}")
+message(STATUS "rank   views        ms")
+set(entries)
+foreach(rank IN LISTS RANKS)
+  foreach(views IN LISTS VIEWS)
+    set(best)
+    foreach(repetition RANGE 1 ${REPETITIONS})
+      now(start)
+      execute_process(
+        COMMAND ${CXX} ${FLAGS} ${include_flags}
+                -DBENCH_RANK=${rank} -DBENCH_VIEWS=${views}
+                -c ${source} -o ${object}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors)
+      now(stop)
+      if(NOT result EQUAL 0)
+        message(FATAL_ERROR
+          "compiling views.cpp at rank ${rank}, ${views} views failed:\n"
+          "${errors}")
+      endif()
+      math(EXPR elapsed "(${stop} - ${start}) / 1000")
+      if(NOT best OR elapsed LESS best)
+        set(best ${elapsed})
+      endif()
+    endforeach()
+    string(LENGTH "${views}" width)
+    math(EXPR padding "5 - ${width}")
+    string(REPEAT " " ${padding} pad)
+    string(LENGTH "${best}" width)
+    math(EXPR padding "10 - ${width}")
+    string(REPEAT " " ${padding} pad2)
+    message(STATUS "${rank}      ${pad}${views}${pad2}${best}")
+    list(APPEND entries
+      "    {\"rank\": ${rank}, \"views\": ${views}, \"ms\": ${best}}")
+  endforeach()
+endforeach()
+
+if(JSON)
+  list(JOIN entries ",\n" body)
+  string(REPLACE "\"" "\\\"" command "${CXX} ${flags}")
+  file(WRITE ${JSON}
+    "{\n  \"context\": {\n"
+    "    \"library\": \"Boost.MultiArray\",\n"
+    "    \"command\": \"${command}\",\n"
+    "    \"repetitions\": ${REPETITIONS}\n"
+    "  },\n  \"compile_times\": [\n${body}\n  ]\n}\n")
+endif()
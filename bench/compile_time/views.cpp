@@ -0,0 +1,111 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// views.cpp - a synthetic translation unit for measuring compile times:
+// BENCH_VIEWS functions, each making two rank BENCH_RANK arrays of its
+// own element type and assigning a view of one to a view of the other.  The views also differ in which
+// dimensions are kept by a range and which are fixed by an index (a
+// rank N array has 2^N - 1 such patterns).  So every function
+// instantiates the array, view, sub_array and iterator templates afresh,
+// as code using many different arrays does.
+//
+// compile_time.cmake compiles this file with the ranks and view counts
+// to measure.
+//
+
+#include <boost/multi_array.hpp>
+#include <cstddef>
+
+#ifndef BENCH_RANK
+#define BENCH_RANK 3
+#endif
+
+#ifndef BENCH_VIEWS
+#define BENCH_VIEWS 16
+#endif
+
+namespace {
+
+typedef boost::multi_array_types::index index;
+typedef boost::multi_array_types::index_range range;
+
+const std::size_t rank = BENCH_RANK;
+const unsigned patterns = (1u << rank) - 1;
+
+template <unsigned J>
+struct value {
+  value() : v(0) { }
+  double v;
+};
+
+// a range when Range is true, otherwise an index
+template <bool Range> struct pick;
+template <> struct pick<true> {
+  static range get() { return range(0,2); }
+};
+template <> struct pick<false> {
+  static index get() { return 1; }
+};
+
+// indices[...] over the first K dimensions, where bit k of Pattern tells
+// whether dimension k is a range
+template <unsigned Pattern, std::size_t K>
+struct selection {
+  static const bool is_range = ((Pattern >> (K - 1)) & 1) != 0;
+  static const std::size_t dims =
+    selection<Pattern,K - 1>::dims + (is_range ? 1 : 0);
+  typedef boost::detail::multi_array::index_gen<K,dims> type;
+
+  static type get() {
+    return selection<Pattern,K - 1>::get()[pick<is_range>::get()];
+  }
+};
+
+template <unsigned Pattern>
+struct selection<Pattern,0> {
+  static const std::size_t dims = 0;
+  typedef boost::detail::multi_array::index_gen<0,0> type;
+
+  static type get() { return type(); }
+};
+
+template <unsigned I>
+double view_sum() {
+  typedef value<I> element;
+  typedef selection<I % patterns + 1,rank> select;
+  typedef boost::multi_array<element,rank> array;
+
+  boost::array<std::size_t,rank> shape;
+  shape.assign(3);
+  array a(shape);
+  array b(shape);
+  typename array::template array_view<select::dims>::type v =
+    a[select::get()];
+  v = b[select::get()];
+  double sum = 0;
+  for (typename array::template array_view<select::dims>::type::iterator
+         i = v.begin(); i != v.end(); ++i)
+    sum += double(i - v.begin());
+  return sum + v.origin()->v + double(v.num_elements());
+}
+
+template <unsigned I>
+struct views {
+  static double sum() { return view_sum<I - 1>() + views<I - 1>::sum(); }
+};
+
+template <>
+struct views<0> {
+  static double sum() { return 0; }
+};
+
+} // unnamed namespace
+
+int main() {
+  return views<BENCH_VIEWS>::sum() > 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// harness.cpp - the benchmark registry and the timing loop; see
+// harness.hpp.
+//
+
+#include "harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+double now() {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const working_set sets[] = {
+  { "L1", 16 * 1024 },
+  { "L2", 256 * 1024 },
+  { "L3", 4 * 1024 * 1024 },
+  { "DRAM", 64 * 1024 * 1024 }
+};
+
+volatile const void* escaped;
+
+// Runs b once with the given number of iterations.
+state run_once(const benchmark& b, std::size_t iterations) {
+  state s(b.elements,iterations);
+  b.run(s);
+  return s;
+}
+
+} // unnamed namespace
+
+void state::start() { start_ = now(); }
+void state::stop() { seconds_ = now() - start_; }
+
+std::vector<benchmark>& registry() {
+  static std::vector<benchmark> benchmarks;
+  return benchmarks;
+}
+
+const working_set* working_sets() { return sets; }
+std::size_t num_working_sets() { return sizeof(sets) / sizeof(sets[0]); }
+
+benchmark make_benchmark(const std::string& group, const std::string& variant,
+                         std::size_t rank, const std::string& type,
+                         const std::string& size, std::size_t elements,
+                         function f) {
+  std::ostringstream name;
+  name << group << '/' << variant << "/rank" << rank << '/' << type << '/'
+       << size;
+  benchmark b;
+  b.name = name.str();
+  b.group = group;
+  b.variant = variant;
+  b.rank = rank;
+  b.type = type;
+  b.size = size;
+  b.elements = elements;
+  b.run = f;
+  return b;
+}
+
+void add(const std::string& group, const std::string& variant,
+         std::size_t rank, const std::string& type, const std::string& size,
+         std::size_t elements, function f) {
+  registry().push_back(make_benchmark(group,variant,rank,type,size,elements,
+                                      f));
+}
+
+result measure(const benchmark& b, double min_time, std::size_t repetitions) {
+  // Double the iterations until a run takes a tenth of the minimum
+  // time, then scale up to the minimum.
+  std::size_t iterations = 1;
+  state s = run_once(b,iterations);
+  while (s.seconds() < min_time / 10) {
+    iterations *= 2;
+    s = run_once(b,iterations);
+  }
+  if (s.seconds() < min_time)
+    iterations = std::size_t(double(iterations) * min_time / s.seconds()) + 1;
+
+  std::vector<double> times;
+  for (std::size_t r = 0; r != repetitions; ++r) {
+    s = run_once(b,iterations);
+    times.push_back(s.seconds() / double(iterations));
+  }
+  std::sort(times.begin(),times.end());
+
+  result res;
+  res.bench = &b;
+  res.iterations = iterations;
+  res.items = s.items();
+  res.best = times.front();
+  res.median = times[times.size() / 2];
+  return res;
+}
+
+std::string json_string(const std::string& text) {
+  std::string result = "\"";
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    if (text[i] == '"' || text[i] == '\\')
+      result += '\\';
+    result += text[i];
+  }
+  return result + "\"";
+}
+
+bool starts_with(const char* arg, const char* prefix, const char*& value) {
+  const std::size_t length = std::strlen(prefix);
+  if (std::strncmp(arg,prefix,length) != 0)
+    return false;
+  value = arg + length;
+  return true;
+}
+
+void escape(const void* p) { escaped = p; }
+
+} // namespace bench
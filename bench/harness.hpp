@@ -0,0 +1,217 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_BENCH_HARNESS_HPP
+#define BOOST_MULTI_ARRAY_BENCH_HARNESS_HPP
+
+//
+// harness.hpp - a small microbenchmark harness for the benchmarks in
+// this directory.
+//
+// A benchmark is a function taking a bench::state, which sets up its
+// data and then runs the code to measure in a keep_running() loop:
+//
+//   template <typename T, std::size_t NumDims>
+//   void sum_elements(bench::state& s) {
+//     boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+//     while (s.keep_running())
+//       bench::keep(std::accumulate(a.data(),a.data() + a.num_elements(),
+//                                   T()));
+//     s.set_items(a.num_elements());
+//   }
+//
+// Only the loop is timed.  The harness picks the number of iterations so
+// that one run takes at least the minimum time, repeats the run and
+// reports the fastest and the median, per iteration and per item.
+//
+// Benchmarks are registered at static initialization, usually through
+// register_suite<Suite>(), which calls Suite<T,NumDims>::add(group) for
+// every element type and rank the suite is run for; add() then calls
+// bench::add() for each of its cases and each working set size (from
+// the L1 cache to main memory).
+//
+// The program (main.cpp) takes
+//   --filter=text    run only the benchmarks whose name contains text
+//   --json=file      write the results as JSON to file ("-": stdout)
+//   --min-time=ms    the minimum time of one run (default 20)
+//   --repetitions=n  runs per benchmark (default 5)
+//   --quick          only the working sets that fit in cache
+//   --list           list the benchmarks without running them
+// and prints a table of the results.
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+class state {
+public:
+  state(std::size_t elements, std::size_t iterations) :
+    elements_(elements), iterations_(iterations), remaining_(iterations),
+    items_(1), started_(false), seconds_(0) { }
+
+  // the working set size, in elements
+  std::size_t elements() const { return elements_; }
+  std::size_t iterations() const { return iterations_; }
+
+  // true once for each iteration; the first call starts the timer and
+  // the last stops it
+  bool keep_running() {
+    if (!started_) {
+      start();
+      started_ = true;
+    }
+    if (remaining_ != 0) {
+      --remaining_;
+      return true;
+    }
+    stop();
+    return false;
+  }
+
+  // the items (usually elements) one iteration processes
+  void set_items(std::size_t items) { items_ = items; }
+  std::size_t items() const { return items_; }
+
+  double seconds() const { return seconds_; }
+
+private:
+  void start();
+  void stop();
+
+  std::size_t elements_;
+  std::size_t iterations_;
+  std::size_t remaining_;
+  std::size_t items_;
+  bool started_;
+  double start_;
+  double seconds_;
+};
+
+typedef void (*function)(state&);
+
+struct benchmark {
+  std::string name;         // group/case/rank/type/size
+  std::string group;
+  std::string variant;
+  std::size_t rank;
+  std::string type;
+  std::string size;         // "L1", "L2", "L3" or "DRAM"
+  std::size_t elements;
+  function run;
+};
+
+std::vector<benchmark>& registry();
+
+// the working set sizes, in bytes, and their names
+struct working_set {
+  const char* name;
+  std::size_t bytes;
+};
+
+const working_set* working_sets();
+std::size_t num_working_sets();
+
+// Builds a benchmark named group/variant/rank<rank>/type/size.
+benchmark make_benchmark(const std::string& group, const std::string& variant,
+                         std::size_t rank, const std::string& type,
+                         const std::string& size, std::size_t elements,
+                         function f);
+
+// Adds a benchmark to the registry.
+void add(const std::string& group, const std::string& variant,
+         std::size_t rank, const std::string& type, const std::string& size,
+         std::size_t elements, function f);
+
+// Adds f once for each working set size.
+template <typename T>
+void add_sizes(const std::string& group, const std::string& variant,
+               std::size_t rank, const std::string& type, function f) {
+  for (std::size_t i = 0; i != num_working_sets(); ++i)
+    add(group,variant,rank,type,working_sets()[i].name,
+        working_sets()[i].bytes / sizeof(T),f);
+}
+
+template <typename T> struct type_name;
+template <> struct type_name<float> {
+  static const char* get() { return "float"; }
+};
+template <> struct type_name<double> {
+  static const char* get() { return "double"; }
+};
+template <> struct type_name<int> {
+  static const char* get() { return "int"; }
+};
+template <> struct type_name<char> {
+  static const char* get() { return "char"; }
+};
+
+// Calls Suite<T,NumDims>::add(group) for the element types and ranks
+// the suites are run for: float and double, ranks 1 to 6.
+template <template <typename, std::size_t> class Suite>
+void register_suite(const char* group) {
+  Suite<float,1>::add(group);
+  Suite<float,2>::add(group);
+  Suite<float,3>::add(group);
+  Suite<float,4>::add(group);
+  Suite<float,5>::add(group);
+  Suite<float,6>::add(group);
+  Suite<double,1>::add(group);
+  Suite<double,2>::add(group);
+  Suite<double,3>::add(group);
+  Suite<double,4>::add(group);
+  Suite<double,5>::add(group);
+  Suite<double,6>::add(group);
+}
+
+// The timing of a benchmark: the iterations of one run, and the time of
+// one iteration in the fastest and in the median run, in seconds.
+struct result {
+  const benchmark* bench;
+  std::size_t iterations;
+  std::size_t items;
+  double best;
+  double median;
+};
+
+// Runs b for at least min_time seconds (calibrating the iterations
+// first) the given number of times.
+result measure(const benchmark& b, double min_time, std::size_t repetitions);
+
+// text as a JSON string
+std::string json_string(const std::string& text);
+
+// Whether the command line argument arg starts with prefix; if so,
+// value is set to the rest of arg.
+bool starts_with(const char* arg, const char* prefix, const char*& value);
+
+// Keeps the compiler from discarding a result as unused.
+void escape(const void* p);
+
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+  __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+  escape(&value);
+#endif
+}
+
+// Makes the compiler assume that memory may have changed.
+inline void clobber() {
+#if defined(__GNUC__)
+  __asm__ __volatile__("" : : : "memory");
+#else
+  escape(0);
+#endif
+}
+
+} // namespace bench
+
+#endif
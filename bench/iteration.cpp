@@ -0,0 +1,75 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// iteration.cpp - traversal with nested iterators, against
+// std::accumulate over data().
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+#include <numeric>
+
+namespace {
+
+// Sums the elements of a through an iterator for every dimension.
+template <std::size_t K>
+struct iterate {
+  template <typename Array, typename T>
+  static void sum(const Array& a, T& total) {
+    typedef typename Array::const_iterator iterator;
+    for (iterator i = a.begin(), end = a.end(); i != end; ++i)
+      iterate<K - 1>::sum(*i,total);
+  }
+};
+
+template <>
+struct iterate<1> {
+  template <typename Array, typename T>
+  static void sum(const Array& a, T& total) {
+    typedef typename Array::const_iterator iterator;
+    for (iterator i = a.begin(), end = a.end(); i != end; ++i)
+      total += *i;
+  }
+};
+
+template <typename T, std::size_t NumDims>
+void nested(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  while (s.keep_running()) {
+    T sum = T();
+    iterate<NumDims>::sum(a,sum);
+    bench::keep(sum);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+void accumulate(bench::state& s) {
+  boost::multi_array<T,NumDims> a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  while (s.keep_running()) {
+    bench::clobber();
+    bench::keep(std::accumulate(a.data(),a.data() + a.num_elements(),T()));
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"nested",NumDims,type,&nested<T,NumDims>);
+    bench::add_sizes<T>(group,"accumulate",NumDims,type,
+                        &accumulate<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("iteration"), true);
+
+} // unnamed namespace
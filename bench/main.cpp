@@ -0,0 +1,136 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// main.cpp - runs the registered benchmarks and reports the results;
+// see harness.hpp for the options.
+//
+
+#include "harness.hpp"
+#include <boost/config.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using bench::benchmark;
+using bench::result;
+
+struct options {
+  std::string filter;
+  std::string json;
+  double min_time;
+  std::size_t repetitions;
+  bool quick;
+  bool list;
+};
+
+void write_json(std::ostream& os, const std::vector<result>& results,
+                const options& opts) {
+  using bench::json_string;
+  os << "{\n  \"context\": {\n"
+     << "    \"library\": \"Boost.MultiArray\",\n"
+     << "    \"compiler\": " << json_string(BOOST_COMPILER) << ",\n"
+     << "    \"platform\": " << json_string(BOOST_PLATFORM) << ",\n"
+     << "    \"standard_library\": " << json_string(BOOST_STDLIB) << ",\n"
+#ifdef NDEBUG
+     << "    \"assertions\": false,\n"
+#else
+     << "    \"assertions\": true,\n"
+#endif
+     << "    \"min_time_ms\": " << opts.min_time * 1000 << ",\n"
+     << "    \"repetitions\": " << opts.repetitions << "\n"
+     << "  },\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    const result& r = results[i];
+    const benchmark& b = *r.bench;
+    os << (i == 0 ? "\n" : ",\n")
+       << "    {\"name\": " << json_string(b.name)
+       << ", \"group\": " << json_string(b.group)
+       << ", \"variant\": " << json_string(b.variant)
+       << ", \"rank\": " << b.rank
+       << ", \"type\": " << json_string(b.type)
+       << ", \"size\": " << json_string(b.size)
+       << ", \"elements\": " << b.elements
+       << ", \"iterations\": " << r.iterations
+       << ", \"items_per_iteration\": " << r.items
+       << ", \"ns_per_iteration\": " << r.best * 1e9
+       << ", \"ns_per_iteration_median\": " << r.median * 1e9
+       << ", \"ns_per_item\": " << r.best * 1e9 / double(r.items)
+       << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  using bench::starts_with;
+  options opts;
+  opts.min_time = 0.02;
+  opts.repetitions = 5;
+  opts.quick = false;
+  opts.list = false;
+  for (int i = 1; i != argc; ++i) {
+    const char* value;
+    if (starts_with(argv[i],"--filter=",value))
+      opts.filter = value;
+    else if (starts_with(argv[i],"--json=",value))
+      opts.json = value;
+    else if (starts_with(argv[i],"--min-time=",value))
+      opts.min_time = std::atof(value) / 1000;
+    else if (starts_with(argv[i],"--repetitions=",value))
+      opts.repetitions = std::size_t(std::max(1,std::atoi(value)));
+    else if (std::strcmp(argv[i],"--quick") == 0)
+      opts.quick = true;
+    else if (std::strcmp(argv[i],"--list") == 0)
+      opts.list = true;
+    else {
+      std::cerr << "usage: " << argv[0] << " [--filter=text] [--json=file]"
+                << " [--min-time=ms] [--repetitions=n] [--quick] [--list]\n";
+      return 2;
+    }
+  }
+
+  std::vector<result> results;
+  const std::vector<benchmark>& benchmarks = bench::registry();
+  for (std::size_t i = 0; i != benchmarks.size(); ++i) {
+    const benchmark& b = benchmarks[i];
+    if (b.name.find(opts.filter) == std::string::npos)
+      continue;
+    if (opts.quick && b.size == "DRAM")
+      continue;
+    if (opts.list) {
+      std::cout << b.name << '\n';
+      continue;
+    }
+    const result r = bench::measure(b,opts.min_time,opts.repetitions);
+    results.push_back(r);
+    std::fprintf(stderr,"%-48s %12.1f ns %10.3f ns/item\n",b.name.c_str(),
+                 r.best * 1e9,r.best * 1e9 / double(r.items));
+  }
+
+  if (!opts.json.empty()) {
+    if (opts.json == "-") {
+      write_json(std::cout,results,opts);
+    } else {
+      std::ofstream file(opts.json.c_str());
+      write_json(file,results,opts);
+      if (!file) {
+        std::cerr << "cannot write " << opts.json << '\n';
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
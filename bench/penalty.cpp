@@ -0,0 +1,555 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// penalty.cpp - the abstraction penalty of Boost.MultiArray: the same
+// kernels written three ways,
+//   multi_array  idiomatic: operator[], iterators and views
+//   strided      data() (or origin()) and strides() of a multi_array
+//   raw          a plain heap array with the indexing written out
+// and timed against each other.  The report gives, for every kernel, the
+// time of each version and its ratio to the raw one; the program fails
+// when a ratio exceeds the threshold, so a change to the indexing or the
+// iterators that the compiler can no longer see through shows up as a
+// failure rather than as a number nobody reads.
+//
+// The program takes
+//   --max-ratio=r    the threshold (default 2)
+//   --json=file      write the report as JSON to file ("-": stdout)
+//   --min-time=ms    the minimum time of one run (default 50)
+//   --repetitions=n  runs per version (default 5)
+//   --filter=text    run only the kernels whose name contains text
+// and returns 1 when a ratio exceeds the threshold or when the versions
+// of a kernel disagree on the result.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+#include <boost/config.hpp>
+#include <boost/multi_array.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef BOOST_MULTI_ARRAY_BENCH_CONFIG
+#define BOOST_MULTI_ARRAY_BENCH_CONFIG ""
+#endif
+
+namespace {
+
+using bench::index;
+using bench::size_type;
+
+typedef double T;
+typedef boost::multi_array<T,2> array2;
+typedef boost::multi_array<T,3> array3;
+
+// The result of the last run of a kernel, for comparing its versions.
+T checksum;
+
+template <typename Iter>
+T sum(Iter first, Iter last) {
+  T total = T();
+  for (; first != last; ++first)
+    total += *first;
+  return total;
+}
+
+// A heap array of n elements, holding the same values as bench::iota.
+class raw_array {
+public:
+  explicit raw_array(std::size_t n) : data_(new T[n]), size_(n) {
+    for (std::size_t i = 0; i != n; ++i)
+      data_[i] = T(i % 1000);
+  }
+  ~raw_array() { delete[] data_; }
+  T* get() const { return data_; }
+  T sum() const { return ::sum(data_,data_ + size_); }
+private:
+  raw_array(const raw_array&);             // noncopyable
+  raw_array& operator=(const raw_array&);
+  T* data_;
+  std::size_t size_;
+};
+
+template <typename Array>
+T sum_of(const Array& a) { return sum(a.data(),a.data() + a.num_elements()); }
+
+//
+// stencil: b = the five point average of a, over the interior
+//
+const index stencil_n = 128;
+
+void stencil_multi_array(bench::state& s) {
+  const index n = stencil_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]);
+  bench::iota(a);
+  const array2& ca = a;
+  while (s.keep_running()) {
+    for (index i = 1; i != n - 1; ++i)
+      for (index j = 1; j != n - 1; ++j)
+        b[i][j] = T(0.2) * (ca[i][j] + ca[i - 1][j] + ca[i + 1][j] +
+                            ca[i][j - 1] + ca[i][j + 1]);
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = sum_of(b);
+}
+
+void stencil_strided(bench::state& s) {
+  const index n = stencil_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]);
+  bench::iota(a);
+  const T* pa = a.data();
+  T* pb = b.data();
+  const index a0 = a.strides()[0], a1 = a.strides()[1];
+  const index b0 = b.strides()[0], b1 = b.strides()[1];
+  while (s.keep_running()) {
+    for (index i = 1; i != n - 1; ++i)
+      for (index j = 1; j != n - 1; ++j) {
+        const T* p = pa + i * a0 + j * a1;
+        pb[i * b0 + j * b1] = T(0.2) * (p[0] + p[-a0] + p[a0] +
+                                        p[-a1] + p[a1]);
+      }
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = sum_of(b);
+}
+
+void stencil_raw(bench::state& s) {
+  const index n = stencil_n;
+  raw_array ra(std::size_t(n * n)), rb(std::size_t(n * n));
+  std::fill(rb.get(),rb.get() + n * n,T());
+  const T* a = ra.get();
+  T* b = rb.get();
+  while (s.keep_running()) {
+    for (index i = 1; i != n - 1; ++i)
+      for (index j = 1; j != n - 1; ++j)
+        b[i * n + j] = T(0.2) * (a[i * n + j] + a[(i - 1) * n + j] +
+                                 a[(i + 1) * n + j] + a[i * n + j - 1] +
+                                 a[i * n + j + 1]);
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = rb.sum();
+}
+
+//
+// transpose: b[j][i] = a[i][j]
+//
+const index transpose_n = 128;
+
+void transpose_multi_array(bench::state& s) {
+  const index n = transpose_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]);
+  bench::iota(a);
+  const array2& ca = a;
+  while (s.keep_running()) {
+    for (index i = 0; i != n; ++i)
+      for (index j = 0; j != n; ++j)
+        b[j][i] = ca[i][j];
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n));
+  checksum = b[1][0] + b[0][n - 1] + sum_of(b);
+}
+
+void transpose_strided(bench::state& s) {
+  const index n = transpose_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]);
+  bench::iota(a);
+  const T* pa = a.data();
+  T* pb = b.data();
+  const index a0 = a.strides()[0], a1 = a.strides()[1];
+  const index b0 = b.strides()[0], b1 = b.strides()[1];
+  while (s.keep_running()) {
+    for (index i = 0; i != n; ++i)
+      for (index j = 0; j != n; ++j)
+        pb[j * b0 + i * b1] = pa[i * a0 + j * a1];
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n));
+  checksum = b[1][0] + b[0][n - 1] + sum_of(b);
+}
+
+void transpose_raw(bench::state& s) {
+  const index n = transpose_n;
+  raw_array ra(std::size_t(n * n)), rb(std::size_t(n * n));
+  const T* a = ra.get();
+  T* b = rb.get();
+  while (s.keep_running()) {
+    for (index i = 0; i != n; ++i)
+      for (index j = 0; j != n; ++j)
+        b[j * n + i] = a[i * n + j];
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n));
+  checksum = b[n] + b[n - 1] + rb.sum();
+}
+
+//
+// reduction: the sum of a three dimensional array
+//
+const index reduction_n = 32;
+
+void reduction_multi_array(bench::state& s) {
+  const index n = reduction_n;
+  array3 a(boost::extents[n][n][n]);
+  bench::iota(a);
+  const array3& ca = a;
+  typedef array3::const_iterator iter0;
+  typedef array3::const_subarray<2>::type::const_iterator iter1;
+  typedef array3::const_subarray<1>::type::const_iterator iter2;
+  T total = T();
+  while (s.keep_running()) {
+    total = T();
+    for (iter0 i = ca.begin(), iend = ca.end(); i != iend; ++i)
+      for (iter1 j = (*i).begin(), jend = (*i).end(); j != jend; ++j)
+        for (iter2 k = (*j).begin(), kend = (*j).end(); k != kend; ++k)
+          total += *k;
+    bench::keep(total);
+  }
+  s.set_items(a.num_elements());
+  checksum = total;
+}
+
+void reduction_strided(bench::state& s) {
+  const index n = reduction_n;
+  array3 a(boost::extents[n][n][n]);
+  bench::iota(a);
+  const T* p = a.data();
+  const index s0 = a.strides()[0], s1 = a.strides()[1], s2 = a.strides()[2];
+  T total = T();
+  while (s.keep_running()) {
+    total = T();
+    for (index i = 0; i != n; ++i)
+      for (index j = 0; j != n; ++j)
+        for (index k = 0; k != n; ++k)
+          total += p[i * s0 + j * s1 + k * s2];
+    bench::keep(total);
+  }
+  s.set_items(a.num_elements());
+  checksum = total;
+}
+
+void reduction_raw(bench::state& s) {
+  const index n = reduction_n;
+  raw_array ra(std::size_t(n * n * n));
+  const T* a = ra.get();
+  T total = T();
+  while (s.keep_running()) {
+    total = T();
+    for (index i = 0; i != n; ++i)
+      for (index j = 0; j != n; ++j)
+        for (index k = 0; k != n; ++k)
+          total += a[(i * n + j) * n + k];
+    bench::keep(total);
+  }
+  s.set_items(std::size_t(n * n * n));
+  checksum = total;
+}
+
+//
+// axpy: z = alpha * x + y over the interior of matrices, through views
+// (into z rather than y so that every run computes the same result)
+//
+const index axpy_n = 128;
+const T alpha = T(0.5);
+
+void axpy_multi_array(bench::state& s) {
+  const index n = axpy_n;
+  array2 x(boost::extents[n][n]), y(boost::extents[n][n]),
+    z(boost::extents[n][n]);
+  bench::iota(x);
+  bench::iota(y);
+  const array2& cx = x;
+  const array2& cy = y;
+  const boost::array<size_type,2> extents = {{ size_type(n), size_type(n) }};
+  while (s.keep_running()) {
+    array2::const_array_view<2>::type vx =
+      cx[bench::interior<2>::get(extents.data())];
+    array2::const_array_view<2>::type vy =
+      cy[bench::interior<2>::get(extents.data())];
+    array2::array_view<2>::type vz =
+      z[bench::interior<2>::get(extents.data())];
+    for (index i = 0; i != n - 2; ++i)
+      for (index j = 0; j != n - 2; ++j)
+        vz[i][j] = alpha * vx[i][j] + vy[i][j];
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = sum_of(z);
+}
+
+void axpy_strided(bench::state& s) {
+  const index n = axpy_n;
+  array2 x(boost::extents[n][n]), y(boost::extents[n][n]),
+    z(boost::extents[n][n]);
+  bench::iota(x);
+  bench::iota(y);
+  const index x0 = x.strides()[0], x1 = x.strides()[1];
+  const index y0 = y.strides()[0], y1 = y.strides()[1];
+  const index z0 = z.strides()[0], z1 = z.strides()[1];
+  while (s.keep_running()) {
+    const T* px = x.origin() + x0 + x1;
+    const T* py = y.origin() + y0 + y1;
+    T* pz = z.origin() + z0 + z1;
+    for (index i = 0; i != n - 2; ++i)
+      for (index j = 0; j != n - 2; ++j)
+        pz[i * z0 + j * z1] = alpha * px[i * x0 + j * x1] +
+                              py[i * y0 + j * y1];
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = sum_of(z);
+}
+
+void axpy_raw(bench::state& s) {
+  const index n = axpy_n;
+  raw_array rx(std::size_t(n * n)), ry(std::size_t(n * n)),
+    rz(std::size_t(n * n));
+  std::fill(rz.get(),rz.get() + n * n,T());
+  while (s.keep_running()) {
+    const T* x = rx.get() + n + 1;
+    const T* y = ry.get() + n + 1;
+    T* z = rz.get() + n + 1;
+    for (index i = 0; i != n - 2; ++i)
+      for (index j = 0; j != n - 2; ++j)
+        z[i * n + j] = alpha * x[i * n + j] + y[i * n + j];
+    bench::clobber();
+  }
+  s.set_items(std::size_t((n - 2) * (n - 2)));
+  checksum = rz.sum();
+}
+
+//
+// matmul: c = a * b, in i-k-j order
+//
+const index matmul_n = 64;
+
+void matmul_multi_array(bench::state& s) {
+  const index n = matmul_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]),
+    c(boost::extents[n][n]);
+  bench::iota(a);
+  bench::iota(b);
+  const array2& ca = a;
+  const array2& cb = b;
+  while (s.keep_running()) {
+    std::fill(c.data(),c.data() + c.num_elements(),T());
+    for (index i = 0; i != n; ++i)
+      for (index k = 0; k != n; ++k) {
+        const T aik = ca[i][k];
+        for (index j = 0; j != n; ++j)
+          c[i][j] += aik * cb[k][j];
+      }
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n * n));
+  checksum = sum_of(c);
+}
+
+void matmul_strided(bench::state& s) {
+  const index n = matmul_n;
+  array2 a(boost::extents[n][n]), b(boost::extents[n][n]),
+    c(boost::extents[n][n]);
+  bench::iota(a);
+  bench::iota(b);
+  const T* pa = a.data();
+  const T* pb = b.data();
+  T* pc = c.data();
+  const index a0 = a.strides()[0], a1 = a.strides()[1];
+  const index b0 = b.strides()[0], b1 = b.strides()[1];
+  const index c0 = c.strides()[0], c1 = c.strides()[1];
+  while (s.keep_running()) {
+    std::fill(c.data(),c.data() + c.num_elements(),T());
+    for (index i = 0; i != n; ++i)
+      for (index k = 0; k != n; ++k) {
+        const T aik = pa[i * a0 + k * a1];
+        for (index j = 0; j != n; ++j)
+          pc[i * c0 + j * c1] += aik * pb[k * b0 + j * b1];
+      }
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n * n));
+  checksum = sum_of(c);
+}
+
+void matmul_raw(bench::state& s) {
+  const index n = matmul_n;
+  raw_array ra(std::size_t(n * n)), rb(std::size_t(n * n)),
+    rc(std::size_t(n * n));
+  const T* a = ra.get();
+  const T* b = rb.get();
+  T* c = rc.get();
+  while (s.keep_running()) {
+    std::fill(c,c + n * n,T());
+    for (index i = 0; i != n; ++i)
+      for (index k = 0; k != n; ++k) {
+        const T aik = a[i * n + k];
+        for (index j = 0; j != n; ++j)
+          c[i * n + j] += aik * b[k * n + j];
+      }
+    bench::clobber();
+  }
+  s.set_items(std::size_t(n * n * n));
+  checksum = rc.sum();
+}
+
+struct kernel {
+  const char* name;
+  bench::function versions[3];
+};
+
+const char* const version_names[3] = { "multi_array", "strided", "raw" };
+
+const kernel kernels[] = {
+  { "stencil", { &stencil_multi_array, &stencil_strided, &stencil_raw } },
+  { "transpose", { &transpose_multi_array, &transpose_strided,
+                   &transpose_raw } },
+  { "reduction", { &reduction_multi_array, &reduction_strided,
+                   &reduction_raw } },
+  { "axpy", { &axpy_multi_array, &axpy_strided, &axpy_raw } },
+  { "matmul", { &matmul_multi_array, &matmul_strided, &matmul_raw } }
+};
+
+struct row {
+  const char* kernel;
+  double seconds[3];      // best time of an iteration, per version
+  T checksums[3];
+  double ratio(std::size_t version) const {
+    return seconds[version] / seconds[2];
+  }
+};
+
+bool agree(T a, T b) {
+  return std::fabs(a - b) <= 1e-9 * std::max(std::fabs(a),std::fabs(b));
+}
+
+std::string optimization() {
+  std::string result;
+#if defined(__OPTIMIZE_SIZE__)
+  result = "optimized for size";
+#elif defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(_DEBUG))
+  result = "optimized";
+#elif defined(__GNUC__) || defined(_MSC_VER)
+  result = "not optimized";
+#else
+  result = "unknown";
+#endif
+#ifndef NDEBUG
+  result += ", assertions on";
+#endif
+  if (*BOOST_MULTI_ARRAY_BENCH_CONFIG)
+    result += std::string(" (") + BOOST_MULTI_ARRAY_BENCH_CONFIG + ")";
+  return result;
+}
+
+void write_json(std::ostream& os, const std::vector<row>& rows,
+                double max_ratio) {
+  using bench::json_string;
+  os << "{\n  \"context\": {\n"
+     << "    \"library\": \"Boost.MultiArray\",\n"
+     << "    \"compiler\": " << json_string(BOOST_COMPILER) << ",\n"
+     << "    \"platform\": " << json_string(BOOST_PLATFORM) << ",\n"
+     << "    \"standard_library\": " << json_string(BOOST_STDLIB) << ",\n"
+     << "    \"optimization\": " << json_string(optimization()) << ",\n"
+     << "    \"max_ratio\": " << max_ratio << "\n"
+     << "  },\n  \"kernels\": [";
+  for (std::size_t i = 0; i != rows.size(); ++i) {
+    const row& r = rows[i];
+    os << (i == 0 ? "\n" : ",\n") << "    {\"name\": "
+       << json_string(r.kernel);
+    for (std::size_t v = 0; v != 3; ++v)
+      os << ", \"" << version_names[v] << "_ns\": " << r.seconds[v] * 1e9;
+    os << ", \"multi_array_ratio\": " << r.ratio(0)
+       << ", \"strided_ratio\": " << r.ratio(1) << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  using bench::starts_with;
+  std::string filter, json;
+  double max_ratio = 2;
+  double min_time = 0.05;
+  std::size_t repetitions = 5;
+  for (int i = 1; i != argc; ++i) {
+    const char* value;
+    if (starts_with(argv[i],"--max-ratio=",value))
+      max_ratio = std::atof(value);
+    else if (starts_with(argv[i],"--json=",value))
+      json = value;
+    else if (starts_with(argv[i],"--min-time=",value))
+      min_time = std::atof(value) / 1000;
+    else if (starts_with(argv[i],"--repetitions=",value))
+      repetitions = std::size_t(std::max(1,std::atoi(value)));
+    else if (starts_with(argv[i],"--filter=",value))
+      filter = value;
+    else {
+      std::cerr << "usage: " << argv[0] << " [--max-ratio=r] [--json=file]"
+                << " [--min-time=ms] [--repetitions=n] [--filter=text]\n";
+      return 2;
+    }
+  }
+
+  std::printf("compiler:     %s\nlibrary:      %s\noptimization: %s\n\n",
+              BOOST_COMPILER,BOOST_STDLIB,optimization().c_str());
+  std::printf("%-10s %14s %14s %14s %12s %12s\n","kernel",
+              "multi_array ns","strided ns","raw ns","multi/raw",
+              "strided/raw");
+
+  bool failed = false;
+  std::vector<row> rows;
+  for (std::size_t k = 0; k != sizeof(kernels) / sizeof(kernels[0]); ++k) {
+    if (std::string(kernels[k].name).find(filter) == std::string::npos)
+      continue;
+    row r;
+    r.kernel = kernels[k].name;
+    for (std::size_t v = 0; v != 3; ++v) {
+      const bench::benchmark b =
+        bench::make_benchmark("penalty",version_names[v],0,"double","",0,
+                              kernels[k].versions[v]);
+      r.seconds[v] = bench::measure(b,min_time,repetitions).best;
+      r.checksums[v] = checksum;
+    }
+    rows.push_back(r);
+
+    const bool slow = r.ratio(0) > max_ratio || r.ratio(1) > max_ratio;
+    const bool wrong = !agree(r.checksums[0],r.checksums[2]) ||
+                       !agree(r.checksums[1],r.checksums[2]);
+    std::printf("%-10s %14.0f %14.0f %14.0f %12.2f %12.2f%s\n",r.kernel,
+                r.seconds[0] * 1e9,r.seconds[1] * 1e9,r.seconds[2] * 1e9,
+                r.ratio(0),r.ratio(1),
+                wrong ? "  WRONG RESULT" : slow ? "  OVER THRESHOLD" : "");
+    failed = failed || slow || wrong;
+  }
+  std::printf("\nthreshold: %.2f, %s\n",max_ratio,failed ? "FAILED" : "ok");
+
+  if (!json.empty()) {
+    if (json == "-") {
+      write_json(std::cout,rows,max_ratio);
+    } else {
+      std::ofstream file(json.c_str());
+      write_json(file,rows,max_ratio);
+      if (!file) {
+        std::cerr << "cannot write " << json << '\n';
+        return 1;
+      }
+    }
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// resize.cpp - resize(), which allocates and copies the overlapping
+// elements, growing and shrinking by one in every dimension.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+
+namespace {
+
+template <typename T, std::size_t NumDims>
+void grow_shrink(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  const boost::array<bench::size_type,NumDims> small =
+    bench::cube<NumDims>(s.elements());
+  boost::array<bench::size_type,NumDims> large = small;
+  for (std::size_t n = 0; n != NumDims; ++n)
+    ++large[n];
+  array a(small);
+  bench::iota(a);
+  bool grow = true;
+  while (s.keep_running()) {
+    a.resize(grow ? large : small);
+    grow = !grow;
+    bench::keep(a.data()[0]);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+void same_shape(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  const boost::array<bench::size_type,NumDims> extents =
+    bench::cube<NumDims>(s.elements());
+  array a(extents);
+  bench::iota(a);
+  while (s.keep_running()) {
+    a.resize(extents);
+    bench::keep(a.data()[0]);
+  }
+  s.set_items(a.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"grow_shrink",NumDims,type,
+                        &grow_shrink<T,NumDims>);
+    bench::add_sizes<T>(group,"same_shape",NumDims,type,
+                        &same_shape<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("resize"), true);
+
+} // unnamed namespace
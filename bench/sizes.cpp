@@ -0,0 +1,127 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// sizes.cpp - the size in bytes of the arrays, references, sub-arrays,
+// views and iterators of ranks 1 to 6, which is mostly the extents,
+// strides and index bases they carry.  Built twice, as
+// multi_array_sizes with the default index and size types and as
+// multi_array_sizes_32 with 32-bit ones (BOOST_MULTI_ARRAY_INDEX_TYPE and
+// BOOST_MULTI_ARRAY_SIZE_TYPE; see types.hpp), to compare the two.
+//
+// The program takes
+//   --json=file      write the sizes as JSON to file ("-": stdout)
+//
+
+#include "harness.hpp"
+#include <boost/config.hpp>
+#include <boost/multi_array.hpp>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kind_names[] = {
+  "multi_array", "multi_array_ref", "sub_array", "multi_array_view",
+  "iterator"
+};
+const std::size_t num_kinds = sizeof(kind_names) / sizeof(kind_names[0]);
+
+struct row {
+  std::size_t rank;
+  std::size_t bytes[num_kinds];
+};
+
+template <std::size_t NumDims>
+row sizes() {
+  typedef boost::multi_array<double,NumDims> array;
+  row r;
+  r.rank = NumDims;
+  r.bytes[0] = sizeof(array);
+  r.bytes[1] = sizeof(boost::multi_array_ref<double,NumDims>);
+  r.bytes[2] = sizeof(boost::detail::multi_array::sub_array<double,NumDims>);
+  r.bytes[3] =
+    sizeof(boost::detail::multi_array::multi_array_view<double,NumDims>);
+  r.bytes[4] = sizeof(typename array::iterator);
+  return r;
+}
+
+void write_json(std::ostream& os, const std::vector<row>& rows) {
+  using bench::json_string;
+  os << "{\n  \"context\": {\n"
+     << "    \"library\": \"Boost.MultiArray\",\n"
+     << "    \"compiler\": " << json_string(BOOST_COMPILER) << ",\n"
+     << "    \"platform\": " << json_string(BOOST_PLATFORM) << ",\n"
+     << "    \"index_bytes\": " << sizeof(boost::multi_array_types::index)
+     << ",\n    \"size_type_bytes\": "
+     << sizeof(boost::multi_array_types::size_type) << "\n"
+     << "  },\n  \"sizes\": [";
+  for (std::size_t i = 0; i != rows.size(); ++i) {
+    os << (i == 0 ? "\n" : ",\n") << "    {\"rank\": " << rows[i].rank;
+    for (std::size_t k = 0; k != num_kinds; ++k)
+      os << ", " << json_string(kind_names[k]) << ": " << rows[i].bytes[k];
+    os << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[]) {
+  std::string json;
+  for (int i = 1; i != argc; ++i) {
+    const char* value;
+    if (bench::starts_with(argv[i],"--json=",value)) {
+      json = value;
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--json=file]\n";
+      return 2;
+    }
+  }
+
+  std::vector<row> rows;
+  rows.push_back(sizes<1>());
+  rows.push_back(sizes<2>());
+  rows.push_back(sizes<3>());
+  rows.push_back(sizes<4>());
+  rows.push_back(sizes<5>());
+  rows.push_back(sizes<6>());
+
+  if (json != "-") {
+    std::cout << "index: " << sizeof(boost::multi_array_types::index)
+              << " bytes, size_type: "
+              << sizeof(boost::multi_array_types::size_type)
+              << " bytes\nrank";
+    for (std::size_t k = 0; k != num_kinds; ++k)
+      std::cout << "  " << kind_names[k];
+    std::cout << '\n';
+    for (std::size_t i = 0; i != rows.size(); ++i) {
+      std::cout << rows[i].rank << "   ";
+      for (std::size_t k = 0; k != num_kinds; ++k)
+        std::cout << "  " << std::setw(int(std::strlen(kind_names[k])))
+                  << rows[i].bytes[k];
+      std::cout << '\n';
+    }
+  }
+
+  if (json == "-") {
+    write_json(std::cout,rows);
+  } else if (!json.empty()) {
+    std::ofstream out(json.c_str());
+    write_json(out,rows);
+    if (!out) {
+      std::cerr << "cannot write " << json << '\n';
+      return 1;
+    }
+  }
+  return 0;
+}
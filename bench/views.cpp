@@ -0,0 +1,94 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// views.cpp - creating a view (generate_array_view), passing one by
+// value to a function the compiler cannot inline, and reading the
+// elements through one.
+//
+
+#include "arrays.hpp"
+#include "harness.hpp"
+#include <boost/config.hpp>
+
+namespace {
+
+using bench::index;
+using bench::size_type;
+
+template <typename T, std::size_t NumDims>
+void create(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  array a(bench::cube<NumDims>(s.elements()));
+  const typename bench::interior<NumDims>::type indices =
+    bench::interior<NumDims>::get(a.shape());
+  // clobber() then makes the compiler assume both have changed
+  bench::keep(a);
+  bench::keep(indices);
+  while (s.keep_running()) {
+    bench::clobber();
+    typename array::template array_view<NumDims>::type view = a[indices];
+    bench::keep(view.origin());
+  }
+  s.set_items(1);
+}
+
+// Takes the view by value, as an interface between components would.
+template <typename View>
+BOOST_NOINLINE const typename View::element* first(View view) {
+  return view.origin();
+}
+
+template <typename T, std::size_t NumDims>
+void pass(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  array a(bench::cube<NumDims>(s.elements()));
+  typename array::template array_view<NumDims>::type view =
+    a[bench::interior<NumDims>::get(a.shape())];
+  while (s.keep_running()) {
+    bench::clobber();
+    bench::keep(first(view));
+  }
+  s.set_items(1);
+}
+
+template <typename T, std::size_t NumDims>
+void read(bench::state& s) {
+  typedef boost::multi_array<T,NumDims> array;
+  array a(bench::cube<NumDims>(s.elements()));
+  bench::iota(a);
+  const typename array::template const_array_view<NumDims>::type view =
+    static_cast<const array&>(a)[bench::interior<NumDims>::get(a.shape())];
+  const size_type* extents = view.shape();
+  const index last = index(extents[NumDims - 1]);
+  while (s.keep_running()) {
+    T sum = T();
+    boost::array<index,NumDims> idx;
+    idx.assign(0);
+    do {
+      for (idx[NumDims - 1] = 0; idx[NumDims - 1] != last;
+           ++idx[NumDims - 1])
+        sum += view(idx);
+    } while (bench::next_row<NumDims>(idx,extents));
+    bench::keep(sum);
+  }
+  s.set_items(view.num_elements());
+}
+
+template <typename T, std::size_t NumDims>
+struct suite {
+  static void add(const char* group) {
+    const char* type = bench::type_name<T>::get();
+    bench::add_sizes<T>(group,"create",NumDims,type,&create<T,NumDims>);
+    bench::add_sizes<T>(group,"pass",NumDims,type,&pass<T,NumDims>);
+    bench::add_sizes<T>(group,"read",NumDims,type,&read<T,NumDims>);
+  }
+};
+
+const bool registered = (bench::register_suite<suite>("views"), true);
+
+} // unnamed namespace
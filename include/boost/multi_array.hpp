@@ -35,6 +35,7 @@
 #include "boost/multi_array/algorithm.hpp"
 #include "boost/core/alloc_construct.hpp"
 #include "boost/core/empty_value.hpp"
+#include "boost/core/no_exceptions_support.hpp"
 #include "boost/array.hpp"
 #include "boost/mpl/if.hpp"
 #include "boost/type_traits.hpp"
@@ -49,6 +50,7 @@
 namespace boost {
   namespace detail {
     namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
       struct populate_index_ranges {
         multi_array_types::index_range
@@ -113,9 +115,18 @@ struct disable_multi_array_impl<int>
 
 #endif
 
+BOOST_MULTI_ARRAY_ABI_END
+
     } //namespace multi_array
   } // namespace detail
 
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+// Selects the multi_array constructors that take ownership of an
+// existing allocation instead of making their own.
+struct adopt_storage_t { };
+const adopt_storage_t adopt_storage = adopt_storage_t();
+
 template<typename T, std::size_t NumDims,
   typename Allocator>
 class multi_array :
@@ -226,10 +237,29 @@ public:
     allocate_space();
   }
 
+  //
+  // Adopting storage: the array takes ownership of capacity elements at
+  // storage, which must have been allocated and constructed through an
+  // allocator equal to alloc.  They are destroyed and deallocated through
+  // it like the array's own storage.  No element is copied.
+  //
+  template <class ExtentList>
+  multi_array(adopt_storage_t, T* storage, size_type capacity,
+              ExtentList const& extents,
+              const general_storage_order<NumDims>& so = c_storage_order(),
+              const Allocator& alloc = Allocator()) :
+    super_type(storage,extents,so),
+    alloc_base(boost::empty_init_t(),alloc) {
+    BOOST_ASSERT(capacity >= this->num_elements());
+    base_ = storage;
+    allocated_elements_ = capacity;
+  }
+
   multi_array(const multi_array& rhs) :
   super_type(rhs),
   alloc_base(static_cast<const alloc_base&>(rhs)) {
     allocate_space();
+    BOOST_MULTI_ARRAY_TRACE_COPY(rhs,*this,true);
     boost::detail::multi_array::copy_n(rhs.base_,rhs.num_elements(),base_);
   }
 
@@ -252,7 +282,7 @@ public:
   {
     allocate_space();
     // Warning! storage order may change, hence the following copy technique.
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   template <typename OPtr>
@@ -264,7 +294,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 
@@ -277,7 +307,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 #else // BOOST_NO_FUNCTION_TEMPLATE_ORDERING
@@ -291,7 +321,7 @@ public:
   {
     allocate_space();
     // Warning! storage order may change, hence the following copy technique.
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const const_multi_array_ref<T,NumDims>& rhs,
@@ -302,7 +332,7 @@ public:
   {
     allocate_space();
     // Warning! storage order may change, hence the following copy technique.
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const detail::multi_array::
@@ -312,7 +342,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const detail::multi_array::
@@ -323,7 +353,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 
@@ -334,7 +364,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const detail::multi_array::
@@ -345,7 +375,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 #endif // !BOOST_NO_FUNCTION_TEMPLATE_ORDERING
@@ -358,7 +388,7 @@ public:
   {
     allocate_space();
     // Warning! storage order may change, hence the following copy technique.
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const multi_array_ref<T,NumDims>& rhs,
@@ -369,7 +399,7 @@ public:
   {
     allocate_space();
     // Warning! storage order may change, hence the following copy technique.
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 
@@ -380,7 +410,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
   multi_array(const detail::multi_array::
@@ -391,7 +421,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
 
 
@@ -402,7 +432,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
     
   multi_array(const detail::multi_array::
@@ -413,7 +443,7 @@ public:
       alloc_base(boost::empty_init_t(),alloc)
   {
     allocate_space();
-    std::copy(rhs.begin(),rhs.end(),this->begin());
+    boost::detail::multi_array::copy_elements(rhs,*this);
   }
     
   // Since assignment is a deep copy, multi_array_ref
@@ -453,6 +483,34 @@ public:
   multi_array& resize(const detail::multi_array
                       ::extent_gen<NumDims>& ranges) {
 
+    // When only the slowest varying dimension changes, every element
+    // that survives the resize keeps its place in memory, so the
+    // allocation is reused, or grown once, instead of building a new
+    // array and copying through views.
+    size_list new_extents;
+    for (size_type i = 0; i != NumDims; ++i)
+      new_extents[i] = ranges.ranges_[i].size();
+
+    const size_type new_num_elements = boost::detail::multi_array::
+      checked_num_elements(new_extents.begin(),NumDims);
+    const bool in_place = resizes_in_place(new_extents);
+    BOOST_MULTI_ARRAY_TRACE_RESIZE(*this,new_num_elements,in_place);
+
+    if (in_place) {
+      const size_type old_num_elements = this->num_elements();
+
+      if (new_num_elements > allocated_elements_) {
+        reallocate(new_num_elements);
+      } else if (new_num_elements > old_num_elements) {
+        // spare capacity may hold elements left behind by a shrink
+        std::fill(base_+old_num_elements,base_+new_num_elements,T());
+      }
+
+      for (size_type i = 0; i != NumDims; ++i)
+        this->index_base_list_[i] = ranges.ranges_[i].start();
+      this->init_multi_array_ref(new_extents.begin());
+      return *this;
+    }
 
     // build a multi_array with the specs given
     multi_array new_array(ranges,this->storage_order(),allocator());
@@ -498,28 +556,116 @@ public:
     // Set the right portion of the new array
     view_new = view_old;
 
-    using std::swap;
-    // Swap the internals of these arrays.
-    swap(this->super_type::base_,new_array.super_type::base_);
-    swap(this->allocator(),new_array.allocator());
-    swap(this->storage_,new_array.storage_);
-    swap(this->extent_list_,new_array.extent_list_);
-    swap(this->stride_list_,new_array.stride_list_);
-    swap(this->index_base_list_,new_array.index_base_list_);
-    swap(this->origin_offset_,new_array.origin_offset_);
-    swap(this->directional_offset_,new_array.directional_offset_);
-    swap(this->num_elements_,new_array.num_elements_);
-    swap(this->base_,new_array.base_);
-    swap(this->allocated_elements_,new_array.allocated_elements_);
-
+    swap(new_array);
     return *this;
   }
 
+  // Exchanges the shapes, storage orders, elements and allocators of
+  // the two arrays without copying any element.
+  void swap(multi_array& other) {
+    using std::swap;
+    swap(this->super_type::base_,other.super_type::base_);
+    swap(this->allocator(),other.allocator());
+    swap(this->storage_,other.storage_);
+    swap(this->extent_list_,other.extent_list_);
+    swap(this->stride_list_,other.stride_list_);
+    swap(this->index_base_list_,other.index_base_list_);
+    swap(this->origin_offset_,other.origin_offset_);
+    swap(this->directional_offset_,other.directional_offset_);
+    swap(this->element_counts_,other.element_counts_);
+    swap(this->base_,other.base_);
+    swap(this->allocated_elements_,other.allocated_elements_);
+  }
+
 
   ~multi_array() {
     deallocate_space();
   }
 
+  //
+  // Appending along the slowest varying dimension (by storage order).
+  // The capacity grows geometrically, so a sequence of appends costs
+  // amortized O(slice size), and element addresses stay valid unless
+  // the capacity is exceeded.  The appended slice must not refer to
+  // elements of this array.  If the slowest varying dimension is
+  // stored descending, appending falls back to an ordinary resize.
+  //
+  template <typename ConstMultiArray>
+  multi_array& push_back_slice(const ConstMultiArray& slice) {
+    detail::multi_array::
+      check_const_multi_array<ConstMultiArray,NumDims-1>();
+    typename array_view<NumDims-1>::type dest = emplace_back_slice();
+    dest = slice;
+    return *this;
+  }
+
+  // Appends a value-initialized slice and returns a view of it.
+  typename array_view<NumDims-1>::type emplace_back_slice() {
+    const size_type slowest = this->storage_order().ordering(NumDims-1);
+
+    size_list new_extents = this->extent_list_;
+    ++new_extents[slowest];
+
+    // Growing the capacity only pays when the resize below keeps the
+    // allocation; otherwise it copies everything into an exact-size one.
+    if (resizes_in_place(new_extents)) {
+      size_type slice_elements = 1;
+      for (size_type i = 0; i != NumDims; ++i)
+        if (i != slowest)
+          slice_elements *= this->extent_list_[i];
+
+      const size_type needed = this->num_elements() + slice_elements;
+      if (needed > allocated_elements_)
+        reserve((std::max)(needed,2 * allocated_elements_));
+    }
+
+    typedef detail::multi_array::extent_gen<NumDims> gen_type;
+    typedef typename gen_type::range range_type;
+    gen_type ranges;
+    for (size_type i = 0; i != NumDims; ++i) {
+      const index base = this->index_base_list_[i];
+      ranges.ranges_[i] = range_type(base,base + index(new_extents[i]));
+    }
+    resize(ranges);
+
+    typedef multi_array_types::index_range index_range;
+    detail::multi_array::index_gen<NumDims,NumDims-1> slice_indices;
+    for (size_type i = 0; i != NumDims; ++i)
+      slice_indices.ranges_[i] = index_range();
+    slice_indices.ranges_[slowest] =
+      index_range(this->index_base_list_[slowest] +
+                  index(this->extent_list_[slowest]) - 1);
+    return (*this)[slice_indices];
+  }
+
+  // The number of elements the current allocation can hold.  Resizes
+  // that only change the slowest varying dimension do not reallocate
+  // as long as the new number of elements fits.
+  size_type capacity() const { return allocated_elements_; }
+
+  void reserve(size_type new_capacity) {
+    if (new_capacity > allocated_elements_)
+      reallocate(new_capacity);
+  }
+
+  Allocator get_allocator() const { return allocator(); }
+
+  // Hands the allocation over to the caller and leaves the array empty.
+  // The caller becomes responsible for destroying and deallocating the
+  // capacity() elements (as read before the call) through an allocator
+  // equal to get_allocator(), or for adopting them into another array.
+  T* release() {
+    T* storage = base_;
+    base_ = 0;
+    allocated_elements_ = 0;
+    this->set_base_ptr(0);
+    size_list no_extents;
+    no_extents.assign(0);
+    this->index_base_list_.assign(0);
+    this->init_multi_array_ref(no_extents.begin());
+    return storage;
+  }
+
 private:
   friend inline bool operator==(const multi_array& a, const multi_array& b) {
     return a.base() == b.base();
@@ -542,27 +688,75 @@ private:
   }
 
   void allocate_space() {
+    BOOST_MULTI_ARRAY_TRACE_ALLOCATION(T,NumDims,this->num_elements());
     base_ = allocator().allocate(this->num_elements());
     this->set_base_ptr(base_);
     allocated_elements_ = this->num_elements();
     boost::alloc_construct_n(allocator(),base_,allocated_elements_);
   }
 
+  typedef boost::array<size_type,NumDims> size_list;
+  typedef boost::array<index,NumDims> index_list;
+
+  // True if resizing to new_extents leaves the position in memory of
+  // every surviving element unchanged.
+  bool resizes_in_place(const size_list& new_extents) const {
+    const size_type slowest = this->storage_order().ordering(NumDims-1);
+    for (size_type i = 0; i != NumDims; ++i) {
+      if (new_extents[i] != this->extent_list_[i] &&
+          (i != slowest || !this->storage_order().ascending(i)))
+        return false;
+    }
+    return true;
+  }
+
+  // Moves the elements to a new allocation of new_capacity elements,
+  // keeping their offsets from the start of the allocation.  Elements
+  // past num_elements() are value-initialized.
+  void reallocate(size_type new_capacity) {
+    const size_type kept = this->num_elements();
+    BOOST_ASSERT(new_capacity >= kept);
+    BOOST_MULTI_ARRAY_TRACE_ALLOCATION(T,NumDims,new_capacity);
+    T* new_base = allocator().allocate(new_capacity);
+    BOOST_TRY {
+      boost::alloc_construct_n(allocator(),new_base,kept,base_);
+      BOOST_TRY {
+        boost::alloc_construct_n(allocator(),new_base+kept,
+                                 new_capacity-kept);
+      }
+      BOOST_CATCH(...) {
+        boost::alloc_destroy_n(allocator(),new_base,kept);
+        BOOST_RETHROW
+      }
+      BOOST_CATCH_END
+    }
+    BOOST_CATCH(...) {
+      allocator().deallocate(new_base,new_capacity);
+      BOOST_RETHROW
+    }
+    BOOST_CATCH_END
+
+    deallocate_space();
+    base_ = new_base;
+    this->set_base_ptr(base_);
+    allocated_elements_ = new_capacity;
+  }
+
   void deallocate_space() {
     if(base_) {
+      BOOST_MULTI_ARRAY_TRACE_DEALLOCATION(T,NumDims,allocated_elements_);
       boost::alloc_destroy_n(allocator(),base_,allocated_elements_);
       allocator().deallocate(base_,allocated_elements_);
     }
   }
 
-  typedef boost::array<size_type,NumDims> size_list;
-  typedef boost::array<index,NumDims> index_list;
-
   T* base_;
   size_type allocated_elements_;
   enum {initial_base_ = 0};
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace boost
 
 #if defined(__GNUC__) && ((__GNUC__*100 + __GNUC_MINOR__) >= 406)
@@ -0,0 +1,539 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_ACCESS_PROFILE_HPP
+#define BOOST_MULTI_ARRAY_ACCESS_PROFILE_HPP
+
+//
+// access_profile.hpp - finding out how a kernel walks an array: the
+// stride between successive element accesses, the cache lines they
+// touch, and which dimension moves fastest, so as to pick a storage
+// order.  Everything is estimated from the indices; no hardware
+// counters are needed.
+//
+//   access_profile profile(sample_period,line_bytes)
+//     Collects the accesses of the profiled arrays, by call site.  One
+//     access in sample_period (default 1: every access) is recorded;
+//     line_bytes (default 64) is the cache line size assumed.
+//
+//   profiled_array<Array> p = profile_accesses(profile,a,site)
+//   BOOST_MULTI_ARRAY_PROFILE(profile,a)
+//     A wrapper around a (a multi_array, multi_array_ref or
+//     multi_array_view, const or not, referred to without copying)
+//     whose accesses are recorded under the name site; the macro names
+//     the site after the file and line.  p(idx), p[i][j]... and
+//     p.begin() to p.end(), whose iterators step along the first
+//     dimension and are indexed on like p[i], give the element as a
+//     reference, as the array does, const if a is; p.array() gives the
+//     array itself, for accesses that are not to be recorded.
+//
+//   profile.report(os)
+//     Prints, for every site, the share of accesses at each stride
+//     (the same element, the next one, within a cache line, beyond it),
+//     the estimated cache lines per access, a histogram of the index
+//     steps in each dimension, and a recommended storage ordering:
+//     the dimensions from the one that changes most often to the one
+//     that changes least, which is what
+//       general_storage_order<N>(ordering,ascending)
+//     takes.  profile.sites() gives the same figures as data.
+//
+// Accesses through the iterators of the array itself or of its views
+// are not recorded.  A profiled_array must be used from one thread at a
+// time.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/config.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/iterator/iterator_facade.hpp"
+#include "boost/type_traits/remove_const.hpp"
+#include "boost/type_traits/remove_reference.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace boost {
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// access_site_profile
+//   The accesses recorded at one site.
+//
+struct access_site_profile {
+  // stride buckets: the distance between an access and the one before
+  enum { same_element, unit_stride, within_line, beyond_line,
+         num_stride_buckets };
+  // index step buckets, per dimension
+  enum { step_back_far, step_back, no_step, step_forward, step_forward_far,
+         num_step_buckets };
+
+  typedef boost::array<boost::uint64_t,num_step_buckets> step_histogram;
+
+  access_site_profile() : element_size(0), line_bytes(0), accesses(0),
+    sampled(0), line_changes(0) {
+    std::fill(strides_histogram,strides_histogram + num_stride_buckets,
+              boost::uint64_t(0));
+  }
+
+  std::size_t num_dimensions() const { return strides.size(); }
+
+  // the estimated cache lines touched per sampled access
+  double lines_per_access() const {
+    return sampled == 0 ? 0 : double(line_changes) / double(sampled);
+  }
+
+  // how often each dimension's index changed between accesses
+  boost::uint64_t changes(std::size_t dim) const {
+    const step_histogram& h = steps[dim];
+    return h[step_back_far] + h[step_back] + h[step_forward] +
+      h[step_forward_far];
+  }
+
+  // the dimensions from the smallest stride to the largest, as
+  // general_storage_order's ordering
+  std::vector<std::size_t> current_ordering() const {
+    std::vector<std::size_t> result(num_dimensions());
+    for (std::size_t n = 0; n != result.size(); ++n)
+      result[n] = n;
+    std::stable_sort(result.begin(),result.end(),smaller_stride(strides));
+    return result;
+  }
+
+  // the dimensions from the one changing most often to the least (ties
+  // keeping the current order): the storage ordering that makes the
+  // most frequent steps the shortest
+  std::vector<std::size_t> recommended_ordering() const {
+    std::vector<std::size_t> result = current_ordering();
+    std::stable_sort(result.begin(),result.end(),more_changes(*this));
+    return result;
+  }
+
+  std::string site;
+  std::size_t element_size;
+  std::size_t line_bytes;
+  std::vector<multi_array_types::index> strides;   // of the array
+  boost::uint64_t accesses;                       // recorded or not
+  boost::uint64_t sampled;
+  boost::uint64_t strides_histogram[num_stride_buckets];
+  boost::uint64_t line_changes;
+  std::vector<step_histogram> steps;              // per dimension
+
+private:
+  struct smaller_stride {
+    explicit smaller_stride(const std::vector<multi_array_types::index>& s) :
+      strides(&s) { }
+    bool operator()(std::size_t a, std::size_t b) const {
+      multi_array_types::index sa = (*strides)[a], sb = (*strides)[b];
+      return (sa < 0 ? -sa : sa) < (sb < 0 ? -sb : sb);
+    }
+    const std::vector<multi_array_types::index>* strides;
+  };
+
+  struct more_changes {
+    explicit more_changes(const access_site_profile& p) : profile(&p) { }
+    bool operator()(std::size_t a, std::size_t b) const {
+      return profile->changes(a) > profile->changes(b);
+    }
+    const access_site_profile* profile;
+  };
+};
+
+class access_profile {
+public:
+  typedef std::map<std::string,access_site_profile> site_map;
+
+  explicit access_profile(std::size_t sample_period = 1,
+                          std::size_t line_bytes = 64) :
+    sample_period_(sample_period == 0 ? 1 : sample_period),
+    line_bytes_(line_bytes == 0 ? 64 : line_bytes) { }
+
+  std::size_t sample_period() const { return sample_period_; }
+  std::size_t line_bytes() const { return line_bytes_; }
+
+  const site_map& sites() const { return sites_; }
+  void clear() { sites_.clear(); }
+
+  // The profile of site, created for an array of the given element size
+  // and strides the first time.
+  access_site_profile& site(const std::string& name,
+                            std::size_t element_size,
+                            const multi_array_types::index* strides,
+                            std::size_t num_dims) {
+    access_site_profile& p = sites_[name];
+    if (p.site.empty()) {
+      p.site = name;
+      p.element_size = element_size;
+      p.line_bytes = line_bytes_;
+      p.strides.assign(strides,strides + num_dims);
+      p.steps.assign(num_dims,access_site_profile::step_histogram());
+      for (std::size_t n = 0; n != num_dims; ++n)
+        p.steps[n].assign(0);
+    }
+    BOOST_ASSERT(p.num_dimensions() == num_dims);
+    return p;
+  }
+
+  void report(std::ostream& os) const {
+    static const char* const stride_names[] =
+      { "same element", "unit stride", "within a line", "beyond a line" };
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    for (site_map::const_iterator i = sites_.begin(); i != sites_.end();
+         ++i) {
+      const access_site_profile& p = i->second;
+      out << p.site << ": " << p.num_dimensions() << "-d, strides";
+      for (std::size_t n = 0; n != p.num_dimensions(); ++n)
+        out << ' ' << p.strides[n];
+      out << ", " << p.element_size << "-byte elements\n"
+          << "  accesses: " << p.accesses << " (" << p.sampled
+          << " sampled)\n  stride:";
+      for (int b = 0; b != access_site_profile::num_stride_buckets; ++b)
+        out << "  " << stride_names[b] << ' '
+            << percent(p.strides_histogram[b],p.sampled) << '%';
+      out << "\n  cache lines per access: " << std::setprecision(3)
+          << p.lines_per_access() << std::setprecision(1)
+          << " (" << p.line_bytes << "-byte lines)\n"
+          << "  dimension     <-1      -1       0      +1     >+1"
+             "   (% of steps)\n";
+      for (std::size_t n = 0; n != p.num_dimensions(); ++n) {
+        out << "  " << std::setw(9) << n;
+        for (int b = 0; b != access_site_profile::num_step_buckets; ++b)
+          out << std::setw(8) << percent(p.steps[n][b],p.sampled);
+        out << '\n';
+      }
+      const std::vector<std::size_t> current = p.current_ordering();
+      const std::vector<std::size_t> recommended = p.recommended_ordering();
+      out << "  storage ordering: current";
+      for (std::size_t n = 0; n != current.size(); ++n)
+        out << ' ' << current[n];
+      out << ", recommended";
+      for (std::size_t n = 0; n != recommended.size(); ++n)
+        out << ' ' << recommended[n];
+      out << (current == recommended ? " (keep)\n" : " (change)\n");
+    }
+    os << out.str();
+  }
+
+private:
+  static double percent(boost::uint64_t part, boost::uint64_t whole) {
+    return whole == 0 ? 0 : 100.0 * double(part) / double(whole);
+  }
+
+  // noncopyable
+  access_profile(const access_profile&);
+  access_profile& operator=(const access_profile&);
+
+  std::size_t sample_period_;
+  std::size_t line_bytes_;
+  site_map sites_;
+};
+
+template <typename Array>
+class profiled_array;
+
+BOOST_MULTI_ARRAY_ABI_END
+
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Profiled, std::size_t Remaining>
+class profiled_subscript;
+
+// The element reference a profiled_array gives: const for the const
+// references and views.
+template <typename Array>
+struct profiled_reference {
+  typedef typename Array::element& type;
+};
+
+template <typename T, std::size_t NumDims, typename TPtr>
+struct profiled_reference<boost::const_multi_array_ref<T,NumDims,TPtr> > {
+  typedef const T& type;
+};
+
+template <typename T, std::size_t NumDims, typename TPtr>
+struct profiled_reference<const_multi_array_view<T,NumDims,TPtr> > {
+  typedef const T& type;
+};
+
+// What indexing with one more index gives: a further subscript, or the
+// element once every index is known.
+template <typename Profiled, std::size_t Remaining>
+struct profiled_subscript_result {
+  typedef profiled_subscript<Profiled,Remaining> type;
+
+  static type make(Profiled& p,
+                   const boost::array<index,Profiled::dimensionality>& idx) {
+    return type(p,idx);
+  }
+};
+
+template <typename Profiled>
+struct profiled_subscript_result<Profiled,0> {
+  typedef typename Profiled::reference type;
+
+  static type make(Profiled& p,
+                   const boost::array<index,Profiled::dimensionality>& idx) {
+    return p(idx);
+  }
+};
+
+//
+// profiled_subscript
+//   A profiled_array indexed along its first dimensions, with Remaining
+//   dimensions still to index.
+//
+template <typename Profiled, std::size_t Remaining>
+class profiled_subscript {
+public:
+  typedef boost::array<index,Profiled::dimensionality> index_list;
+  typedef profiled_subscript_result<Profiled,Remaining - 1> result;
+
+  profiled_subscript(Profiled& p, const index_list& idx) :
+    profiled_(&p), idx_(idx) { }
+
+  typename result::type operator[](index i) const {
+    index_list idx = idx_;
+    idx[Profiled::dimensionality - Remaining] = i;
+    return result::make(*profiled_,idx);
+  }
+
+private:
+  Profiled* profiled_;
+  index_list idx_;
+};
+
+//
+// profiled_iterator
+//   Steps along the first dimension of a profiled_array.  Dereferencing
+//   gives what p[i] gives: the element, recorded, for a one-dimensional
+//   array, and otherwise a profiled_subscript to index further.
+//
+template <typename Profiled>
+class profiled_iterator :
+    public boost::iterator_facade<
+      profiled_iterator<Profiled>,
+      typename boost::remove_const<
+        typename boost::remove_reference<
+          typename profiled_subscript_result<
+            Profiled,Profiled::dimensionality - 1>::type>::type>::type,
+      boost::random_access_traversal_tag,
+      typename profiled_subscript_result<
+        Profiled,Profiled::dimensionality - 1>::type,
+      index> {
+  typedef profiled_subscript_result<Profiled,Profiled::dimensionality - 1>
+    result;
+  friend class ::boost::iterator_core_access;
+
+public:
+  profiled_iterator() : profiled_(0), i_(0) { }
+  profiled_iterator(Profiled& p, index i) : profiled_(&p), i_(i) { }
+
+private:
+  typename result::type dereference() const {
+    boost::array<index,Profiled::dimensionality> idx;
+    idx[0] = i_;
+    return result::make(*profiled_,idx);
+  }
+
+  bool equal(const profiled_iterator& other) const {
+    return i_ == other.i_;
+  }
+
+  void increment() { ++i_; }
+  void decrement() { --i_; }
+  void advance(index n) { i_ += n; }
+
+  index distance_to(const profiled_iterator& other) const {
+    return other.i_ - i_;
+  }
+
+  Profiled* profiled_;
+  index i_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Array>
+class profiled_array {
+public:
+  typedef typename Array::element element;
+  typedef typename detail::multi_array::profiled_reference<Array>::type
+    reference;
+  typedef detail::multi_array::profiled_iterator<profiled_array> iterator;
+  typedef multi_array_types::index index;
+  typedef multi_array_types::size_type size_type;
+  BOOST_STATIC_CONSTANT(std::size_t, dimensionality = Array::dimensionality);
+
+  profiled_array(access_profile& profile, const Array& array,
+                 const std::string& site) :
+    array_(array),
+    profile_(&profile.site(site,sizeof(element),array.strides(),
+                           dimensionality)),
+    period_(profile.sample_period()), countdown_(1),
+    line_bytes_(profile.line_bytes()), previous_(0) { }
+
+  Array& array() { return array_; }
+  const Array& array() const { return array_; }
+
+  const size_type* shape() const { return array_.shape(); }
+  const index* strides() const { return array_.strides(); }
+  const index* index_bases() const { return array_.index_bases(); }
+  size_type num_elements() const { return array_.num_elements(); }
+  size_type num_dimensions() const { return dimensionality; }
+
+  template <typename IndexList>
+  reference operator()(const IndexList& indices) {
+    boost::function_requires<
+      detail::multi_array::CollectionConcept<IndexList> >();
+    boost::array<index,dimensionality> idx;
+    std::copy(indices.begin(),indices.end(),idx.begin());
+    reference result = array_(idx);
+    record(idx,&result);
+    return result;
+  }
+
+  typename detail::multi_array::
+    profiled_subscript_result<profiled_array,dimensionality - 1>::type
+  operator[](index i) {
+    typedef detail::multi_array::
+      profiled_subscript_result<profiled_array,dimensionality - 1> result;
+    boost::array<index,dimensionality> idx;
+    idx[0] = i;
+    return result::make(*this,idx);
+  }
+
+  iterator begin() { return iterator(*this,index_bases()[0]); }
+
+  iterator end() {
+    return iterator(*this,index_bases()[0] + index(shape()[0]));
+  }
+
+private:
+  void record(const boost::array<index,dimensionality>& idx,
+              const element* address) {
+    access_site_profile& p = *profile_;
+    ++p.accesses;
+    if (previous_ != 0 && --countdown_ == 0) {
+      countdown_ = period_;
+      ++p.sampled;
+
+      // the distance, in elements and in cache lines
+      const std::ptrdiff_t distance = address - previous_;
+      const std::size_t magnitude =
+        std::size_t(distance < 0 ? -distance : distance);
+      if (magnitude == 0)
+        ++p.strides_histogram[access_site_profile::same_element];
+      else if (magnitude == 1)
+        ++p.strides_histogram[access_site_profile::unit_stride];
+      else if (magnitude * sizeof(element) < line_bytes_)
+        ++p.strides_histogram[access_site_profile::within_line];
+      else
+        ++p.strides_histogram[access_site_profile::beyond_line];
+      if (line_of(address) != line_of(previous_))
+        ++p.line_changes;
+
+      for (std::size_t n = 0; n != dimensionality; ++n) {
+        const index step = idx[n] - previous_idx_[n];
+        ++p.steps[n][step < -1 ? access_site_profile::step_back_far :
+                     step == -1 ? access_site_profile::step_back :
+                     step == 0 ? access_site_profile::no_step :
+                     step == 1 ? access_site_profile::step_forward :
+                     access_site_profile::step_forward_far];
+      }
+    }
+    previous_ = address;
+    previous_idx_ = idx;
+  }
+
+  std::size_t line_of(const element* address) const {
+    return reinterpret_cast<std::size_t>(address) / line_bytes_;
+  }
+
+  Array array_;
+  access_site_profile* profile_;
+  std::size_t period_;
+  std::size_t countdown_;
+  std::size_t line_bytes_;
+  const element* previous_;
+  boost::array<index,dimensionality> previous_idx_;
+};
+
+template <typename T, std::size_t NumDims, typename Allocator>
+profiled_array<multi_array_ref<T,NumDims> >
+profile_accesses(access_profile& profile, multi_array<T,NumDims,Allocator>& a,
+                 const std::string& site) {
+  return profiled_array<multi_array_ref<T,NumDims> >(profile,a,site);
+}
+
+template <typename T, std::size_t NumDims, typename Allocator>
+profiled_array<const_multi_array_ref<T,NumDims> >
+profile_accesses(access_profile& profile,
+                 const multi_array<T,NumDims,Allocator>& a,
+                 const std::string& site) {
+  return profiled_array<const_multi_array_ref<T,NumDims> >(profile,a,site);
+}
+
+template <typename T, std::size_t NumDims>
+profiled_array<multi_array_ref<T,NumDims> >
+profile_accesses(access_profile& profile, multi_array_ref<T,NumDims> a,
+                 const std::string& site) {
+  return profiled_array<multi_array_ref<T,NumDims> >(profile,a,site);
+}
+
+template <typename T, std::size_t NumDims, typename TPtr>
+profiled_array<const_multi_array_ref<T,NumDims,TPtr> >
+profile_accesses(access_profile& profile,
+                 const_multi_array_ref<T,NumDims,TPtr> a,
+                 const std::string& site) {
+  return profiled_array<const_multi_array_ref<T,NumDims,TPtr> >(profile,a,
+                                                                site);
+}
+
+template <typename T, std::size_t NumDims>
+profiled_array<detail::multi_array::multi_array_view<T,NumDims> >
+profile_accesses(access_profile& profile,
+                 detail::multi_array::multi_array_view<T,NumDims> a,
+                 const std::string& site) {
+  return profiled_array<detail::multi_array::multi_array_view<T,NumDims> >(
+    profile,a,site);
+}
+
+template <typename T, std::size_t NumDims, typename TPtr>
+profiled_array<detail::multi_array::const_multi_array_view<T,NumDims,TPtr> >
+profile_accesses(access_profile& profile,
+                 detail::multi_array::const_multi_array_view<T,NumDims,TPtr> a,
+                 const std::string& site) {
+  return profiled_array<
+    detail::multi_array::const_multi_array_view<T,NumDims,TPtr> >(profile,a,
+                                                                   site);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+// Profiles the accesses to array under the name "file:line".
+#define BOOST_MULTI_ARRAY_PROFILE(profile,array)                           \
+  ::boost::profile_accesses(profile,array,                                 \
+                            __FILE__ ":" BOOST_STRINGIZE(__LINE__))
+
+#endif
@@ -18,6 +18,7 @@
 // functionality is acquired
 //
 
+#include "boost/multi_array/collapse.hpp"
 #include "boost/multi_array/extent_range.hpp"
 #include "boost/multi_array/extent_gen.hpp"
 #include "boost/multi_array/index_range.hpp"
@@ -26,18 +27,36 @@
 #include "boost/multi_array/types.hpp"
 #include "boost/config.hpp"
 #include "boost/multi_array/concept_checks.hpp" //for ignore_unused_...
-#include "boost/mpl/eval_if.hpp"
-#include "boost/mpl/if.hpp"
 #include "boost/mpl/size_t.hpp"
 #include "boost/iterator/reverse_iterator.hpp"
 #include "boost/static_assert.hpp"
 #include "boost/type.hpp"
 #include "boost/assert.hpp"
+#include "boost/throw_exception.hpp"
+#include "boost/type_traits/is_integral.hpp"
+#include "boost/utility/enable_if.hpp"
+#include "boost/limits.hpp"
+#include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <stdexcept>
+
+// The instrumentation hooks (see instrumentation.hpp) do nothing unless
+// BOOST_MULTI_ARRAY_INSTRUMENTATION is defined.
+#if defined(BOOST_MULTI_ARRAY_INSTRUMENTATION)
+#include "boost/multi_array/instrumentation.hpp"
+#else
+#define BOOST_MULTI_ARRAY_TRACE_ALLOCATION(T,num_dims,elements) ((void)0)
+#define BOOST_MULTI_ARRAY_TRACE_DEALLOCATION(T,num_dims,elements) ((void)0)
+#define BOOST_MULTI_ARRAY_TRACE_VIEW(T,num_dims,extents) ((void)0)
+#define BOOST_MULTI_ARRAY_TRACE_COPY(source,destination,fast_path) ((void)0)
+#define BOOST_MULTI_ARRAY_TRACE_RESIZE(array,new_elements,in_place) ((void)0)
+#endif
 
 namespace boost {
 
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
 /////////////////////////////////////////////////////////////////////////
 // class declarations
 /////////////////////////////////////////////////////////////////////////
@@ -46,6 +65,12 @@ template<typename T, std::size_t NumDims,
   typename Allocator = std::allocator<T> >
 class multi_array;
 
+template <typename T, std::size_t NumDims, typename TPtr>
+class const_multi_array_ref;
+
+template <typename T, std::size_t NumDims>
+class multi_array_ref;
+
 // This is a public interface for use by end users!
 namespace multi_array_types {
   typedef boost::detail::multi_array::size_type size_type;
@@ -71,8 +96,11 @@ namespace {
 }
 #endif // BOOST_MULTI_ARRAY_NO_GENERATORS
 
+BOOST_MULTI_ARRAY_ABI_END
+
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
 template <typename T, std::size_t NumDims>
 class sub_array;
@@ -90,6 +118,188 @@ class const_multi_array_view;
 template <typename T, std::size_t NumDims>
 class multi_array_view;
 
+//
+// check_const_multi_array
+//  checks the ConstMultiArrayConcept for the source of an assignment.
+//  The library's own array types of the right rank model the concept
+//  by construction, and checking them is costly: the check builds views
+//  of every rank, and a nested assignment repeats it at every level.  So
+//  for them the check is skipped.
+//
+template <typename Array, std::size_t NumDims>
+struct const_multi_array_check {
+  static void check() {
+    function_requires<
+      multi_array_concepts::ConstMultiArrayConcept<Array,NumDims> >();
+  }
+};
+
+template <typename T, std::size_t NumDims, typename TPtr>
+struct const_multi_array_check<const_sub_array<T,NumDims,TPtr>,NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims>
+struct const_multi_array_check<sub_array<T,NumDims>,NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims, typename TPtr>
+struct const_multi_array_check<const_multi_array_view<T,NumDims,TPtr>,
+                               NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims>
+struct const_multi_array_check<multi_array_view<T,NumDims>,NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims, typename TPtr>
+struct const_multi_array_check<const_multi_array_ref<T,NumDims,TPtr>,
+                               NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims>
+struct const_multi_array_check<multi_array_ref<T,NumDims>,NumDims> {
+  static void check() { }
+};
+
+template <typename T, std::size_t NumDims, typename Allocator>
+struct const_multi_array_check<boost::multi_array<T,NumDims,Allocator>,
+                               NumDims> {
+  static void check() { }
+};
+
+template <typename Array, std::size_t NumDims>
+inline void check_const_multi_array() {
+  const_multi_array_check<Array,NumDims>::check();
+}
+
+//
+// checked_num_elements
+//   the number of elements of an array with the given extents.  Throws
+//   std::length_error when the product of the nonzero extents does not
+//   fit the index type, since every stride and offset of the array is
+//   bounded by that product and would otherwise wrap.
+//
+template <typename SizeIterator>
+size_type checked_num_elements(SizeIterator extents, std::size_t num_dims) {
+  const size_type max_count = size_type((std::numeric_limits<index>::max)());
+  size_type count = 1;
+  bool empty = false;
+  for (std::size_t n = 0; n != num_dims; ++n, ++extents) {
+    const size_type extent = *extents;
+    if (extent == 0) {
+      empty = true;
+    } else if (count > max_count / extent) {
+      boost::throw_exception(
+        std::length_error("multi_array: too many elements"));
+    } else {
+      count *= extent;
+    }
+  }
+  return empty ? 0 : count;
+}
+
+//
+// copy_elements
+//   copies source onto destination, an array of the same shape.  When
+//   the two lay out their elements densely in the same order (see
+//   same_dense_layout in collapse.hpp) that is one flat copy between the
+//   first elements; otherwise the elements are walked in index order.
+//
+template <typename Source, typename Destination>
+void copy_elements(const Source& source, Destination& destination) {
+  const bool flat = same_dense_layout(source,destination);
+  BOOST_MULTI_ARRAY_TRACE_COPY(source,destination,flat);
+  if (flat) {
+    const std::size_t num_dims = destination.num_dimensions();
+    const typename Source::element* first =
+      first_element(source.origin(),num_dims,source.strides(),
+                    source.index_bases());
+    std::copy(first,first + source.num_elements(),
+              first_element(destination.origin(),num_dims,
+                            destination.strides(),
+                            destination.index_bases()));
+  } else {
+    std::copy(source.begin(),source.end(),destination.begin());
+  }
+}
+
+// Compares the elements of two arrays of the same shape, as one flat
+// range when they lie densely in the same order.
+template <typename Array1, typename Array2>
+bool equal_elements(const Array1& a, const Array2& b) {
+  if (!same_dense_layout(a,b))
+    return std::equal(a.begin(),a.end(),b.begin());
+  const std::size_t num_dims = a.num_dimensions();
+  const typename Array1::element* first =
+    first_element(a.origin(),num_dims,a.strides(),a.index_bases());
+  return std::equal(first,first + a.num_elements(),
+                    first_element(b.origin(),num_dims,b.strides(),
+                                  b.index_bases()));
+}
+
+// The result of operator()(IndexList) and at(IndexList), which leave
+// integral arguments to operator()(index...) and at(index...).
+template <typename IndexList, typename Reference>
+struct index_list_result :
+  boost::disable_if<boost::is_integral<IndexList>,Reference> { };
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+
+//
+// Element access through NumDims integral arguments, A(i,j,k): the
+// offset is a sum unrolled at compile time, with no index list built.
+//
+template <typename... Indices>
+struct all_integral;
+
+template <>
+struct all_integral<> {
+  BOOST_STATIC_CONSTANT(bool, value = true);
+};
+
+template <typename Index, typename... Indices>
+struct all_integral<Index,Indices...> {
+  BOOST_STATIC_CONSTANT(bool, value = boost::is_integral<Index>::value &&
+                        all_integral<Indices...>::value);
+};
+
+// The result of operator()(index...) and its relatives.
+template <std::size_t NumDims, typename Reference, typename... Indices>
+struct indices_result :
+  boost::enable_if_c<sizeof...(Indices) == NumDims &&
+                     all_integral<Indices...>::value,Reference> { };
+
+inline multi_array_types::index
+indices_offset(const multi_array_types::index*) { return 0; }
+
+template <typename... Indices>
+inline multi_array_types::index
+indices_offset(const multi_array_types::index* strides,
+               multi_array_types::index i, Indices... rest) {
+  return i * *strides + indices_offset(strides + 1,rest...);
+}
+
+inline bool indices_in_range(const multi_array_types::size_type*,
+                             const multi_array_types::index*) {
+  return true;
+}
+
+template <typename... Indices>
+inline bool indices_in_range(const multi_array_types::size_type* extents,
+                             const multi_array_types::index* index_bases,
+                             multi_array_types::index i, Indices... rest) {
+  return i - *index_bases >= 0 &&
+    multi_array_types::size_type(i - *index_bases) < *extents &&
+    indices_in_range(extents + 1,index_bases + 1,rest...);
+}
+
+#endif // BOOST_NO_CXX11_VARIADIC_TEMPLATES
+
 /////////////////////////////////////////////////////////////////////////
 // class interfaces
 /////////////////////////////////////////////////////////////////////////
@@ -126,17 +336,22 @@ public:
 
 protected:
   // used by array operator[] and iterators to get reference types.
+  // element_counts, when not null, is the table of the numbers of
+  // elements below each dimension (see const_multi_array_ref), which
+  // the sub_array passes on rather than multiplying its extents.
   template <typename Reference, typename TPtr>
   Reference access(boost::type<Reference>,index idx,TPtr base,
                    const size_type* extents,
                    const index* strides,
-                   const index* index_bases) const {
+                   const index* index_bases,
+                   const size_type* element_counts = 0) const {
 
     BOOST_ASSERT(idx - index_bases[0] >= 0);
     BOOST_ASSERT(size_type(idx - index_bases[0]) < extents[0]);
     // return a sub_array<T,NDims-1> proxy object
     TPtr newbase = base + idx * strides[0];
-    return Reference(newbase,extents+1,strides+1,index_bases+1);
+    return Reference(newbase,extents+1,strides+1,index_bases+1,
+                     element_counts);
 
   }
 
@@ -170,7 +385,8 @@ protected:
   Reference access(boost::type<Reference>,index idx,TPtr base,
                    const size_type* extents,
                    const index* strides,
-                   const index* index_bases) const {
+                   const index* index_bases,
+                   const size_type* /*element_counts*/ = 0) const {
 
     ignore_unused_variable_warning(index_bases);
     ignore_unused_variable_warning(extents);
@@ -188,6 +404,20 @@ protected:
 // choose value accessor begins
 //
 
+// The accessor is picked by partial specialization on the rank rather
+// than by mpl::eval_if, which saves an instantiation of the mpl
+// machinery for every element type and rank in use.
+template <typename T, std::size_t NumDims>
+struct choose_value_accessor {
+  typedef value_accessor_n<T,NumDims> type;
+};
+
+template <typename T>
+struct choose_value_accessor<T,1> {
+  typedef value_accessor_one<T> type;
+};
+
+// The former selectors, kept for compatibility.
 template <typename T, std::size_t NumDims>
 struct choose_value_accessor_n {
   typedef value_accessor_n<T,NumDims> type;
@@ -199,15 +429,9 @@ struct choose_value_accessor_one {
 };
 
 template <typename T, typename NumDims>
-struct value_accessor_generator {
-    BOOST_STATIC_CONSTANT(std::size_t, dimensionality = NumDims::value);
-    
-  typedef typename
-  mpl::eval_if_c<(dimensionality == 1),
-                  choose_value_accessor_one<T>,
-                  choose_value_accessor_n<T,dimensionality>
-  >::type type;
-};
+struct value_accessor_generator
+  : choose_value_accessor<T,NumDims::value>
+{};
 
 template <class T, class NumDims>
 struct associated_types
@@ -238,9 +462,9 @@ struct mutable_iterator_tag
 template <typename T, std::size_t NumDims>
 class multi_array_impl_base
   :
-      public value_accessor_generator<T,mpl::size_t<NumDims> >::type
+      public choose_value_accessor<T,NumDims>::type
 {
-  typedef associated_types<T,mpl::size_t<NumDims> > types;
+  typedef typename choose_value_accessor<T,NumDims>::type types;
 public:
   typedef typename types::index index;
   typedef typename types::size_type size_type;
@@ -249,6 +473,8 @@ public:
   typedef typename types::value_type value_type;
   typedef typename types::reference reference;
   typedef typename types::const_reference const_reference;
+  // The result of collapsed_shape(); see collapse.hpp.
+  typedef collapsed_dimensions<NumDims> collapsed_shape_type;
 
   template <std::size_t NDims>
   struct subarray {
@@ -326,6 +552,71 @@ protected:
     return base[offset];
   }
 
+  // Used by at() in our array classes: as access_element, but checking
+  // the indices in every build.
+  template <typename Reference, typename IndexList, typename TPtr>
+  Reference access_element_checked(boost::type<Reference>,
+                                   const IndexList& indices,
+                                   TPtr base,
+                                   const size_type* extents,
+                                   const index* strides,
+                                   const index* index_bases) const {
+    boost::function_requires<
+      CollectionConcept<IndexList> >();
+    if (size_type(indices.size()) != NumDims)
+      boost::throw_exception(
+        std::out_of_range("multi_array::at: wrong number of indices"));
+    index offset = 0;
+    typename IndexList::const_iterator i = indices.begin();
+    for (size_type n = 0; n != NumDims; ++n, ++i) {
+      if (*i - index_bases[n] < 0 ||
+          size_type(*i - index_bases[n]) >= extents[n])
+        boost::throw_exception(
+          std::out_of_range("multi_array::at: index out of range"));
+      offset += (*i) * strides[n];
+    }
+    return base[offset];
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  // Used by operator()(index...) in our array classes
+  template <typename Reference, typename TPtr, typename... Indices>
+  Reference access_indices(boost::type<Reference>,
+                           TPtr base,
+                           const size_type* extents,
+                           const index* strides,
+                           const index* index_bases,
+                           Indices... indices) const {
+    ignore_unused_variable_warning(index_bases);
+    ignore_unused_variable_warning(extents);
+    BOOST_ASSERT(indices_in_range(extents,index_bases,index(indices)...));
+    return base[indices_offset(strides,index(indices)...)];
+  }
+
+  // Used by at(index...)
+  template <typename Reference, typename TPtr, typename... Indices>
+  Reference access_indices_checked(boost::type<Reference>,
+                                   TPtr base,
+                                   const size_type* extents,
+                                   const index* strides,
+                                   const index* index_bases,
+                                   Indices... indices) const {
+    if (!indices_in_range(extents,index_bases,index(indices)...))
+      boost::throw_exception(
+        std::out_of_range("multi_array::at: index out of range"));
+    return base[indices_offset(strides,index(indices)...)];
+  }
+
+  // Used by unchecked(index...): no check even in debug builds
+  template <typename Reference, typename TPtr, typename... Indices>
+  Reference access_indices_unchecked(boost::type<Reference>,
+                                     TPtr base,
+                                     const index* strides,
+                                     Indices... indices) const {
+    return base[indices_offset(strides,index(indices)...)];
+  }
+#endif
+
   template <typename StrideList, typename ExtentList>
   void compute_strides(StrideList& stride_list, ExtentList& extent_list,
                        const general_storage_order<NumDims>& storage)
@@ -483,6 +774,7 @@ protected:
       }
     }
     BOOST_ASSERT(dim == NDims);
+    BOOST_MULTI_ARRAY_TRACE_VIEW(T,NDims,new_extents.data());
 
     return
       ArrayRef(base+offset,
@@ -493,6 +785,8 @@ protected:
 
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
 
@@ -0,0 +1,478 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_BINARY_IO_HPP
+#define BOOST_MULTI_ARRAY_BINARY_IO_HPP
+
+//
+// binary_io.hpp - saving and loading arrays of trivially copyable
+// elements to and from binary streams.
+//
+//   save(os,a)  writes any array, subarray or view
+//   load(is,a)  reads into a multi_array, which takes the saved shape and
+//               index bases, or into a multi_array_ref, subarray or
+//               view of the same shape as the saved array
+//
+// The stream holds a header followed by the elements:
+//
+//   magic        8 bytes   "BMARRAY" and a NUL
+//   version      1 byte    1
+//   byte order   1 byte    1 little endian, 2 big endian
+//   kind         1 byte    'i' signed, 'u' unsigned, 'f' floating point,
+//                          'b' bool, 'r' other trivially copyable types
+//   size         1 byte    sizeof(element)
+//   rank         4 bytes
+//   extents      8 bytes per dimension
+//   index bases  8 bytes per dimension
+//   ordering     4 bytes per dimension   (general_storage_order)
+//   ascending    1 byte per dimension
+//   elements     in the memory order the storage order describes
+//
+// Multi-byte header fields and elements are in the writer's byte order;
+// readers swap them when necessary ('r' elements cannot be swapped and
+// are rejected).  The recorded storage order is the one the saved
+// array is laid out in, so a dense array or view goes out with a single
+// write and comes back with a single read when the destination uses the
+// same storage order.  Strided data is gathered and scattered through a
+// staging buffer of BOOST_MULTI_ARRAY_IO_BUFFER_BYTES.  Errors throw
+// std::ios_base::failure, among them a shape too large to allocate or
+// index.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/throw_exception.hpp"
+#include "boost/type_traits/is_floating_point.hpp"
+#include "boost/type_traits/is_integral.hpp"
+#include "boost/type_traits/is_same.hpp"
+#include "boost/type_traits/is_signed.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#ifndef BOOST_MULTI_ARRAY_IO_BUFFER_BYTES
+#  define BOOST_MULTI_ARRAY_IO_BUFFER_BYTES (std::size_t(64) << 10)
+#endif
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T>
+struct element_kind {
+  BOOST_STATIC_CONSTANT(char, value =
+    (boost::is_same<T,bool>::value ? 'b' :
+     boost::is_floating_point<T>::value ? 'f' :
+     boost::is_integral<T>::value ?
+       (boost::is_signed<T>::value ? 'i' : 'u') :
+     'r'));
+};
+
+inline bool host_is_little_endian() {
+  const boost::uint16_t probe = 1;
+  return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+}
+
+inline void swap_bytes(void* data, std::size_t size, std::size_t count) {
+  unsigned char* bytes = static_cast<unsigned char*>(data);
+  for (; count != 0; --count, bytes += size)
+    std::reverse(bytes,bytes + size);
+}
+
+inline void io_failure(const char* what) {
+  boost::throw_exception(std::ios_base::failure(what));
+}
+
+inline void write_bytes(std::ostream& os, const void* data,
+                        std::size_t size) {
+  if (!os.write(static_cast<const char*>(data),std::streamsize(size)))
+    io_failure("boost::multi_array: write failed");
+}
+
+inline void read_bytes(std::istream& is, void* data, std::size_t size) {
+  if (!is.read(static_cast<char*>(data),std::streamsize(size)))
+    io_failure("boost::multi_array: unexpected end of stream");
+}
+
+template <typename Int>
+void write_field(std::ostream& os, Int value) {
+  write_bytes(os,&value,sizeof(Int));
+}
+
+template <typename Int>
+Int read_field(std::istream& is, bool swap) {
+  Int value;
+  read_bytes(is,&value,sizeof(Int));
+  if (swap)
+    swap_bytes(&value,sizeof(Int),1);
+  return value;
+}
+
+// The most elements an array of T can have: its size in bytes must fit
+// std::size_t, and its extents and strides must fit index.
+template <typename T>
+boost::uint64_t max_stored_elements() {
+  const boost::uint64_t by_index =
+    boost::uint64_t((std::numeric_limits<index>::max)());
+  const boost::uint64_t by_bytes =
+    boost::uint64_t((std::numeric_limits<std::size_t>::max)() / sizeof(T));
+  return (std::min)(by_index,by_bytes);
+}
+
+// Checks a shape read from a stream before it sizes anything: no
+// extent, and not the product of the extents, may exceed
+// max_stored_elements<T>(), which also keeps every extent within
+// size_type.  Returns the number of elements.
+template <typename T>
+size_type checked_element_count(std::size_t num_dims,
+                                const boost::uint64_t* extents) {
+  const boost::uint64_t limit = max_stored_elements<T>();
+  boost::uint64_t count = 1;
+  for (std::size_t n = 0; n != num_dims; ++n) {
+    if (extents[n] > limit ||
+        (extents[n] != 0 && count > limit / extents[n]))
+      io_failure("boost::multi_array: array too large");
+    count *= extents[n];
+  }
+  return size_type(count);
+}
+
+// Checks that the indices base to base + extent of a dimension read
+// from a stream fit index.
+inline index checked_index_base(boost::int64_t base,
+                                boost::uint64_t extent) {
+  const boost::int64_t lowest =
+    boost::int64_t((std::numeric_limits<index>::min)());
+  const boost::int64_t highest =
+    boost::int64_t((std::numeric_limits<index>::max)());
+  if (base < lowest || base > highest ||
+      extent > boost::uint64_t(highest) - boost::uint64_t(base))
+    io_failure("boost::multi_array: index base out of range");
+  return index(base);
+}
+
+static const char binary_magic[8] = { 'B','M','A','R','R','A','Y','\0' };
+
+template <std::size_t NumDims>
+struct binary_header {
+  bool swap;
+  boost::array<size_type,NumDims> extents;
+  boost::array<index,NumDims> index_bases;
+  boost::array<size_type,NumDims> ordering;
+  boost::array<bool,NumDims> ascending;
+
+  general_storage_order<NumDims> storage_order() const {
+    return general_storage_order<NumDims>(ordering.begin(),
+                                          ascending.begin());
+  }
+};
+
+template <typename T, std::size_t NumDims>
+void write_binary_header(std::ostream& os, const size_type* extents,
+                         const index* index_bases,
+                         const general_storage_order<NumDims>& so) {
+  write_bytes(os,binary_magic,sizeof(binary_magic));
+  const unsigned char prefix[4] = {
+    1, static_cast<unsigned char>(host_is_little_endian() ? 1 : 2),
+    static_cast<unsigned char>(element_kind<T>::value),
+    static_cast<unsigned char>(sizeof(T))
+  };
+  write_bytes(os,prefix,sizeof(prefix));
+  write_field(os,boost::uint32_t(NumDims));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint64_t(extents[n]));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::int64_t(index_bases[n]));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint32_t(so.ordering(n)));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint8_t(so.ascending(n) ? 1 : 0));
+}
+
+template <typename T, std::size_t NumDims>
+void read_binary_header(std::istream& is, binary_header<NumDims>& header) {
+  char magic[sizeof(binary_magic)];
+  read_bytes(is,magic,sizeof(magic));
+  if (std::memcmp(magic,binary_magic,sizeof(magic)) != 0)
+    io_failure("boost::multi_array: not a saved array");
+
+  unsigned char prefix[4];
+  read_bytes(is,prefix,sizeof(prefix));
+  if (prefix[0] != 1)
+    io_failure("boost::multi_array: unsupported format version");
+  if (prefix[1] != 1 && prefix[1] != 2)
+    io_failure("boost::multi_array: bad byte order mark");
+  header.swap = (prefix[1] == 1) != host_is_little_endian();
+  if (prefix[2] != static_cast<unsigned char>(element_kind<T>::value) ||
+      prefix[3] != sizeof(T))
+    io_failure("boost::multi_array: element type mismatch");
+  if (header.swap && element_kind<T>::value == 'r')
+    io_failure("boost::multi_array: cannot byte swap raw elements");
+
+  if (read_field<boost::uint32_t>(is,header.swap) != NumDims)
+    io_failure("boost::multi_array: dimensionality mismatch");
+  boost::array<boost::uint64_t,NumDims> extents;
+  for (std::size_t n = 0; n != NumDims; ++n)
+    extents[n] = read_field<boost::uint64_t>(is,header.swap);
+  checked_element_count<T>(NumDims,extents.data());
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    header.extents[n] = size_type(extents[n]);
+    header.index_bases[n] =
+      checked_index_base(read_field<boost::int64_t>(is,header.swap),
+                         extents[n]);
+  }
+
+  boost::array<bool,NumDims> seen;
+  seen.assign(false);
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    const boost::uint32_t dim = read_field<boost::uint32_t>(is,header.swap);
+    if (dim >= NumDims || seen[dim])
+      io_failure("boost::multi_array: bad storage order");
+    seen[dim] = true;
+    header.ordering[n] = dim;
+  }
+  for (std::size_t n = 0; n != NumDims; ++n)
+    header.ascending[n] = read_field<boost::uint8_t>(is,header.swap) != 0;
+}
+
+// Runs of a collapsed walk go to the stream directly when they are
+// contiguous and long, and through the staging buffer otherwise.
+template <typename T>
+class binary_writer {
+public:
+  binary_writer(std::ostream& os, std::size_t count) :
+    os_(os), buffer_(staging_elements(count)), used_(0) { }
+
+  void operator()(const T* ptr, size_type count, index stride) {
+    if (stride == 1 && count >= buffer_.size()) {
+      flush();
+      write_bytes(os_,ptr,count * sizeof(T));
+      return;
+    }
+    for (; count != 0; --count, ptr += stride) {
+      buffer_[used_++] = *ptr;
+      if (used_ == buffer_.size())
+        flush();
+    }
+  }
+
+  void flush() {
+    if (used_ != 0)
+      write_bytes(os_,&buffer_[0],used_ * sizeof(T));
+    used_ = 0;
+  }
+
+  // no more than the elements to transfer, and at least one
+  static std::size_t staging_elements(std::size_t count) {
+    const std::size_t limit =
+      std::size_t(BOOST_MULTI_ARRAY_IO_BUFFER_BYTES) / sizeof(T);
+    return (std::max)((std::min)(limit,count),std::size_t(1));
+  }
+
+private:
+  std::ostream& os_;
+  std::vector<T> buffer_;
+  std::size_t used_;
+};
+
+template <typename T>
+class binary_reader {
+public:
+  binary_reader(std::istream& is, bool swap, std::size_t count) :
+    is_(is), swap_(swap),
+    buffer_(binary_writer<T>::staging_elements(count)),
+    used_(0), filled_(0), remaining_(count) { }
+
+  void operator()(T* ptr, size_type count, index stride) {
+    if (stride == 1 && used_ == filled_) {
+      read_bytes(is_,ptr,count * sizeof(T));
+      if (swap_)
+        swap_bytes(ptr,sizeof(T),count);
+      remaining_ -= count;
+      return;
+    }
+    for (; count != 0; --count, ptr += stride) {
+      if (used_ == filled_)
+        refill();
+      *ptr = buffer_[used_++];
+    }
+  }
+
+private:
+  void refill() {
+    filled_ = (std::min)(buffer_.size(),remaining_);
+    read_bytes(is_,&buffer_[0],filled_ * sizeof(T));
+    if (swap_)
+      swap_bytes(&buffer_[0],sizeof(T),filled_);
+    remaining_ -= filled_;
+    used_ = 0;
+  }
+
+  std::istream& is_;
+  bool swap_;
+  std::vector<T> buffer_;
+  std::size_t used_;
+  std::size_t filled_;
+  std::size_t remaining_;
+};
+
+// Writes the elements in the memory order so describes.
+template <typename T, std::size_t NumDims>
+void write_elements(std::ostream& os, const general_storage_order<NumDims>& so,
+                    const T* origin, const size_type* extents,
+                    const index* strides, const index* index_bases) {
+  BOOST_STATIC_ASSERT(is_bitwise_copyable<T>::value);
+  size_type count = 1;
+  for (std::size_t n = 0; n != NumDims; ++n)
+    count *= extents[n];
+
+  collapsed_dimensions<NumDims> dims;
+  collapse_in_storage_order<NumDims>(extents,strides,so,dims);
+  binary_writer<T> writer(os,count);
+  for_each_run(first_element(origin,NumDims,strides,index_bases),dims,
+               writer);
+  writer.flush();
+}
+
+// Reads elements stored in the memory order so describes.
+template <typename T, std::size_t NumDims>
+void read_elements(std::istream& is, bool swap,
+                   const general_storage_order<NumDims>& so,
+                   T* origin, const size_type* extents,
+                   const index* strides, const index* index_bases) {
+  BOOST_STATIC_ASSERT(is_bitwise_copyable<T>::value);
+  collapsed_dimensions<NumDims> dims;
+  collapse_in_storage_order<NumDims>(extents,strides,so,dims);
+  size_type count = 1;
+  for (std::size_t n = 0; n != NumDims; ++n)
+    count *= extents[n];
+  binary_reader<T> reader(is,swap,count);
+  for_each_run(first_element(origin,NumDims,strides,index_bases),dims,
+               reader);
+}
+
+template <typename T, std::size_t NumDims>
+void save_elements(std::ostream& os, const T* origin,
+                   const size_type* extents, const index* strides,
+                   const index* index_bases) {
+  const general_storage_order<NumDims> so =
+    storage_order_from_strides<NumDims>(strides);
+  write_binary_header<T,NumDims>(os,extents,index_bases,so);
+  write_elements<T,NumDims>(os,so,origin,extents,strides,index_bases);
+}
+
+template <typename T, std::size_t NumDims>
+void load_elements(std::istream& is, const binary_header<NumDims>& header,
+                   T* origin, const size_type* extents,
+                   const index* strides, const index* index_bases) {
+  read_elements<T,NumDims>(is,header.swap,header.storage_order(),origin,
+                           extents,strides,index_bases);
+}
+
+template <typename T, std::size_t NumDims>
+void load_into(std::istream& is, T* origin, const size_type* extents,
+               const index* strides, const index* index_bases) {
+  binary_header<NumDims> header;
+  read_binary_header<T,NumDims>(is,header);
+  if (!std::equal(header.extents.begin(),header.extents.end(),extents))
+    io_failure("boost::multi_array: shape mismatch");
+  load_elements<T,NumDims>(is,header,origin,extents,strides,index_bases);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+// One overload per array kind rather than a template on any type, which
+// argument dependent lookup would offer for every two-argument save()
+// call on a type from namespace boost.  Arrays and references reach the
+// first, subarrays the second and views the third.
+template <typename T, std::size_t NumDims, typename TPtr>
+void save(std::ostream& os, const const_multi_array_ref<T,NumDims,TPtr>& a) {
+  detail::multi_array::save_elements<T,NumDims>(os,a.origin(),a.shape(),
+                                                a.strides(),a.index_bases());
+}
+
+template <typename T, std::size_t NumDims, typename TPtr>
+void save(std::ostream& os,
+          const detail::multi_array::const_sub_array<T,NumDims,TPtr>& a) {
+  detail::multi_array::save_elements<T,NumDims>(os,a.origin(),a.shape(),
+                                                a.strides(),a.index_bases());
+}
+
+template <typename T, std::size_t NumDims, typename TPtr>
+void save(std::ostream& os,
+          const detail::multi_array::const_multi_array_view<T,NumDims,TPtr>&
+            a) {
+  detail::multi_array::save_elements<T,NumDims>(os,a.origin(),a.shape(),
+                                                a.strides(),a.index_bases());
+}
+
+// Loading into a multi_array gives it the saved shape and index bases;
+// the array keeps its own storage order.  The elements are read into a
+// new array that replaces a only once the whole of it has been read,
+// so a failed load leaves a as it was.
+template <typename T, std::size_t NumDims, typename Allocator>
+void load(std::istream& is, multi_array<T,NumDims,Allocator>& a) {
+  detail::multi_array::binary_header<NumDims> header;
+  detail::multi_array::read_binary_header<T,NumDims>(is,header);
+
+  typedef detail::multi_array::extent_gen<NumDims> gen_type;
+  typedef typename gen_type::range range_type;
+  gen_type ranges;
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    const typename range_type::index base = header.index_bases[n];
+    ranges.ranges_[n] =
+      range_type(base,base + typename range_type::index(header.extents[n]));
+  }
+  multi_array<T,NumDims,Allocator> loaded(ranges,a.storage_order(),
+                                          a.get_allocator());
+  detail::multi_array::load_elements<T,NumDims>(is,header,loaded.origin(),
+                                                loaded.shape(),
+                                                loaded.strides(),
+                                                loaded.index_bases());
+  a.swap(loaded);
+}
+
+// Loading into references, subarrays and views requires the saved shape.
+template <typename T, std::size_t NumDims>
+void load(std::istream& is, multi_array_ref<T,NumDims> a) {
+  detail::multi_array::load_into<T,NumDims>(is,a.origin(),a.shape(),
+                                            a.strides(),a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load(std::istream& is, detail::multi_array::sub_array<T,NumDims> a) {
+  detail::multi_array::load_into<T,NumDims>(is,a.origin(),a.shape(),
+                                            a.strides(),a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load(std::istream& is,
+          detail::multi_array::multi_array_view<T,NumDims> a) {
+  detail::multi_array::load_into<T,NumDims>(is,a.origin(),a.shape(),
+                                            a.strides(),a.index_bases());
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
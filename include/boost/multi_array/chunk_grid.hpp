@@ -0,0 +1,78 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_CHUNK_GRID_HPP
+#define BOOST_MULTI_ARRAY_CHUNK_GRID_HPP
+
+//
+// chunk_grid.hpp - the division of an array into equally shaped chunks
+// (tiles), as used by the chunked file format and the paged array.
+//
+
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include <algorithm>
+#include <cstddef>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// chunk_grid
+//   The division of an array into chunks.  Chunks are numbered in
+//   row-major order of their position in the grid.
+//
+template <std::size_t NumDims>
+struct chunk_grid {
+  boost::array<size_type,NumDims> extents;
+  boost::array<size_type,NumDims> chunk_extents;
+  boost::array<size_type,NumDims> counts;
+  size_type num_chunks;
+
+  void init() {
+    num_chunks = 1;
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      // rounded up without forming extents + chunk_extents, which may
+      // overflow
+      counts[n] = chunk_extents[n] == 0 ? 0 :
+        extents[n] / chunk_extents[n] +
+          (extents[n] % chunk_extents[n] != 0 ? 1 : 0);
+      num_chunks *= counts[n];
+    }
+  }
+
+  // the chunk holding the element at idx
+  template <typename IndexIter>
+  size_type chunk_of(IndexIter idx) const {
+    size_type id = 0;
+    for (std::size_t n = 0; n != NumDims; ++n, ++idx)
+      id = id * counts[n] + size_type(*idx) / chunk_extents[n];
+    return id;
+  }
+
+  // the first index and the extents of chunk id
+  void chunk(size_type id, index* start, size_type* extents_out) const {
+    for (std::size_t n = NumDims; n != 0; --n) {
+      const std::size_t dim = n - 1;
+      const size_type position = id % counts[dim];
+      id /= counts[dim];
+      start[dim] = index(position * chunk_extents[dim]);
+      extents_out[dim] =
+        (std::min)(chunk_extents[dim],extents[dim] - size_type(start[dim]));
+    }
+  }
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+} // namespace boost
+
+#endif
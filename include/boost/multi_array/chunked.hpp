@@ -0,0 +1,779 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_CHUNKED_HPP
+#define BOOST_MULTI_ARRAY_CHUNKED_HPP
+
+//
+// chunked.hpp - a chunked, compressed container format for arrays too
+// large to handle in one piece.
+//
+//   save_chunked(os,a,chunk_extents,threads)
+//     Splits any array, subarray or view into chunks of chunk_extents
+//     (smaller at the far edges) and writes each one compressed.  Chunks
+//     are gathered and compressed by `threads` threads (0: one per
+//     hardware thread) where BOOST_MULTI_ARRAY_HAS_THREADS is defined,
+//     and one at a time otherwise.  The stream must be seekable.
+//
+//   chunked_reader<T,NumDims> r(is)
+//     Reads the header and chunk index of a stream written by
+//     save_chunked.  r.read(a) reads the whole array; r.read(region,a)
+//     reads the elements an index_gen selects, e.g.
+//       r.read(indices[range(100,200)][5][range()],out)
+//     decompressing only the chunks the region touches.  Regions are
+//     given in zero-based indices of the saved array; a multi_array
+//     destination is resized to the region's shape, and left as it was
+//     when reading fails; other destinations must have the shape.
+//
+// The stream holds
+//
+//   magic           8 bytes   "BMCHUNK" and a NUL
+//   version, byte order, kind, size    1 byte each, as in binary_io.hpp
+//   rank            4 bytes
+//   extents         8 bytes per dimension
+//   chunk extents   8 bytes per dimension
+//   codec           1 byte    1: byte shuffle followed by LZ compression
+//   chunk index     16 bytes per chunk: offset from the start of the
+//                   header and stored size, chunks in row-major order
+//   chunks          in any order
+//
+// A chunk holds its elements in row-major order.  Its first byte tells
+// whether the rest is compressed (1) or, when compression did not pay,
+// stored (0).  Compression first groups the bytes of the elements by
+// significance (all first bytes, then all second bytes, ...), which
+// turns slowly varying numbers into long runs, then replaces repeated
+// byte sequences by back references (an LZ77 variant: a token with
+// literal and match lengths, the literals, a 16 bit offset).
+// Errors throw std::ios_base::failure, among them a shape too large to
+// allocate or index and a chunk index that points past the stream.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/chunk_grid.hpp"
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/threads.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/config.hpp"
+#include "boost/core/no_exceptions_support.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+static const char chunked_magic[8] = { 'B','M','C','H','U','N','K','\0' };
+
+const unsigned char chunk_stored = 0;
+const unsigned char chunk_compressed = 1;
+
+// Groups the bytes of count elements of the given size by significance.
+inline void shuffle_bytes(const unsigned char* in, std::size_t size,
+                          std::size_t count, unsigned char* out) {
+  for (std::size_t b = 0; b != size; ++b)
+    for (std::size_t i = 0; i != count; ++i)
+      out[b * count + i] = in[i * size + b];
+}
+
+inline void unshuffle_bytes(const unsigned char* in, std::size_t size,
+                            std::size_t count, unsigned char* out) {
+  for (std::size_t b = 0; b != size; ++b)
+    for (std::size_t i = 0; i != count; ++i)
+      out[i * size + b] = in[b * count + i];
+}
+
+inline void lz_put_length(std::vector<unsigned char>& out, std::size_t n) {
+  for (; n >= 255; n -= 255)
+    out.push_back(255);
+  out.push_back(static_cast<unsigned char>(n));
+}
+
+// One sequence: a token holding the literal count and the match length
+// (less the minimum of four) in a nibble each, with 15 meaning that more
+// length bytes follow; the literals; the match offset.  The last
+// sequence has literals only.
+inline void lz_put_sequence(std::vector<unsigned char>& out,
+                            const unsigned char* literals,
+                            std::size_t num_literals,
+                            std::size_t offset, std::size_t match) {
+  const std::size_t match_code = offset == 0 ? 0 : match - 4;
+  out.push_back(static_cast<unsigned char>(
+    (std::min)(num_literals,std::size_t(15)) << 4 |
+    (std::min)(match_code,std::size_t(15))));
+  if (num_literals >= 15)
+    lz_put_length(out,num_literals - 15);
+  out.insert(out.end(),literals,literals + num_literals);
+  if (offset == 0)
+    return;
+  out.push_back(static_cast<unsigned char>(offset & 0xff));
+  out.push_back(static_cast<unsigned char>(offset >> 8));
+  if (match_code >= 15)
+    lz_put_length(out,match_code - 15);
+}
+
+inline void lz_compress(const unsigned char* in, std::size_t size,
+                        std::vector<unsigned char>& out) {
+  const std::size_t hash_bits = 12;
+  const std::size_t none = std::size_t(-1);
+  std::vector<std::size_t> table(std::size_t(1) << hash_bits,none);
+  std::size_t anchor = 0;
+  std::size_t pos = 0;
+  while (pos + 4 <= size) {
+    boost::uint32_t word;
+    std::memcpy(&word,in + pos,4);
+    const std::size_t hash =
+      std::size_t(boost::uint32_t(word * 2654435761u) >> (32 - hash_bits));
+    const std::size_t candidate = table[hash];
+    table[hash] = pos;
+    if (candidate != none && pos - candidate <= 0xffff &&
+        std::memcmp(in + candidate,in + pos,4) == 0) {
+      std::size_t match = 4;
+      while (pos + match != size && in[candidate + match] == in[pos + match])
+        ++match;
+      lz_put_sequence(out,in + anchor,pos - anchor,pos - candidate,match);
+      pos += match;
+      anchor = pos;
+    } else {
+      ++pos;
+    }
+  }
+  lz_put_sequence(out,in + anchor,size - anchor,0,0);
+}
+
+inline void corrupt_chunk() {
+  io_failure("boost::multi_array: corrupt chunk");
+}
+
+inline std::size_t lz_get_length(const unsigned char*& in,
+                                 const unsigned char* end, std::size_t n) {
+  if (n != 15)
+    return n;
+  for (;;) {
+    if (in == end)
+      corrupt_chunk();
+    const unsigned char more = *in++;
+    n += more;
+    if (more != 255)
+      return n;
+  }
+}
+
+inline void lz_decompress(const unsigned char* in, std::size_t in_size,
+                          unsigned char* out, std::size_t out_size) {
+  const unsigned char* const in_end = in + in_size;
+  unsigned char* const out_begin = out;
+  unsigned char* const out_end = out + out_size;
+  for (;;) {
+    if (in == in_end)
+      corrupt_chunk();
+    const unsigned char token = *in++;
+    const std::size_t num_literals = lz_get_length(in,in_end,token >> 4);
+    if (std::size_t(in_end - in) < num_literals ||
+        std::size_t(out_end - out) < num_literals)
+      corrupt_chunk();
+    std::memcpy(out,in,num_literals);
+    in += num_literals;
+    out += num_literals;
+    if (in == in_end)
+      break;
+
+    if (in_end - in < 2)
+      corrupt_chunk();
+    const std::size_t offset = std::size_t(in[0]) | std::size_t(in[1]) << 8;
+    in += 2;
+    const std::size_t match = lz_get_length(in,in_end,token & 15) + 4;
+    if (offset == 0 || std::size_t(out - out_begin) < offset ||
+        std::size_t(out_end - out) < match)
+      corrupt_chunk();
+    // byte by byte: the source may overlap the destination
+    const unsigned char* from = out - offset;
+    for (std::size_t i = 0; i != match; ++i)
+      *out++ = *from++;
+  }
+  if (out != out_end)
+    corrupt_chunk();
+}
+
+// Encodes count elements as a chunk: a method byte and the payload.
+template <typename T>
+void encode_chunk(const T* elements, std::size_t count,
+                  std::vector<unsigned char>& raw,
+                  std::vector<unsigned char>& out) {
+  const std::size_t bytes = count * sizeof(T);
+  raw.resize(bytes);
+  if (bytes != 0)
+    shuffle_bytes(reinterpret_cast<const unsigned char*>(elements),
+                  sizeof(T),count,&raw[0]);
+  out.clear();
+  out.push_back(chunk_compressed);
+  lz_compress(raw.empty() ? 0 : &raw[0],bytes,out);
+  if (out.size() > bytes + 1) {
+    out.resize(1);
+    out[0] = chunk_stored;
+    out.insert(out.end(),reinterpret_cast<const unsigned char*>(elements),
+               reinterpret_cast<const unsigned char*>(elements) + bytes);
+  }
+}
+
+template <typename T>
+void decode_chunk(const std::vector<unsigned char>& in, bool swap,
+                  std::vector<unsigned char>& raw, T* elements,
+                  std::size_t count) {
+  const std::size_t bytes = count * sizeof(T);
+  if (in.empty())
+    corrupt_chunk();
+  if (in[0] == chunk_stored) {
+    if (in.size() != bytes + 1)
+      corrupt_chunk();
+    std::memcpy(elements,&in[1],bytes);
+  } else if (in[0] == chunk_compressed) {
+    raw.resize(bytes);
+    lz_decompress(&in[1],in.size() - 1,raw.empty() ? 0 : &raw[0],bytes);
+    if (bytes != 0)
+      unshuffle_bytes(&raw[0],sizeof(T),count,
+                      reinterpret_cast<unsigned char*>(elements));
+  } else {
+    corrupt_chunk();
+  }
+  if (swap)
+    swap_bytes(elements,sizeof(T),count);
+}
+
+template <typename T>
+class gather_run {
+public:
+  explicit gather_run(T* out) : out_(out) { }
+
+  void operator()(const T* ptr, size_type count, index stride) {
+    if (stride == 1) {
+      out_ = std::copy(ptr,ptr + count,out_);
+    } else {
+      for (; count != 0; --count, ptr += stride)
+        *out_++ = *ptr;
+    }
+  }
+private:
+  T* out_;
+};
+
+// Compresses the chunks of an array and writes them out, from one or
+// more threads.
+template <typename T, std::size_t NumDims>
+class chunk_writer {
+public:
+  chunk_writer(std::ostream& os, const chunk_grid<NumDims>& grid,
+               const T* first, const index* strides,
+               boost::uint64_t position) :
+    os_(os), grid_(grid), first_(first), strides_(strides),
+    index_(grid.num_chunks), position_(position), next_(0)
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    , failed_(false)
+#endif
+  { }
+
+  void run(unsigned threads) {
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    threads = unsigned((std::min)(size_type(threads),grid_.num_chunks));
+    if (threads > 1) {
+      std::vector<std::thread> pool;
+      for (unsigned t = 1; t != threads; ++t)
+        pool.push_back(std::thread(&chunk_writer::work_guarded,this));
+      work_guarded();
+      for (std::size_t t = 0; t != pool.size(); ++t)
+        pool[t].join();
+      if (error_)
+        std::rethrow_exception(error_);
+      return;
+    }
+#else
+    (void)threads;
+#endif
+    work();
+  }
+
+  // offset and stored size of every chunk
+  const std::vector<std::pair<boost::uint64_t,boost::uint64_t> >&
+  chunk_index() const { return index_; }
+
+private:
+  bool next_chunk(size_type& id) {
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    if (failed_)
+      return false;
+#endif
+    id = next_++;
+    return id < grid_.num_chunks;
+  }
+
+  void work() {
+    std::vector<T> elements;
+    std::vector<unsigned char> raw, encoded;
+    boost::array<index,NumDims> start;
+    boost::array<size_type,NumDims> extents;
+    size_type id;
+    while (next_chunk(id)) {
+      grid_.chunk(id,start.data(),extents.data());
+      size_type count = 1;
+      const T* ptr = first_;
+      for (std::size_t n = 0; n != NumDims; ++n) {
+        count *= extents[n];
+        ptr += start[n] * strides_[n];
+      }
+      elements.resize(count);
+      collapsed_dimensions<NumDims> dims;
+      collapse_in_order<NumDims>(extents.data(),strides_,dims);
+      gather_run<T> gather(elements.empty() ? 0 : &elements[0]);
+      for_each_run(ptr,dims,gather);
+      encode_chunk(elements.empty() ? 0 : &elements[0],count,raw,encoded);
+
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+      std::lock_guard<std::mutex> lock(mutex_);
+#endif
+      write_bytes(os_,&encoded[0],encoded.size());
+      index_[id] = std::make_pair(position_,boost::uint64_t(encoded.size()));
+      position_ += encoded.size();
+    }
+  }
+
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+  void work_guarded() {
+    BOOST_TRY {
+      work();
+    }
+    BOOST_CATCH(...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_)
+        error_ = std::current_exception();
+      failed_ = true;
+    }
+    BOOST_CATCH_END
+  }
+#endif
+
+  std::ostream& os_;
+  const chunk_grid<NumDims>& grid_;
+  const T* first_;
+  const index* strides_;
+  std::vector<std::pair<boost::uint64_t,boost::uint64_t> > index_;
+  boost::uint64_t position_;
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+  std::atomic<size_type> next_;
+  std::atomic<bool> failed_;
+  std::mutex mutex_;
+  std::exception_ptr error_;
+#else
+  size_type next_;
+#endif
+};
+
+template <typename T, std::size_t NumDims>
+void save_chunked_elements(std::ostream& os, const T* origin,
+                           const size_type* extents, const index* strides,
+                           const index* index_bases,
+                           const size_type* chunk_extents,
+                           unsigned threads) {
+  BOOST_STATIC_ASSERT(is_bitwise_copyable<T>::value);
+  chunk_grid<NumDims> grid;
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    BOOST_ASSERT(chunk_extents[n] != 0);
+    grid.extents[n] = extents[n];
+    grid.chunk_extents[n] = chunk_extents[n];
+  }
+  grid.init();
+
+  const std::streampos start = os.tellp();
+  if (start == std::streampos(-1))
+    io_failure("boost::multi_array: chunked output needs a seekable stream");
+  write_bytes(os,chunked_magic,sizeof(chunked_magic));
+  const unsigned char prefix[4] = {
+    1, static_cast<unsigned char>(host_is_little_endian() ? 1 : 2),
+    static_cast<unsigned char>(element_kind<T>::value),
+    static_cast<unsigned char>(sizeof(T))
+  };
+  write_bytes(os,prefix,sizeof(prefix));
+  write_field(os,boost::uint32_t(NumDims));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint64_t(extents[n]));
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint64_t(chunk_extents[n]));
+  write_field(os,boost::uint8_t(1));
+
+  // the index is written once the chunk offsets are known
+  const std::streampos index_start = os.tellp();
+  const std::vector<char> placeholder(std::size_t(grid.num_chunks) * 16,0);
+  if (!placeholder.empty())
+    write_bytes(os,&placeholder[0],placeholder.size());
+
+  chunk_writer<T,NumDims> writer(os,grid,
+    first_element(origin,NumDims,strides,index_bases),strides,
+    boost::uint64_t(os.tellp() - start));
+  writer.run(threads);
+
+  const std::streampos end = os.tellp();
+  if (!os.seekp(index_start))
+    io_failure("boost::multi_array: chunked output needs a seekable stream");
+  for (size_type id = 0; id != grid.num_chunks; ++id) {
+    write_field(os,writer.chunk_index()[id].first);
+    write_field(os,writer.chunk_index()[id].second);
+  }
+  os.seekp(end);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Array, typename ExtentList>
+void save_chunked(std::ostream& os, const Array& a,
+                  const ExtentList& chunk_extents, unsigned threads = 1) {
+  typedef typename Array::element element;
+  const std::size_t NumDims = Array::dimensionality;
+  boost::function_requires<
+    detail::multi_array::CollectionConcept<ExtentList> >();
+  BOOST_ASSERT(chunk_extents.size() == NumDims);
+  boost::array<multi_array_types::size_type,NumDims> chunks;
+  std::copy(chunk_extents.begin(),chunk_extents.end(),chunks.begin());
+  detail::multi_array::save_chunked_elements<element,NumDims>(
+    os,a.origin(),a.shape(),a.strides(),a.index_bases(),chunks.data(),
+    threads);
+}
+
+template <typename T, std::size_t NumDims>
+class chunked_reader {
+public:
+  typedef multi_array_types::index index;
+  typedef multi_array_types::size_type size_type;
+
+  explicit chunked_reader(std::istream& is) : is_(is), start_(is.tellg()) {
+    using detail::multi_array::io_failure;
+    using detail::multi_array::read_bytes;
+    using detail::multi_array::read_field;
+    if (start_ == std::streampos(-1))
+      io_failure("boost::multi_array: chunked input needs a seekable stream");
+    char magic[sizeof(detail::multi_array::chunked_magic)];
+    read_bytes(is,magic,sizeof(magic));
+    if (std::memcmp(magic,detail::multi_array::chunked_magic,
+                    sizeof(magic)) != 0)
+      io_failure("boost::multi_array: not a chunked array");
+    unsigned char prefix[4];
+    read_bytes(is,prefix,sizeof(prefix));
+    if (prefix[0] != 1)
+      io_failure("boost::multi_array: unsupported format version");
+    if (prefix[1] != 1 && prefix[1] != 2)
+      io_failure("boost::multi_array: bad byte order mark");
+    swap_ = (prefix[1] == 1) != detail::multi_array::host_is_little_endian();
+    if (prefix[2] != static_cast<unsigned char>(
+          detail::multi_array::element_kind<T>::value) ||
+        prefix[3] != sizeof(T) ||
+        (swap_ && detail::multi_array::element_kind<T>::value == 'r'))
+      io_failure("boost::multi_array: element type mismatch");
+    if (read_field<boost::uint32_t>(is,swap_) != NumDims)
+      io_failure("boost::multi_array: dimensionality mismatch");
+    // The shape and the chunk shape are checked as in binary_io.hpp
+    // before they size anything.
+    boost::array<boost::uint64_t,NumDims> extents;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      extents[n] = read_field<boost::uint64_t>(is,swap_);
+    detail::multi_array::checked_element_count<T>(NumDims,extents.data());
+    for (std::size_t n = 0; n != NumDims; ++n)
+      grid_.extents[n] = size_type(extents[n]);
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      extents[n] = read_field<boost::uint64_t>(is,swap_);
+      if (extents[n] == 0)
+        io_failure("boost::multi_array: bad chunk extents");
+    }
+    detail::multi_array::checked_element_count<T>(NumDims,extents.data());
+    for (std::size_t n = 0; n != NumDims; ++n)
+      grid_.chunk_extents[n] = size_type(extents[n]);
+    if (read_field<boost::uint8_t>(is,swap_) != 1)
+      io_failure("boost::multi_array: unsupported codec");
+    grid_.init();
+
+    // Every index entry, and every chunk it points to, must lie within
+    // the stream.
+    const std::streampos index_start = is.tellg();
+    if (!is.seekg(0,std::ios_base::end))
+      io_failure("boost::multi_array: chunked input needs a seekable stream");
+    const boost::uint64_t length = boost::uint64_t(is.tellg() - start_);
+    const boost::uint64_t index_length =
+      boost::uint64_t(is.tellg() - index_start);
+    is.seekg(index_start);
+    if (grid_.num_chunks > index_length / 16)
+      io_failure("boost::multi_array: unexpected end of stream");
+    index_.resize(grid_.num_chunks);
+    for (size_type id = 0; id != grid_.num_chunks; ++id) {
+      index_[id].first = read_field<boost::uint64_t>(is,swap_);
+      index_[id].second = read_field<boost::uint64_t>(is,swap_);
+      if (index_[id].first > length ||
+          index_[id].second > length - index_[id].first)
+        io_failure("boost::multi_array: bad chunk index");
+    }
+  }
+
+  const size_type* shape() const { return grid_.extents.data(); }
+  const size_type* chunk_shape() const { return grid_.chunk_extents.data(); }
+  size_type num_chunks() const { return grid_.num_chunks; }
+
+  // The whole array.
+  template <typename Allocator>
+  void read(boost::multi_array<T,NumDims,Allocator>& a) {
+    detail::multi_array::index_gen<NumDims,NumDims> all;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      all.ranges_[n] = multi_array_types::index_range();
+    read(all,a);
+  }
+
+  template <int NDims, std::size_t ADims, typename Allocator>
+  void read(const detail::multi_array::index_gen<NumDims,NDims>& region,
+            boost::multi_array<T,ADims,Allocator>& a) {
+    BOOST_STATIC_ASSERT(std::size_t(NDims) == ADims);
+    selection sel;
+    select(region,sel);
+    typedef detail::multi_array::extent_gen<NDims> gen_type;
+    typedef typename gen_type::range range_type;
+    gen_type ranges;
+    for (std::size_t n = 0, dim = 0; n != NumDims; ++n)
+      if (!region.ranges_[n].is_degenerate()) {
+        ranges.ranges_[dim] = range_type(0,index(sel[n].size()));
+        ++dim;
+      }
+    // Decoded into a new array that replaces a only once every chunk
+    // has been read, so that a damaged stream leaves a as it was.
+    boost::multi_array<T,ADims,Allocator> loaded(ranges,a.storage_order(),
+                                                 a.get_allocator());
+    copy_out<NDims>(region,sel,loaded.origin(),loaded.strides(),
+                    loaded.index_bases());
+    a.swap(loaded);
+  }
+
+  template <int NDims, std::size_t ADims>
+  void read(const detail::multi_array::index_gen<NumDims,NDims>& region,
+            multi_array_ref<T,ADims> a) {
+    BOOST_STATIC_ASSERT(std::size_t(NDims) == ADims);
+    read_into(region,a.origin(),a.shape(),a.strides(),a.index_bases());
+  }
+
+  template <int NDims, std::size_t ADims>
+  void read(const detail::multi_array::index_gen<NumDims,NDims>& region,
+            detail::multi_array::sub_array<T,ADims> a) {
+    BOOST_STATIC_ASSERT(std::size_t(NDims) == ADims);
+    read_into(region,a.origin(),a.shape(),a.strides(),a.index_bases());
+  }
+
+  template <int NDims, std::size_t ADims>
+  void read(const detail::multi_array::index_gen<NumDims,NDims>& region,
+            detail::multi_array::multi_array_view<T,ADims> a) {
+    BOOST_STATIC_ASSERT(std::size_t(NDims) == ADims);
+    read_into(region,a.origin(),a.shape(),a.strides(),a.index_bases());
+  }
+
+private:
+  // For every dimension of the saved array, the chunks the region
+  // touches along it and, for each such chunk, the selected positions
+  // within the chunk paired with their offsets in the destination
+  // (before scaling by the destination stride).
+  struct chunk_slice {
+    size_type chunk;
+    std::vector<std::pair<index,index> > positions;
+  };
+  typedef boost::array<std::vector<index>,NumDims> selection;
+
+  template <int NDims>
+  void select(const detail::multi_array::index_gen<NumDims,NDims>& region,
+              selection& sel) const {
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      const multi_array_types::index_range& r = region.ranges_[n];
+      const index finish_default = index(grid_.extents[n]);
+      const index start = r.get_start(0);
+      const index finish = r.get_finish(finish_default);
+      const index stride = r.stride();
+      BOOST_ASSERT(stride != 0);
+      if (r.is_degenerate()) {
+        if (start < 0 || start >= finish_default)
+          detail::multi_array::io_failure(
+            "boost::multi_array: region outside the chunked array");
+        sel[n].assign(1,start);
+        continue;
+      }
+      // as in generate_array_view
+      index len = 0;
+      if ((finish - start) / stride >= 0) {
+        const index shrinkage = stride > 0 ? 1 : -1;
+        len = (finish - start + (stride - shrinkage)) / stride;
+      }
+      sel[n].resize(std::size_t(len));
+      for (index i = 0; i != len; ++i) {
+        const index at = start + i * stride;
+        if (at < 0 || at >= finish_default)
+          detail::multi_array::io_failure(
+            "boost::multi_array: region outside the chunked array");
+        sel[n][std::size_t(i)] = at;
+      }
+    }
+  }
+
+  template <int NDims>
+  void read_into(const detail::multi_array::index_gen<NumDims,NDims>& region,
+                 T* origin, const size_type* extents, const index* strides,
+                 const index* index_bases) {
+    selection sel;
+    select(region,sel);
+    for (std::size_t n = 0, dim = 0; n != NumDims; ++n)
+      if (!region.ranges_[n].is_degenerate()) {
+        if (sel[n].size() != extents[dim])
+          detail::multi_array::io_failure(
+            "boost::multi_array: shape mismatch");
+        ++dim;
+      }
+    copy_out<NDims>(region,sel,origin,strides,index_bases);
+  }
+
+  template <int NDims>
+  void copy_out(const detail::multi_array::index_gen<NumDims,NDims>& region,
+                const selection& sel, T* origin, const index* strides,
+                const index* index_bases) {
+    // group the selected positions of each dimension by chunk
+    boost::array<std::vector<chunk_slice>,NumDims> slices;
+    for (std::size_t n = 0, dim = 0; n != NumDims; ++n) {
+      const bool degenerate = region.ranges_[n].is_degenerate();
+      const index stride = degenerate ? 0 : strides[dim];
+      std::vector<chunk_slice>& s = slices[n];
+      for (std::size_t i = 0; i != sel[n].size(); ++i) {
+        const size_type chunk = size_type(sel[n][i]) / grid_.chunk_extents[n];
+        // selections are monotonic, so the chunk is usually the last one
+        std::size_t k = s.empty() || s.back().chunk != chunk ? 0 :
+          s.size() - 1;
+        while (k != s.size() && s[k].chunk != chunk)
+          ++k;
+        if (k == s.size()) {
+          s.push_back(chunk_slice());
+          s.back().chunk = chunk;
+        }
+        s[k].positions.push_back(std::make_pair(
+          sel[n][i] - index(chunk * grid_.chunk_extents[n]),
+          index(i) * stride));
+      }
+      if (s.empty())
+        return;
+      if (!degenerate)
+        ++dim;
+    }
+
+    T* const first = detail::multi_array::first_element(origin,NDims,
+                                                        strides,index_bases);
+    std::vector<T> elements;
+    std::vector<unsigned char> stored, raw;
+    boost::array<std::size_t,NumDims> which;
+    which.assign(0);
+    for (;;) {
+      size_type id = 0;
+      for (std::size_t n = 0; n != NumDims; ++n)
+        id = id * grid_.counts[n] + slices[n][which[n]].chunk;
+      boost::array<index,NumDims> start;
+      boost::array<size_type,NumDims> extents;
+      grid_.chunk(id,start.data(),extents.data());
+      load_chunk(id,extents,stored,raw,elements);
+
+      // row-major strides within the chunk
+      boost::array<index,NumDims> chunk_strides;
+      index stride = 1;
+      for (std::size_t n = NumDims; n != 0; --n) {
+        chunk_strides[n-1] = stride;
+        stride *= index(extents[n-1]);
+      }
+      copy_chunk(slices,which,chunk_strides,&elements[0],first);
+
+      std::size_t n = NumDims;
+      for (; n != 0; --n) {
+        if (++which[n-1] != slices[n-1].size())
+          break;
+        which[n-1] = 0;
+      }
+      if (n == 0)
+        return;
+    }
+  }
+
+  void copy_chunk(const boost::array<std::vector<chunk_slice>,NumDims>& slices,
+                  const boost::array<std::size_t,NumDims>& which,
+                  const boost::array<index,NumDims>& chunk_strides,
+                  const T* elements, T* first) const {
+    boost::array<std::size_t,NumDims> at;
+    at.assign(0);
+    const std::vector<std::pair<index,index> >& inner =
+      slices[NumDims-1][which[NumDims-1]].positions;
+    for (;;) {
+      index from = 0, to = 0;
+      for (std::size_t n = 0; n != NumDims - 1; ++n) {
+        const std::pair<index,index>& p =
+          slices[n][which[n]].positions[at[n]];
+        from += p.first * chunk_strides[n];
+        to += p.second;
+      }
+      for (std::size_t i = 0; i != inner.size(); ++i)
+        first[to + inner[i].second] = elements[from + inner[i].first];
+
+      std::size_t n = NumDims - 1;
+      for (; n != 0; --n) {
+        if (++at[n-1] != slices[n-1][which[n-1]].positions.size())
+          break;
+        at[n-1] = 0;
+      }
+      if (n == 0)
+        return;
+    }
+  }
+
+  void load_chunk(size_type id, const boost::array<size_type,NumDims>& extents,
+                  std::vector<unsigned char>& stored,
+                  std::vector<unsigned char>& raw,
+                  std::vector<T>& elements) {
+    size_type count = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      count *= extents[n];
+    // no chunk is larger than its elements and the method byte
+    if (index_[id].second > boost::uint64_t(count) * sizeof(T) + 1)
+      detail::multi_array::corrupt_chunk();
+    stored.resize(std::size_t(index_[id].second));
+    is_.clear();
+    if (!is_.seekg(start_ + std::streamoff(index_[id].first)))
+      detail::multi_array::io_failure(
+        "boost::multi_array: cannot seek to chunk");
+    if (!stored.empty())
+      detail::multi_array::read_bytes(is_,&stored[0],stored.size());
+    elements.resize(count);
+    detail::multi_array::decode_chunk(stored,swap_,raw,&elements[0],count);
+  }
+
+  std::istream& is_;
+  std::streampos start_;
+  bool swap_;
+  detail::multi_array::chunk_grid<NumDims> grid_;
+  std::vector<std::pair<boost::uint64_t,boost::uint64_t> > index_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
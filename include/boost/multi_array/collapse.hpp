@@ -0,0 +1,324 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_COLLAPSE_HPP
+#define BOOST_MULTI_ARRAY_COLLAPSE_HPP
+
+//
+// collapse.hpp - merges the dimensions of a strided array into as few
+// (extent,stride) pairs as possible so that element loops over views
+// run over long runs instead of one dimension at a time.
+//
+
+#include "boost/multi_array/storage_order.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include <cstddef>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// collapsed_dimensions
+//   The result of collapsing a strided layout.  Dimensions are stored
+//   innermost first.  num_dims is zero for an empty array.  offset is
+//   the distance (in elements) from the first element of the array to
+//   the element the collapsed loop starts from; it is only non-zero
+//   when negative strides were flipped.
+//
+template <std::size_t NumDims>
+struct collapsed_dimensions {
+  size_type num_dims;
+  index offset;
+  boost::array<size_type,NumDims> extents;
+  boost::array<index,NumDims> strides;
+};
+
+// The address of the element at the index bases of an array whose
+// index-0 point is origin.
+template <typename TPtr>
+TPtr first_element(TPtr origin, std::size_t num_dims,
+                   const index* strides, const index* index_bases) {
+  index offset = 0;
+  for (std::size_t n = 0; n != num_dims; ++n)
+    offset += index_bases[n] * strides[n];
+  return origin + offset;
+}
+
+// Collapses dimensions while preserving the logical (row-major) visiting
+// order: dimension n is folded into dimension n+1 when walking n one
+// step is the same as walking n+1 off its end.
+template <std::size_t NumDims>
+void collapse_in_order(const size_type* extents, const index* strides,
+                       collapsed_dimensions<NumDims>& result) {
+  result.num_dims = 0;
+  result.offset = 0;
+  for (std::size_t n = NumDims; n != 0; --n) {
+    const std::size_t dim = n - 1;
+    if (extents[dim] == 0) {
+      result.num_dims = 0;
+      return;
+    }
+    if (extents[dim] == 1)
+      continue;
+    if (result.num_dims != 0) {
+      const size_type last = result.num_dims - 1;
+      if (strides[dim] ==
+          result.strides[last] * index(result.extents[last])) {
+        result.extents[last] *= extents[dim];
+        continue;
+      }
+    }
+    result.extents[result.num_dims] = extents[dim];
+    result.strides[result.num_dims] = strides[dim];
+    ++result.num_dims;
+  }
+  if (result.num_dims == 0) {
+    // every extent is one: a single element
+    result.extents[0] = 1;
+    result.strides[0] = 1;
+    result.num_dims = 1;
+  }
+}
+
+// Collapses dimensions without regard to visiting order, as is
+// appropriate when every element is treated alike (fill, comparison
+// against a scalar, ...).  Negative strides are flipped and the
+// dimensions are sorted by increasing stride before merging, so any
+// dense layout, whatever its storage order, becomes a single run.
+template <std::size_t NumDims>
+void collapse_any_order(const size_type* extents, const index* strides,
+                        collapsed_dimensions<NumDims>& result) {
+  result.num_dims = 0;
+  result.offset = 0;
+  for (std::size_t dim = 0; dim != NumDims; ++dim) {
+    if (extents[dim] == 0) {
+      result.num_dims = 0;
+      result.offset = 0;
+      return;
+    }
+    if (extents[dim] == 1)
+      continue;
+    index stride = strides[dim];
+    if (stride < 0) {
+      result.offset += index(extents[dim] - 1) * stride;
+      stride = -stride;
+    }
+    // insertion sort by stride
+    size_type pos = result.num_dims;
+    while (pos != 0 && result.strides[pos-1] > stride) {
+      result.strides[pos] = result.strides[pos-1];
+      result.extents[pos] = result.extents[pos-1];
+      --pos;
+    }
+    result.strides[pos] = stride;
+    result.extents[pos] = extents[dim];
+    ++result.num_dims;
+  }
+  if (result.num_dims == 0) {
+    result.extents[0] = 1;
+    result.strides[0] = 1;
+    result.num_dims = 1;
+    return;
+  }
+  size_type merged = 0;
+  for (size_type n = 1; n != result.num_dims; ++n) {
+    if (result.strides[n] ==
+        result.strides[merged] * index(result.extents[merged])) {
+      result.extents[merged] *= result.extents[n];
+    } else {
+      ++merged;
+      result.extents[merged] = result.extents[n];
+      result.strides[merged] = result.strides[n];
+    }
+  }
+  result.num_dims = merged + 1;
+}
+
+// Collapses dimensions for a walk in the memory order that the storage
+// order so describes: so.ordering(0) varies fastest, and descending
+// dimensions are walked from their last index down.
+template <std::size_t NumDims>
+void collapse_in_storage_order(const size_type* extents,
+                               const index* strides,
+                               const general_storage_order<NumDims>& so,
+                               collapsed_dimensions<NumDims>& result) {
+  boost::array<size_type,NumDims> ordered_extents;
+  boost::array<index,NumDims> ordered_strides;
+  index offset = 0;
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    const std::size_t dim = so.ordering(n);
+    ordered_extents[NumDims-1-n] = extents[dim];
+    if (so.ascending(dim)) {
+      ordered_strides[NumDims-1-n] = strides[dim];
+    } else {
+      ordered_strides[NumDims-1-n] = -strides[dim];
+      if (extents[dim] != 0)
+        offset += index(extents[dim] - 1) * strides[dim];
+    }
+  }
+  collapse_in_order<NumDims>(ordered_extents.data(),ordered_strides.data(),
+                             result);
+  result.offset = offset;
+}
+
+// The storage order in which memory is laid out, as far as the strides
+// tell: dimensions sorted by increasing stride magnitude, ties broken in
+// favour of C order.  A dense array or view walked in this order
+// (collapse_in_storage_order) is a single contiguous run.
+template <std::size_t NumDims>
+general_storage_order<NumDims> storage_order_from_strides(const index* strides) {
+  boost::array<size_type,NumDims> ordering;
+  boost::array<bool,NumDims> ascending;
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    const std::size_t dim = NumDims - 1 - n;
+    const index magnitude = strides[dim] < 0 ? -strides[dim] : strides[dim];
+    std::size_t pos = n;
+    while (pos != 0) {
+      const index other = strides[ordering[pos-1]] < 0 ?
+        -strides[ordering[pos-1]] : strides[ordering[pos-1]];
+      if (other <= magnitude)
+        break;
+      ordering[pos] = ordering[pos-1];
+      --pos;
+    }
+    ordering[pos] = dim;
+    ascending[dim] = strides[dim] >= 0;
+  }
+  return general_storage_order<NumDims>(ordering.begin(),ascending.begin());
+}
+
+//
+// Layout queries, for the is_contiguous() family of members of the
+// arrays, sub-arrays and views.  Dimensions of extent one may have any
+// stride, and an array with no elements counts as contiguous in every
+// order.
+//
+
+inline bool has_no_elements(std::size_t num_dims, const size_type* extents) {
+  for (std::size_t n = 0; n != num_dims; ++n)
+    if (extents[n] == 0)
+      return true;
+  return false;
+}
+
+// Dense in C (row-major) order: each stride is the product of the
+// extents after it.
+inline bool is_c_contiguous(std::size_t num_dims, const size_type* extents,
+                            const index* strides) {
+  if (has_no_elements(num_dims,extents))
+    return true;
+  index expected = 1;
+  for (std::size_t n = num_dims; n != 0; --n) {
+    if (extents[n - 1] != 1 && strides[n - 1] != expected)
+      return false;
+    expected *= index(extents[n - 1]);
+  }
+  return true;
+}
+
+// Dense in Fortran (column-major) order: each stride is the product of
+// the extents before it.
+inline bool is_f_contiguous(std::size_t num_dims, const size_type* extents,
+                            const index* strides) {
+  if (has_no_elements(num_dims,extents))
+    return true;
+  index expected = 1;
+  for (std::size_t n = 0; n != num_dims; ++n) {
+    if (extents[n] != 1 && strides[n] != expected)
+      return false;
+    expected *= index(extents[n]);
+  }
+  return true;
+}
+
+// Dense in some order, with strides of either sign: the elements fill
+// memory_span() elements without gaps.
+template <std::size_t NumDims>
+bool is_contiguous(const size_type* extents, const index* strides) {
+  collapsed_dimensions<NumDims> dims;
+  collapse_any_order<NumDims>(extents,strides,dims);
+  return dims.num_dims == 0 || (dims.num_dims == 1 && dims.strides[0] == 1);
+}
+
+// The length of the runs of adjacent, ascending elements that a walk in
+// index order (last index fastest) makes: the product of the trailing
+// extents that merge into one run, 1 when the last stride is not 1, and
+// 0 for an array with no elements.
+template <std::size_t NumDims>
+size_type contiguous_inner_extent(const size_type* extents,
+                                  const index* strides) {
+  collapsed_dimensions<NumDims> dims;
+  collapse_in_order<NumDims>(extents,strides,dims);
+  if (dims.num_dims == 0)
+    return 0;
+  return dims.strides[0] == 1 ? dims.extents[0] : 1;
+}
+
+// The number of elements from the lowest addressed element to the
+// highest, both included.
+inline size_type memory_span(std::size_t num_dims, const size_type* extents,
+                             const index* strides) {
+  if (has_no_elements(num_dims,extents))
+    return 0;
+  size_type span = 1;
+  for (std::size_t n = 0; n != num_dims; ++n)
+    span += (extents[n] - 1) *
+      size_type(strides[n] < 0 ? -strides[n] : strides[n]);
+  return span;
+}
+
+// True if two arrays of the same shape lay out their elements densely
+// in the same order, so that one can be copied onto the other as a
+// single run.
+template <typename Source, typename Destination>
+bool same_dense_layout(const Source& source, const Destination& destination) {
+  const std::size_t num_dims = destination.num_dimensions();
+  const size_type* extents = destination.shape();
+  if (is_c_contiguous(num_dims,extents,source.strides()))
+    return is_c_contiguous(num_dims,extents,destination.strides());
+  return is_f_contiguous(num_dims,extents,source.strides()) &&
+    is_f_contiguous(num_dims,extents,destination.strides());
+}
+
+//
+// for_each_run
+//   Calls f(ptr,count,stride) once for every run of the innermost
+//   collapsed dimension, walking the outer dimensions odometer style.
+//
+template <std::size_t NumDims, typename TPtr, typename Function>
+void for_each_run(TPtr first, const collapsed_dimensions<NumDims>& dims,
+                  Function& f) {
+  if (dims.num_dims == 0)
+    return;
+  boost::array<size_type,NumDims> counter;
+  counter.assign(0);
+  TPtr ptr = first + dims.offset;
+  for (;;) {
+    f(ptr,dims.extents[0],dims.strides[0]);
+    size_type n = 1;
+    for (; n != dims.num_dims; ++n) {
+      ptr += dims.strides[n];
+      if (++counter[n] != dims.extents[n])
+        break;
+      ptr -= dims.strides[n] * index(dims.extents[n]);
+      counter[n] = 0;
+    }
+    if (n == dims.num_dims)
+      return;
+  }
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+} // namespace boost
+
+#endif
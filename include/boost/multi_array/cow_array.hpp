@@ -0,0 +1,203 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_COW_ARRAY_HPP
+#define BOOST_MULTI_ARRAY_COW_ARRAY_HPP
+
+//
+// cow_array.hpp - an array with value semantics whose copies share their
+// elements until one of them is modified.
+//
+//   cow_multi_array<T,NumDims> a(x[,storage_order])
+//     Constructs the array as multi_array<T,NumDims> would from x: an
+//     extent list, extents[...] ranges, or an array to copy.
+//   cow_multi_array<T,NumDims> b = a;
+//     Shares a's elements; copying and assigning never copy elements.
+//
+//   a.array()     the elements, as a const multi_array
+//   a.view()      a const_multi_array_ref over them, for readers; like a
+//                 reference into the array, it stays valid until a is
+//                 modified or destroyed
+//   a[i], a(idx), a.shape(), a.index_bases(), a.num_elements() ...
+//                 read only access, as for a const multi_array
+//   a.modify()    the elements as a multi_array that may be changed,
+//                 first copying them if they are shared (detaching).
+//                 The reference may be kept and used until a is next
+//                 copied, assigned or destroyed.
+//   a.unique(), a.use_count()
+//
+// The reference count is atomic where BOOST_MULTI_ARRAY_HAS_THREADS is
+// defined (see threads.hpp), so copies may be used, and modified, on
+// different threads; a single cow_multi_array object is no more thread
+// safe than a multi_array.
+//
+// Detaching copies the whole array: a multi_array_ref, and the views and
+// subarrays readers take of it, need every element at a fixed stride
+// from the origin, so the elements cannot be split into separately
+// shared tiles.  Keep arrays that are modified a little at a time in a
+// paged_array (see paged_array.hpp) instead.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/threads.hpp"
+#include "boost/array.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Array>
+struct cow_buffer {
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+  typedef std::atomic<std::size_t> count_type;
+
+  std::size_t count() const {
+    return count_.load(std::memory_order_acquire);
+  }
+  void acquire() { count_.fetch_add(1,std::memory_order_relaxed); }
+  bool release() {
+    return count_.fetch_sub(1,std::memory_order_acq_rel) == 1;
+  }
+#else
+  typedef std::size_t count_type;
+
+  std::size_t count() const { return count_; }
+  void acquire() { ++count_; }
+  bool release() { return --count_ == 0; }
+#endif
+
+  cow_buffer() : count_(1) { }
+
+  template <typename Source>
+  explicit cow_buffer(const Source& source) : array(source), count_(1) { }
+
+  template <typename Source, typename StorageOrder>
+  cow_buffer(const Source& source, const StorageOrder& so) :
+    array(source,so), count_(1) { }
+
+  Array array;
+
+private:
+  // noncopyable
+  cow_buffer(const cow_buffer&);
+  cow_buffer& operator=(const cow_buffer&);
+
+  count_type count_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims,
+          typename Allocator = std::allocator<T> >
+class cow_multi_array {
+public:
+  typedef boost::multi_array<T,NumDims,Allocator> array_type;
+  typedef const_multi_array_ref<T,NumDims> const_array_ref;
+  typedef typename array_type::element element;
+  typedef typename array_type::index index;
+  typedef typename array_type::size_type size_type;
+  typedef typename array_type::const_reference const_reference;
+  typedef typename array_type::storage_order_type storage_order_type;
+  BOOST_STATIC_CONSTANT(std::size_t, dimensionality = NumDims);
+
+  cow_multi_array() : buffer_(new buffer_type()) { }
+
+  template <typename Source>
+  explicit cow_multi_array(const Source& source) :
+    buffer_(new buffer_type(source)) { }
+
+  template <typename Source>
+  cow_multi_array(const Source& source, const storage_order_type& so) :
+    buffer_(new buffer_type(source,so)) { }
+
+  cow_multi_array(const cow_multi_array& other) : buffer_(other.buffer_) {
+    buffer_->acquire();
+  }
+
+  cow_multi_array& operator=(cow_multi_array other) {
+    swap(other);
+    return *this;
+  }
+
+  ~cow_multi_array() {
+    if (buffer_->release())
+      delete buffer_;
+  }
+
+  void swap(cow_multi_array& other) { std::swap(buffer_,other.buffer_); }
+
+  const array_type& array() const { return buffer_->array; }
+
+  const_array_ref view() const {
+    boost::array<size_type,NumDims> extents;
+    boost::array<index,NumDims> bases;
+    std::copy(shape(),shape() + NumDims,extents.begin());
+    std::copy(index_bases(),index_bases() + NumDims,bases.begin());
+    const_array_ref result(array().data(),extents,storage_order());
+    result.reindex(bases);
+    return result;
+  }
+
+  array_type& modify() {
+    if (buffer_->count() != 1) {
+      buffer_type* copy = new buffer_type(buffer_->array);
+      if (buffer_->release())
+        delete buffer_;
+      buffer_ = copy;
+    }
+    return buffer_->array;
+  }
+
+  bool unique() const { return buffer_->count() == 1; }
+  std::size_t use_count() const { return buffer_->count(); }
+
+  // read only access, as for a const multi_array
+
+  std::size_t num_dimensions() const { return NumDims; }
+  const size_type* shape() const { return array().shape(); }
+  const index* strides() const { return array().strides(); }
+  const index* index_bases() const { return array().index_bases(); }
+  const storage_order_type& storage_order() const {
+    return array().storage_order();
+  }
+  size_type num_elements() const { return array().num_elements(); }
+  const element* data() const { return array().data(); }
+  const element* origin() const { return array().origin(); }
+
+  const_reference operator[](index idx) const { return array()[idx]; }
+
+  template <typename IndexList>
+  const element& operator()(const IndexList& indices) const {
+    return array()(indices);
+  }
+
+private:
+  typedef detail::multi_array::cow_buffer<array_type> buffer_type;
+
+  buffer_type* buffer_;
+};
+
+template <typename T, std::size_t NumDims, typename Allocator>
+void swap(cow_multi_array<T,NumDims,Allocator>& a,
+          cow_multi_array<T,NumDims,Allocator>& b) {
+  a.swap(b);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
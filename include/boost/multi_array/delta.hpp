@@ -0,0 +1,407 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_DELTA_HPP
+#define BOOST_MULTI_ARRAY_DELTA_HPP
+
+//
+// delta.hpp - the difference between two arrays of the same shape, as a
+// compact stream of the elements that changed.
+//
+//   save_delta(os,from,to)
+//     Writes the elements of to that differ from the element at the same
+//     position of from, and returns how many there were.  from and to
+//     may be arrays, references, subarrays or views of any storage
+//     order.  Elements are compared bitwise.
+//   apply_delta(is,a)
+//     Writes the elements of such a delta into a, which must have the
+//     same shape and typically holds from: it then holds to.  a may be a
+//     multi_array, multi_array_ref, subarray or view.
+//
+// A delta holds the magic "BMDELTA", the header of binary_io.hpp
+// describing to (in C storage order), then a sequence of runs.  Each
+// run is the number of unchanged elements before it and the number of
+// changed ones in it, both as LEB128 variable length integers, followed
+// by the changed elements; positions count elements in row-major order.
+// A run of no elements ends the delta.  Errors throw
+// std::ios_base::failure.
+//
+// Where both arrays have unit stride along a run, unchanged elements
+// are skipped a block at a time with memcmp.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+static const char delta_magic[8] = { 'B','M','D','E','L','T','A','\0' };
+
+// elements compared per memcmp while skipping unchanged elements
+const std::size_t delta_block_elements = 64;
+
+//
+// collapsed_pair
+//   The dimensions of two arrays of the same shape, collapsed in
+//   row-major order where both layouts allow it (see collapse.hpp), so
+//   that they can be walked side by side.
+//
+template <std::size_t NumDims>
+struct collapsed_pair {
+  size_type num_dims;
+  boost::array<size_type,NumDims> extents;
+  boost::array<index,NumDims> strides[2];
+};
+
+template <std::size_t NumDims>
+void collapse_pair_in_order(const size_type* extents,
+                            const index* strides0, const index* strides1,
+                            collapsed_pair<NumDims>& result) {
+  result.num_dims = 0;
+  for (std::size_t n = NumDims; n != 0; --n) {
+    const std::size_t dim = n - 1;
+    if (extents[dim] == 0) {
+      result.num_dims = 0;
+      return;
+    }
+    if (extents[dim] == 1)
+      continue;
+    if (result.num_dims != 0) {
+      const size_type last = result.num_dims - 1;
+      const index extent = index(result.extents[last]);
+      if (strides0[dim] == result.strides[0][last] * extent &&
+          strides1[dim] == result.strides[1][last] * extent) {
+        result.extents[last] *= extents[dim];
+        continue;
+      }
+    }
+    result.extents[result.num_dims] = extents[dim];
+    result.strides[0][result.num_dims] = strides0[dim];
+    result.strides[1][result.num_dims] = strides1[dim];
+    ++result.num_dims;
+  }
+  if (result.num_dims == 0) {
+    result.extents[0] = 1;
+    result.strides[0][0] = result.strides[1][0] = 1;
+    result.num_dims = 1;
+  }
+}
+
+// Calls f(ptr0,stride0,ptr1,stride1,count) for every run of the
+// innermost collapsed dimension, in row-major order.
+template <std::size_t NumDims, typename TPtr0, typename TPtr1,
+          typename Function>
+void for_each_run_pair(TPtr0 first0, TPtr1 first1,
+                       const collapsed_pair<NumDims>& dims, Function& f) {
+  if (dims.num_dims == 0)
+    return;
+  boost::array<size_type,NumDims> counter;
+  counter.assign(0);
+  TPtr0 ptr0 = first0;
+  TPtr1 ptr1 = first1;
+  for (;;) {
+    f(ptr0,dims.strides[0][0],ptr1,dims.strides[1][0],dims.extents[0]);
+    size_type n = 1;
+    for (; n != dims.num_dims; ++n) {
+      ptr0 += dims.strides[0][n];
+      ptr1 += dims.strides[1][n];
+      if (++counter[n] != dims.extents[n])
+        break;
+      ptr0 -= dims.strides[0][n] * index(dims.extents[n]);
+      ptr1 -= dims.strides[1][n] * index(dims.extents[n]);
+      counter[n] = 0;
+    }
+    if (n == dims.num_dims)
+      return;
+  }
+}
+
+// Finds the runs of changed elements and writes them.
+template <typename T>
+class delta_writer {
+public:
+  explicit delta_writer(std::ostream& os) :
+    os_(os), unchanged_(0), run_unchanged_(0), changed_(0) { }
+
+  void operator()(const T* from, index from_stride,
+                  const T* to, index to_stride, size_type count) {
+    size_type i = 0;
+    while (i != count) {
+      // the unchanged elements
+      const size_type begin = i;
+      if (from_stride == 1 && to_stride == 1) {
+        while (count - i >= delta_block_elements &&
+               std::memcmp(from + i,to + i,
+                           delta_block_elements * sizeof(T)) == 0)
+          i += delta_block_elements;
+      }
+      while (i != count && same(from + index(i) * from_stride,
+                                to + index(i) * to_stride))
+        ++i;
+      unchanged_ += i - begin;
+      if (i == count)
+        break;
+
+      // the changed ones
+      const size_type first = i;
+      while (i != count && !same(from + index(i) * from_stride,
+                                 to + index(i) * to_stride))
+        ++i;
+      write_run(to + index(first) * to_stride,to_stride,i - first);
+    }
+  }
+
+  size_type finish() {
+    end_run();
+    put_number(0);
+    put_number(0);
+    flush();
+    return changed_;
+  }
+
+private:
+  static bool same(const T* a, const T* b) {
+    return std::memcmp(a,b,sizeof(T)) == 0;
+  }
+
+  // Runs continuing the previous one, as where a run crosses the end of
+  // a row, are joined to it, so the delta does not depend on layout.
+  void write_run(const T* elements, index stride, size_type count) {
+    if (unchanged_ != 0 || run_.size() >= buffer_limit())
+      end_run();
+    changed_ += count;
+    for (; count != 0; --count, elements += stride) {
+      const char* bytes = reinterpret_cast<const char*>(elements);
+      run_.insert(run_.end(),bytes,bytes + sizeof(T));
+    }
+  }
+
+  void end_run() {
+    if (!run_.empty()) {
+      put_number(run_unchanged_);
+      put_number(run_.size() / sizeof(T));
+      buffer_.insert(buffer_.end(),run_.begin(),run_.end());
+      run_.clear();
+      if (buffer_.size() >= buffer_limit())
+        flush();
+    }
+    run_unchanged_ = unchanged_;
+    unchanged_ = 0;
+  }
+
+  static std::size_t buffer_limit() {
+    return std::size_t(BOOST_MULTI_ARRAY_IO_BUFFER_BYTES);
+  }
+
+  // LEB128
+  void put_number(boost::uint64_t value) {
+    do {
+      unsigned char byte = static_cast<unsigned char>(value & 0x7f);
+      value >>= 7;
+      if (value != 0)
+        byte |= 0x80;
+      buffer_.push_back(static_cast<char>(byte));
+    } while (value != 0);
+  }
+
+  void flush() {
+    if (!buffer_.empty())
+      write_bytes(os_,&buffer_[0],buffer_.size());
+    buffer_.clear();
+  }
+
+  std::ostream& os_;
+  std::vector<char> buffer_;
+  std::vector<char> run_;
+  size_type unchanged_;
+  size_type run_unchanged_;
+  size_type changed_;
+};
+
+inline boost::uint64_t read_number(std::istream& is) {
+  boost::uint64_t value = 0;
+  for (unsigned shift = 0; ; shift += 7) {
+    unsigned char byte;
+    read_bytes(is,&byte,1);
+    if (shift > 63)
+      io_failure("boost::multi_array: corrupt delta");
+    value |= boost::uint64_t(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+}
+
+template <typename T, std::size_t NumDims>
+size_type save_delta_elements(std::ostream& os,
+                              const T* from_origin,
+                              const size_type* from_extents,
+                              const index* from_strides,
+                              const index* from_index_bases,
+                              const T* to_origin,
+                              const size_type* to_extents,
+                              const index* to_strides,
+                              const index* to_index_bases) {
+  BOOST_STATIC_ASSERT(is_bitwise_copyable<T>::value);
+  BOOST_ASSERT(std::equal(from_extents,from_extents + NumDims,to_extents));
+  (void)from_extents;
+
+  write_bytes(os,delta_magic,sizeof(delta_magic));
+  write_binary_header<T,NumDims>(os,to_extents,to_index_bases,
+                                 general_storage_order<NumDims>(
+                                   c_storage_order()));
+  collapsed_pair<NumDims> dims;
+  collapse_pair_in_order<NumDims>(to_extents,from_strides,to_strides,dims);
+  delta_writer<T> writer(os);
+  for_each_run_pair(first_element(from_origin,NumDims,from_strides,
+                                  from_index_bases),
+                    first_element(to_origin,NumDims,to_strides,
+                                  to_index_bases),
+                    dims,writer);
+  return writer.finish();
+}
+
+template <typename T, std::size_t NumDims>
+void apply_delta_elements(std::istream& is, T* origin,
+                          const size_type* extents, const index* strides,
+                          const index* index_bases) {
+  BOOST_STATIC_ASSERT(is_bitwise_copyable<T>::value);
+  char magic[sizeof(delta_magic)];
+  read_bytes(is,magic,sizeof(magic));
+  if (std::memcmp(magic,delta_magic,sizeof(magic)) != 0)
+    io_failure("boost::multi_array: not a delta");
+  binary_header<NumDims> header;
+  read_binary_header<T,NumDims>(is,header);
+  if (!std::equal(header.extents.begin(),header.extents.end(),extents))
+    io_failure("boost::multi_array: shape mismatch");
+
+  collapsed_dimensions<NumDims> dims;
+  collapse_in_order<NumDims>(extents,strides,dims);
+  size_type total = dims.num_dims == 0 ? 0 : 1;
+  for (size_type n = 0; n != dims.num_dims; ++n)
+    total *= dims.extents[n];
+  T* const first = first_element(origin,NumDims,strides,index_bases);
+
+  std::vector<T> staging;
+  boost::array<size_type,NumDims> counter;
+  size_type position = 0;
+  for (;;) {
+    const boost::uint64_t unchanged = read_number(is);
+    boost::uint64_t count = read_number(is);
+    if (count == 0)
+      return;
+    if (unchanged > total - position ||
+        count > total - position - size_type(unchanged))
+      io_failure("boost::multi_array: corrupt delta");
+    position += size_type(unchanged);
+
+    // the row-major position, as counters of the collapsed dimensions
+    size_type rest = position;
+    T* ptr = first;
+    for (size_type n = 0; n != dims.num_dims; ++n) {
+      counter[n] = rest % dims.extents[n];
+      rest /= dims.extents[n];
+      ptr += index(counter[n]) * dims.strides[n];
+    }
+    position += size_type(count);
+
+    while (count != 0) {
+      const size_type length =
+        (std::min)(size_type(count),dims.extents[0] - counter[0]);
+      if (dims.strides[0] == 1) {
+        read_bytes(is,ptr,length * sizeof(T));
+        if (header.swap)
+          swap_bytes(ptr,sizeof(T),length);
+      } else {
+        staging.resize(length);
+        read_bytes(is,&staging[0],length * sizeof(T));
+        if (header.swap)
+          swap_bytes(&staging[0],sizeof(T),length);
+        for (size_type i = 0; i != length; ++i)
+          ptr[index(i) * dims.strides[0]] = staging[i];
+      }
+      count -= length;
+      if (count == 0)
+        break;
+
+      // on to the start of the next row
+      ptr += index(length) * dims.strides[0];
+      counter[0] += length;
+      for (size_type n = 0; counter[n] == dims.extents[n]; ++n) {
+        ptr -= dims.strides[n] * index(dims.extents[n]);
+        counter[n] = 0;
+        ptr += dims.strides[n + 1];
+        ++counter[n + 1];
+      }
+    }
+  }
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Array1, typename Array2>
+multi_array_types::size_type
+save_delta(std::ostream& os, const Array1& from, const Array2& to) {
+  typedef typename Array2::element element;
+  BOOST_STATIC_ASSERT(std::size_t(Array1::dimensionality) ==
+                      std::size_t(Array2::dimensionality));
+  return detail::multi_array::save_delta_elements<element,
+                                                  Array2::dimensionality>(
+    os,from.origin(),from.shape(),from.strides(),from.index_bases(),
+    to.origin(),to.shape(),to.strides(),to.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void apply_delta(std::istream& is, multi_array_ref<T,NumDims> a) {
+  detail::multi_array::apply_delta_elements<T,NumDims>(is,a.origin(),
+                                                       a.shape(),
+                                                       a.strides(),
+                                                       a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void apply_delta(std::istream& is,
+                 detail::multi_array::sub_array<T,NumDims> a) {
+  detail::multi_array::apply_delta_elements<T,NumDims>(is,a.origin(),
+                                                       a.shape(),
+                                                       a.strides(),
+                                                       a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void apply_delta(std::istream& is,
+                 detail::multi_array::multi_array_view<T,NumDims> a) {
+  detail::multi_array::apply_delta_elements<T,NumDims>(is,a.origin(),
+                                                       a.shape(),
+                                                       a.strides(),
+                                                       a.index_bases());
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
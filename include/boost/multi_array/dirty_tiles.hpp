@@ -0,0 +1,482 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_DIRTY_TILES_HPP
+#define BOOST_MULTI_ARRAY_DIRTY_TILES_HPP
+
+//
+// dirty_tiles.hpp - recording which tiles of an array have been written,
+// so that checkpoints and derived results need only cover those.
+//
+//   dirty_tracked_array<T,NumDims> a(array_ref,tile_extents)
+//     Tracks writes to the elements of array_ref (a multi_array_ref, or
+//     a multi_array, which it refers to without copying), divided into
+//     tiles of tile_extents.  Every tile starts clean.
+//
+//   a(idx), a[i][j]...   the element, as a proxy reference; assigning to
+//                        it (=, +=, -=, *=, /=) marks its tile dirty
+//   a.view(indices[...]) a multi_array_view of the elements, for writing;
+//                        every tile the view's elements fall in is
+//                        marked dirty
+//   a.array()            a const_multi_array_ref of the elements, for
+//                        reading without marking anything
+//   a.mark_dirty(indices[...]), a.mark_all_dirty()
+//                        for elements written some other way
+//   a.is_dirty(t), a.num_dirty(), a.dirty_tiles(), a.clear_dirty()
+//                        the dirty set: tiles are numbered in row-major
+//                        order of the tile grid (see tile_counts()), and
+//                        tile_region(t,start,extents) gives the first
+//                        index (relative to the index bases) and the
+//                        extents of tile t
+//
+//   save_dirty_tiles(os,a)
+//     Writes the dirty tiles of a to os, then clears the dirty set: an
+//     incremental checkpoint.
+//   load_dirty_tiles(is,b)
+//     Copies the tiles of such a checkpoint into b, which must have the
+//     tracked array's shape; applying a full save() (see binary_io.hpp)
+//     and then each increment in turn restores the array.
+//
+// An increment holds the magic "BMTILES", the header of binary_io.hpp
+// describing the tracked array, the tile extents (u64 each), the number
+// of tiles (u64), then for each tile its number (u64) followed by its
+// elements in the array's storage order.  Errors throw
+// std::ios_base::failure.
+//
+// Writes through the elements of array_ref other than the above are not
+// seen.  Marking costs one tile lookup per element write, and one bit
+// per tile.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/chunk_grid.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+static const char dirty_tiles_magic[8] =
+  { 'B','M','T','I','L','E','S','\0' };
+
+//
+// tracked_reference
+//   An element of a dirty_tracked_array; writing through it marks the
+//   element's tile dirty.
+//
+template <typename Tracker>
+class tracked_reference {
+public:
+  typedef typename Tracker::element element;
+  typedef boost::array<index,Tracker::dimensionality> index_list;
+
+  tracked_reference(Tracker& tracker, const index_list& idx) :
+    tracker_(&tracker), idx_(idx) { }
+
+  operator element() const { return tracker_->get(idx_); }
+
+  tracked_reference& operator=(const element& x) {
+    tracker_->set(idx_,x);
+    return *this;
+  }
+  tracked_reference& operator=(const tracked_reference& other) {
+    return *this = element(other);
+  }
+
+  tracked_reference& operator+=(const element& x) {
+    return *this = element(*this) + x;
+  }
+  tracked_reference& operator-=(const element& x) {
+    return *this = element(*this) - x;
+  }
+  tracked_reference& operator*=(const element& x) {
+    return *this = element(*this) * x;
+  }
+  tracked_reference& operator/=(const element& x) {
+    return *this = element(*this) / x;
+  }
+
+private:
+  Tracker* tracker_;
+  index_list idx_;
+};
+
+template <typename Tracker, std::size_t Remaining>
+class tracked_subscript;
+
+// What indexing with one more index gives: a further subscript, or the
+// element once every index is known.
+template <typename Tracker, std::size_t Remaining>
+struct tracked_subscript_result {
+  typedef tracked_subscript<Tracker,Remaining> type;
+};
+
+template <typename Tracker>
+struct tracked_subscript_result<Tracker,0> {
+  typedef tracked_reference<Tracker> type;
+};
+
+//
+// tracked_subscript
+//   A dirty_tracked_array indexed along its first dimensions, with
+//   Remaining dimensions still to index.
+//
+template <typename Tracker, std::size_t Remaining>
+class tracked_subscript {
+public:
+  typedef boost::array<index,Tracker::dimensionality> index_list;
+  typedef typename tracked_subscript_result<Tracker,Remaining - 1>::type
+    result_type;
+
+  tracked_subscript(Tracker& tracker, const index_list& idx) :
+    tracker_(&tracker), idx_(idx) { }
+
+  result_type operator[](index i) const {
+    index_list idx = idx_;
+    idx[Tracker::dimensionality - Remaining] = i;
+    return result_type(*tracker_,idx);
+  }
+
+private:
+  Tracker* tracker_;
+  index_list idx_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims>
+class dirty_tracked_array {
+public:
+  typedef T element;
+  typedef multi_array_types::index index;
+  typedef multi_array_types::size_type size_type;
+  typedef multi_array_ref<T,NumDims> array_ref;
+  typedef const_multi_array_ref<T,NumDims> const_array_ref;
+  typedef detail::multi_array::tracked_reference<dirty_tracked_array>
+    reference;
+  BOOST_STATIC_CONSTANT(std::size_t, dimensionality = NumDims);
+
+  template <int NDims>
+  struct array_view {
+    typedef typename array_ref::template array_view<NDims>::type type;
+  };
+
+  template <typename TileExtentList>
+  dirty_tracked_array(const array_ref& array,
+                      const TileExtentList& tile_extents) :
+    array_(array) {
+    boost::function_requires<
+      CollectionConcept<TileExtentList> >();
+    BOOST_ASSERT(tile_extents.size() == NumDims);
+    std::copy(array.shape(),array.shape() + NumDims,grid_.extents.begin());
+    std::copy(tile_extents.begin(),tile_extents.end(),
+              grid_.chunk_extents.begin());
+    for (std::size_t n = 0; n != NumDims; ++n)
+      BOOST_ASSERT(grid_.chunk_extents[n] != 0);
+    grid_.init();
+    dirty_.assign(grid_.num_chunks,false);
+    num_dirty_ = 0;
+  }
+
+  const_array_ref array() const { return const_array_ref(array_); }
+
+  const size_type* shape() const { return array_.shape(); }
+  const index* index_bases() const { return array_.index_bases(); }
+  size_type num_elements() const { return array_.num_elements(); }
+  size_type num_dimensions() const { return NumDims; }
+
+  const size_type* tile_shape() const { return grid_.chunk_extents.data(); }
+  const size_type* tile_counts() const { return grid_.counts.data(); }
+  size_type num_tiles() const { return grid_.num_chunks; }
+
+  void tile_region(size_type t, index* start, size_type* extents) const {
+    BOOST_ASSERT(t < grid_.num_chunks);
+    grid_.chunk(t,start,extents);
+  }
+
+  // element access
+
+  template <typename IndexList>
+  reference operator()(const IndexList& indices) {
+    boost::function_requires<
+      CollectionConcept<IndexList> >();
+    boost::array<index,NumDims> idx;
+    std::copy(indices.begin(),indices.end(),idx.begin());
+    return reference(*this,idx);
+  }
+
+  typename detail::multi_array::
+    tracked_subscript_result<dirty_tracked_array,NumDims - 1>::type
+  operator[](index i) {
+    typedef typename detail::multi_array::
+      tracked_subscript_result<dirty_tracked_array,NumDims - 1>::type
+      result_type;
+    boost::array<index,NumDims> idx;
+    idx[0] = i;
+    return result_type(*this,idx);
+  }
+
+  template <typename IndexList>
+  element get(const IndexList& indices) const {
+    return array_(indices);
+  }
+
+  template <typename IndexList>
+  void set(const IndexList& indices, const element& x) {
+    array_(indices) = x;
+    mark(grid_.chunk_of(relative(indices.begin()).begin()));
+  }
+
+  template <int NRanges, int NDims>
+  typename array_view<NDims>::type
+  view(const detail::multi_array::index_gen<NRanges,NDims>& indices) {
+    mark_dirty(indices);
+    return array_[indices];
+  }
+
+  // the dirty set
+
+  bool is_dirty(size_type t) const { return dirty_[t]; }
+  size_type num_dirty() const { return num_dirty_; }
+
+  std::vector<size_type> dirty_tiles() const {
+    std::vector<size_type> result;
+    result.reserve(num_dirty_);
+    for (size_type t = 0; t != grid_.num_chunks; ++t)
+      if (dirty_[t])
+        result.push_back(t);
+    return result;
+  }
+
+  void clear_dirty() {
+    dirty_.assign(grid_.num_chunks,false);
+    num_dirty_ = 0;
+  }
+
+  void mark_all_dirty() {
+    dirty_.assign(grid_.num_chunks,true);
+    num_dirty_ = grid_.num_chunks;
+  }
+
+  // Marks the tiles holding the elements indices selects, as for a view.
+  template <int NRanges, int NDims>
+  void mark_dirty(const detail::multi_array::
+                  index_gen<NRanges,NDims>& indices) {
+    BOOST_STATIC_ASSERT(std::size_t(NRanges) == NumDims);
+    // the box of tiles around the selected elements
+    boost::array<size_type,NumDims> first, last, position;
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      const index base = array_.index_bases()[n];
+      const multi_array_types::index_range& range = indices.ranges_[n];
+      const index start = range.get_start(base);
+      const index finish = range.get_finish(base + index(shape()[n]));
+      const index stride = range.stride();
+      index low = start, high = start;
+      if (!range.is_degenerate()) {
+        if ((finish - start) / stride < 0)
+          return;
+        const index shrinkage = stride > 0 ? 1 : -1;
+        const index length = (finish - start + (stride - shrinkage)) / stride;
+        if (length == 0)
+          return;
+        high = start + (length - 1) * stride;
+        if (high < low)
+          std::swap(low,high);
+      }
+      first[n] = size_type(low - base) / grid_.chunk_extents[n];
+      last[n] = size_type(high - base) / grid_.chunk_extents[n];
+    }
+
+    position = first;
+    for (;;) {
+      size_type t = 0;
+      for (std::size_t n = 0; n != NumDims; ++n)
+        t = t * grid_.counts[n] + position[n];
+      mark(t);
+
+      std::size_t n = NumDims;
+      while (n != 0 && position[n - 1] == last[n - 1]) {
+        position[n - 1] = first[n - 1];
+        --n;
+      }
+      if (n == 0)
+        break;
+      ++position[n - 1];
+    }
+  }
+
+private:
+  template <typename IndexIter>
+  boost::array<index,NumDims> relative(IndexIter idx) const {
+    boost::array<index,NumDims> result;
+    for (std::size_t n = 0; n != NumDims; ++n, ++idx)
+      result[n] = *idx - array_.index_bases()[n];
+    return result;
+  }
+
+  void mark(size_type t) {
+    if (!dirty_[t]) {
+      dirty_[t] = true;
+      ++num_dirty_;
+    }
+  }
+
+  // noncopyable
+  dirty_tracked_array(const dirty_tracked_array&);
+  dirty_tracked_array& operator=(const dirty_tracked_array&);
+
+  array_ref array_;
+  detail::multi_array::chunk_grid<NumDims> grid_;
+  std::vector<bool> dirty_;
+  size_type num_dirty_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+// the address of the first element of tile t
+template <typename T, std::size_t NumDims>
+T* tile_origin(const chunk_grid<NumDims>& grid, size_type t, T* origin,
+               const index* strides, size_type* extents) {
+  boost::array<index,NumDims> start;
+  grid.chunk(t,start.data(),extents);
+  for (std::size_t n = 0; n != NumDims; ++n)
+    origin += start[n] * strides[n];
+  return origin;
+}
+
+template <typename T, std::size_t NumDims>
+void load_dirty_tiles_into(std::istream& is, T* origin,
+                           const size_type* extents, const index* strides,
+                           const index* index_bases) {
+  char magic[sizeof(dirty_tiles_magic)];
+  read_bytes(is,magic,sizeof(magic));
+  if (std::memcmp(magic,dirty_tiles_magic,sizeof(magic)) != 0)
+    io_failure("boost::multi_array: not an incremental checkpoint");
+  binary_header<NumDims> header;
+  read_binary_header<T,NumDims>(is,header);
+  if (!std::equal(header.extents.begin(),header.extents.end(),extents))
+    io_failure("boost::multi_array: shape mismatch");
+
+  chunk_grid<NumDims> grid;
+  std::copy(extents,extents + NumDims,grid.extents.begin());
+  for (std::size_t n = 0; n != NumDims; ++n) {
+    grid.chunk_extents[n] =
+      size_type(read_field<boost::uint64_t>(is,header.swap));
+    if (grid.chunk_extents[n] == 0)
+      io_failure("boost::multi_array: corrupt incremental checkpoint");
+  }
+  grid.init();
+
+  const general_storage_order<NumDims> so = header.storage_order();
+  boost::uint64_t count = read_field<boost::uint64_t>(is,header.swap);
+  for (; count != 0; --count) {
+    const boost::uint64_t t = read_field<boost::uint64_t>(is,header.swap);
+    if (t >= grid.num_chunks)
+      io_failure("boost::multi_array: corrupt incremental checkpoint");
+    boost::array<size_type,NumDims> tile_extents;
+    T* tile = tile_origin<T,NumDims>(grid,size_type(t),origin,strides,
+                                     tile_extents.data());
+    read_elements<T,NumDims>(is,header.swap,so,tile,tile_extents.data(),
+                             strides,index_bases);
+  }
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims>
+void save_dirty_tiles(std::ostream& os, dirty_tracked_array<T,NumDims>& a) {
+  using detail::multi_array::write_field;
+  const const_multi_array_ref<T,NumDims> array = a.array();
+  const general_storage_order<NumDims> so =
+    detail::multi_array::storage_order_from_strides<NumDims>(
+      array.strides());
+
+  detail::multi_array::write_bytes(os,detail::multi_array::dirty_tiles_magic,
+    sizeof(detail::multi_array::dirty_tiles_magic));
+  detail::multi_array::write_binary_header<T,NumDims>(os,array.shape(),
+                                                      array.index_bases(),
+                                                      so);
+  detail::multi_array::chunk_grid<NumDims> grid;
+  std::copy(a.shape(),a.shape() + NumDims,grid.extents.begin());
+  std::copy(a.tile_shape(),a.tile_shape() + NumDims,
+            grid.chunk_extents.begin());
+  grid.init();
+  for (std::size_t n = 0; n != NumDims; ++n)
+    write_field(os,boost::uint64_t(grid.chunk_extents[n]));
+
+  const std::vector<multi_array_types::size_type> tiles = a.dirty_tiles();
+  write_field(os,boost::uint64_t(tiles.size()));
+  for (std::size_t i = 0; i != tiles.size(); ++i) {
+    write_field(os,boost::uint64_t(tiles[i]));
+    boost::array<multi_array_types::size_type,NumDims> tile_extents;
+    const T* tile = detail::multi_array::tile_origin<const T,NumDims>(
+      grid,tiles[i],array.origin(),array.strides(),tile_extents.data());
+    detail::multi_array::write_elements<T,NumDims>(os,so,tile,
+                                                   tile_extents.data(),
+                                                   array.strides(),
+                                                   array.index_bases());
+  }
+  a.clear_dirty();
+}
+
+template <typename T, std::size_t NumDims>
+void load_dirty_tiles(std::istream& is, multi_array_ref<T,NumDims> a) {
+  detail::multi_array::load_dirty_tiles_into<T,NumDims>(is,a.origin(),
+                                                        a.shape(),
+                                                        a.strides(),
+                                                        a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load_dirty_tiles(std::istream& is,
+                      detail::multi_array::sub_array<T,NumDims> a) {
+  detail::multi_array::load_dirty_tiles_into<T,NumDims>(is,a.origin(),
+                                                        a.shape(),
+                                                        a.strides(),
+                                                        a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load_dirty_tiles(std::istream& is,
+                      detail::multi_array::multi_array_view<T,NumDims> a) {
+  detail::multi_array::load_dirty_tiles_into<T,NumDims>(is,a.origin(),
+                                                        a.shape(),
+                                                        a.strides(),
+                                                        a.index_bases());
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
@@ -22,6 +22,7 @@
 namespace boost {
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
 
 template <std::size_t NumRanges>
@@ -67,6 +68,8 @@ public:
   }
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
 } // namespace boost
@@ -0,0 +1,244 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_FILL_HPP
+#define BOOST_MULTI_ARRAY_FILL_HPP
+
+//
+// fill.hpp - setting every element of an array, subarray or view to
+// a value (fill_elements) or to successive results of a generator
+// (fill_elements_with).  Not included by multi_array.hpp.
+//
+// Dense runs of trivially copyable elements are written with memset
+// when every byte of the value is the same, and otherwise with 16-byte
+// pattern stores.  Runs larger than BOOST_MULTI_ARRAY_STREAMING_FILL_BYTES
+// (roughly a last level cache) use non-temporal stores so that filling
+// does not evict the working set.  Strided views are collapsed (see
+// collapse.hpp) and filled one run at a time.
+//
+
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/multi_array_ref.hpp"
+#include "boost/multi_array/subarray.hpp"
+#include "boost/multi_array/view.hpp"
+#include "boost/multi_array/types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if !defined(BOOST_MULTI_ARRAY_NO_SIMD) && \
+  (defined(__SSE2__) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define BOOST_MULTI_ARRAY_HAS_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifndef BOOST_MULTI_ARRAY_STREAMING_FILL_BYTES
+#  define BOOST_MULTI_ARRAY_STREAMING_FILL_BYTES (std::size_t(32) << 20)
+#endif
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+// true if every byte of value is the same, which lets memset do the job
+template <typename T>
+bool is_byte_pattern(const T& value, unsigned char& byte) {
+  const unsigned char* bytes =
+    reinterpret_cast<const unsigned char*>(&value);
+  byte = bytes[0];
+  for (std::size_t i = 1; i != sizeof(T); ++i)
+    if (bytes[i] != byte)
+      return false;
+  return true;
+}
+
+#ifdef BOOST_MULTI_ARRAY_HAS_SSE2
+// Fills [ptr,ptr+count) with 16-byte pattern stores.  Only valid when
+// sizeof(T) divides 16 and ptr is aligned to sizeof(T), so that an
+// aligned 16-byte block always starts on an element boundary.
+template <typename T>
+void pattern_fill(T* ptr, std::size_t count, const T& value,
+                  bool streaming) {
+  T* const last = ptr + count;
+  while (ptr != last && (reinterpret_cast<std::size_t>(ptr) & 15) != 0)
+    *ptr++ = value;
+
+  unsigned char pattern_bytes[16];
+  for (std::size_t i = 0; i != 16; i += sizeof(T))
+    std::memcpy(pattern_bytes + i,&value,sizeof(T));
+  const __m128i pattern =
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern_bytes));
+
+  const std::size_t per_block = 16 / sizeof(T);
+  std::size_t blocks = std::size_t(last - ptr) / per_block;
+  __m128i* out = reinterpret_cast<__m128i*>(ptr);
+  if (streaming) {
+    for (; blocks != 0; --blocks)
+      _mm_stream_si128(out++,pattern);
+    _mm_sfence();
+  } else {
+    for (; blocks != 0; --blocks)
+      _mm_store_si128(out++,pattern);
+  }
+  ptr = reinterpret_cast<T*>(out);
+  while (ptr != last)
+    *ptr++ = value;
+}
+#endif // BOOST_MULTI_ARRAY_HAS_SSE2
+
+template <typename T>
+void fill_dense(T* ptr, std::size_t count, const T& value,
+                const boost::true_type&) {
+  unsigned char byte;
+  if (is_byte_pattern(value,byte)) {
+    std::memset(ptr,byte,count * sizeof(T));
+    return;
+  }
+#ifdef BOOST_MULTI_ARRAY_HAS_SSE2
+  if (16 % sizeof(T) == 0 &&
+      reinterpret_cast<std::size_t>(ptr) % sizeof(T) == 0) {
+    pattern_fill(ptr,count,value,
+                 count * sizeof(T) >= BOOST_MULTI_ARRAY_STREAMING_FILL_BYTES);
+    return;
+  }
+#endif
+  std::fill_n(ptr,count,value);
+}
+
+template <typename T>
+void fill_dense(T* ptr, std::size_t count, const T& value,
+                const boost::false_type&) {
+  std::fill_n(ptr,count,value);
+}
+
+template <typename T>
+class fill_run {
+public:
+  explicit fill_run(const T& value) : value_(value) { }
+
+  void operator()(T* ptr, size_type count, index stride) {
+    if (stride == 1) {
+      fill_dense(ptr,count,value_,
+                 boost::integral_constant<bool,
+                   is_bitwise_copyable<T>::value>());
+    } else {
+      for (; count != 0; --count, ptr += stride)
+        *ptr = value_;
+    }
+  }
+private:
+  const T& value_;
+};
+
+template <typename T, typename Generator>
+class generate_run {
+public:
+  explicit generate_run(Generator& gen) : gen_(gen) { }
+
+  void operator()(T* ptr, size_type count, index stride) {
+    for (; count != 0; --count, ptr += stride)
+      *ptr = gen_();
+  }
+private:
+  Generator& gen_;
+};
+
+template <std::size_t NumDims, typename T>
+void fill_array(T* origin, const size_type* extents, const index* strides,
+                const index* index_bases, const T& value) {
+  collapsed_dimensions<NumDims> dims;
+  collapse_any_order<NumDims>(extents,strides,dims);
+  fill_run<T> f(value);
+  for_each_run(first_element(origin,NumDims,strides,index_bases),dims,f);
+}
+
+// The generator is called in logical (row-major index) order, regardless
+// of the storage order of the array.
+template <std::size_t NumDims, typename T, typename Generator>
+void generate_array(T* origin, const size_type* extents,
+                    const index* strides, const index* index_bases,
+                    Generator& gen) {
+  collapsed_dimensions<NumDims> dims;
+  collapse_in_order<NumDims>(extents,strides,dims);
+  generate_run<T,Generator> f(gen);
+  for_each_run(first_element(origin,NumDims,strides,index_bases),dims,f);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// fill_elements / fill_elements_with
+//   Named apart from boost::fill, which Boost.Range brings into namespace
+//   boost and which would otherwise be picked for a whole array.
+//   The arrays are taken by value: multi_array_ref, sub_array and
+//   multi_array_view are all shallow handles, and this lets temporary
+//   subarrays and views such as A[2] or A[indices[...]] be filled.
+//   A multi_array binds to the multi_array_ref overload.
+//
+template <typename T, std::size_t NumDims>
+void fill_elements(multi_array_ref<T,NumDims> a,
+                   const typename multi_array_ref<T,NumDims>::element& value) {
+  detail::multi_array::fill_array<NumDims>(a.origin(),a.shape(),
+                                           a.strides(),a.index_bases(),
+                                           value);
+}
+
+template <typename T, std::size_t NumDims>
+void fill_elements(detail::multi_array::sub_array<T,NumDims> a,
+                   const typename
+                     detail::multi_array::sub_array<T,NumDims>::element&
+                       value) {
+  detail::multi_array::fill_array<NumDims>(a.origin(),a.shape(),
+                                           a.strides(),a.index_bases(),
+                                           value);
+}
+
+template <typename T, std::size_t NumDims>
+void fill_elements(detail::multi_array::multi_array_view<T,NumDims> a,
+                   const typename
+                     detail::multi_array::multi_array_view<T,NumDims>::element&
+                       value) {
+  detail::multi_array::fill_array<NumDims>(a.origin(),a.shape(),
+                                           a.strides(),a.index_bases(),
+                                           value);
+}
+
+template <typename T, std::size_t NumDims, typename Generator>
+void fill_elements_with(multi_array_ref<T,NumDims> a, Generator gen) {
+  detail::multi_array::generate_array<NumDims>(a.origin(),a.shape(),
+                                               a.strides(),a.index_bases(),
+                                               gen);
+}
+
+template <typename T, std::size_t NumDims, typename Generator>
+void fill_elements_with(detail::multi_array::sub_array<T,NumDims> a,
+                        Generator gen) {
+  detail::multi_array::generate_array<NumDims>(a.origin(),a.shape(),
+                                               a.strides(),a.index_bases(),
+                                               gen);
+}
+
+template <typename T, std::size_t NumDims, typename Generator>
+void fill_elements_with(detail::multi_array::multi_array_view<T,NumDims> a,
+                        Generator gen) {
+  detail::multi_array::generate_array<NumDims>(a.origin(),a.shape(),
+                                               a.strides(),a.index_bases(),
+                                               gen);
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
@@ -23,6 +23,7 @@
 namespace boost {
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
 
 template <int NumRanges, int NumDims>
@@ -73,6 +74,8 @@ public:
   }
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
 } // namespace boost
@@ -0,0 +1,307 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_INSTRUMENTATION_HPP
+#define BOOST_MULTI_ARRAY_INSTRUMENTATION_HPP
+
+//
+// instrumentation.hpp - hooks on the costly operations of the library:
+// allocations, deep copies, resizes and the creation of views.
+//
+// The hooks are compiled in only when BOOST_MULTI_ARRAY_INSTRUMENTATION
+// is defined before the library is included; otherwise they expand to
+// nothing and cost nothing.  When compiled in, each hook reports to the
+// observer installed with set_observer() (none by default):
+//
+//   allocation, deallocation   instant(e): the elements and bytes of the
+//                              storage of a multi_array
+//   view_creation              instant(e): the elements of the view
+//   copy                       begin(e) and end(e,token) around a deep
+//                              copy through assignment or a converting
+//                              constructor, with the layout of the
+//                              source and the destination and whether
+//                              a fast path (a flat copy) was taken.
+//                              The copies of the sub-arrays that make
+//                              up a copy are not reported.
+//   resize                     begin(e) and end(e,token) around resize():
+//                              the elements before and after, and
+//                              whether it was done in place
+//
+// begin() returns a token that is passed back to the matching end(), for
+// example the time the operation began.  The observer is called on the
+// thread doing the operation, so it must be thread-safe when arrays are
+// used from several threads.  instrumentation_collectors.hpp has a
+// collector that prints a summary and one that writes a Chrome trace.
+//
+//   #define BOOST_MULTI_ARRAY_INSTRUMENTATION
+//   #include <boost/multi_array.hpp>
+//   #include <boost/multi_array/instrumentation_collectors.hpp>
+//
+//   boost::multi_array_instrumentation::summary_collector summary;
+//   {
+//     boost::multi_array_instrumentation::scoped_observer scope(summary);
+//     run();
+//   }
+//   summary.report(std::cout);
+//
+
+#include "boost/multi_array/threads.hpp"
+#include "boost/config.hpp"
+#include "boost/cstdint.hpp"
+#include <cstddef>
+#include <typeinfo>
+
+namespace boost {
+namespace multi_array_instrumentation {
+
+enum event_kind {
+  allocation,
+  deallocation,
+  copy,
+  resize,
+  view_creation
+};
+
+// How the elements of one side of a copy lie in memory: contiguous in
+// C (row-major) or Fortran (column-major) order, or neither.
+enum layout_kind {
+  no_layout,
+  c_contiguous,
+  fortran_contiguous,
+  strided
+};
+
+struct event {
+  event_kind kind;
+  const std::type_info* element_type;
+  std::size_t element_size;
+  std::size_t num_dimensions;
+  std::size_t elements;       // allocated, copied, in the view, or
+                              // after a resize
+  std::size_t bytes;          // elements * element_size
+  std::size_t old_elements;   // before a resize
+  layout_kind source;         // of a copy
+  layout_kind destination;
+  bool fast_path;             // a flat copy, or a resize in place
+};
+
+class observer {
+public:
+  virtual ~observer() { }
+  virtual void instant(const event&) { }
+  virtual boost::uint64_t begin(const event&) { return 0; }
+  virtual void end(const event&, boost::uint64_t /*token*/) { }
+};
+
+namespace detail {
+
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+inline std::atomic<observer*>& current() {
+  static std::atomic<observer*> installed(0);
+  return installed;
+}
+#else
+inline observer*& current() {
+  static observer* installed = 0;
+  return installed;
+}
+#endif
+
+} // namespace detail
+
+inline observer* get_observer() { return detail::current(); }
+
+// Installs o (0 for none), returning the observer it replaces.
+inline observer* set_observer(observer* o) {
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+  return detail::current().exchange(o);
+#else
+  observer* previous = detail::current();
+  detail::current() = o;
+  return previous;
+#endif
+}
+
+// Installs an observer for the lifetime of the scope.
+class scoped_observer {
+public:
+  explicit scoped_observer(observer& o) : previous_(set_observer(&o)) { }
+  ~scoped_observer() { set_observer(previous_); }
+private:
+  scoped_observer(const scoped_observer&);             // noncopyable
+  scoped_observer& operator=(const scoped_observer&);
+  observer* previous_;
+};
+
+// The layout of num_dims dimensions with the given extents and strides.
+template <typename SizeType, typename Index>
+layout_kind layout_of(std::size_t num_dims, const SizeType* extents,
+                      const Index* strides) {
+  // Dimensions of extent 1 may have any stride.
+  bool c = true;
+  Index expected = 1;
+  for (std::size_t n = num_dims; n != 0; --n) {
+    if (extents[n - 1] != 1 && strides[n - 1] != expected)
+      c = false;
+    expected *= Index(extents[n - 1]);
+  }
+  if (c)
+    return c_contiguous;
+  expected = 1;
+  for (std::size_t n = 0; n != num_dims; ++n) {
+    if (extents[n] != 1 && strides[n] != expected)
+      return strided;
+    expected *= Index(extents[n]);
+  }
+  return fortran_contiguous;
+}
+
+namespace detail {
+
+template <typename T>
+event make_event(event_kind kind, std::size_t num_dimensions,
+                 std::size_t elements) {
+  event e;
+  e.kind = kind;
+  e.element_type = &typeid(T);
+  e.element_size = sizeof(T);
+  e.num_dimensions = num_dimensions;
+  e.elements = elements;
+  e.bytes = elements * sizeof(T);
+  e.old_elements = 0;
+  e.source = no_layout;
+  e.destination = no_layout;
+  e.fast_path = false;
+  return e;
+}
+
+template <typename T>
+void instant(event_kind kind, std::size_t num_dimensions,
+             std::size_t elements) {
+  if (observer* o = get_observer())
+    o->instant(make_event<T>(kind,num_dimensions,elements));
+}
+
+template <typename T, typename SizeType>
+void view_created(std::size_t num_dimensions, const SizeType* extents) {
+  if (observer* o = get_observer()) {
+    std::size_t elements = 1;
+    for (std::size_t n = 0; n != num_dimensions; ++n)
+      elements *= std::size_t(extents[n]);
+    o->instant(make_event<T>(view_creation,num_dimensions,elements));
+  }
+}
+
+// Whether the calling thread is inside a reported copy.
+inline bool& copying() {
+#if !defined(BOOST_NO_CXX11_THREAD_LOCAL)
+  static thread_local bool inside = false;
+#else
+  static bool inside = false;
+#endif
+  return inside;
+}
+
+// Reports an operation from its construction to its destruction.
+class scope {
+public:
+  scope() : observer_(0), token_(0) { }
+  ~scope() {
+    if (observer_)
+      observer_->end(event_,token_);
+  }
+
+protected:
+  void begin(const event& e) {
+    observer_ = get_observer();
+    if (observer_) {
+      event_ = e;
+      token_ = observer_->begin(event_);
+    }
+  }
+
+  observer* observer_;
+  event event_;
+  boost::uint64_t token_;
+
+private:
+  scope(const scope&);             // noncopyable
+  scope& operator=(const scope&);
+};
+
+class copy_scope : public scope {
+public:
+  template <typename Source, typename Destination>
+  copy_scope(const Source& source, const Destination& destination,
+             bool fast_path = false) : outermost_(!copying()) {
+    if (!outermost_)
+      return;
+    copying() = true;
+    typedef typename Destination::element element;
+    event e = make_event<element>(copy,destination.num_dimensions(),
+                                  destination.num_elements());
+    e.source = layout_of(source.num_dimensions(),source.shape(),
+                         source.strides());
+    e.destination = layout_of(destination.num_dimensions(),
+                              destination.shape(),destination.strides());
+    e.fast_path = fast_path;
+    begin(e);
+  }
+
+  ~copy_scope() {
+    if (outermost_)
+      copying() = false;
+  }
+
+private:
+  bool outermost_;
+};
+
+class resize_scope : public scope {
+public:
+  template <typename Array>
+  resize_scope(const Array& a, std::size_t new_elements, bool in_place) {
+    typedef typename Array::element element;
+    event e = make_event<element>(resize,a.num_dimensions(),new_elements);
+    e.old_elements = a.num_elements();
+    e.fast_path = in_place;
+    begin(e);
+  }
+};
+
+} // namespace detail
+
+} // namespace multi_array_instrumentation
+} // namespace boost
+
+//
+// The hooks the library calls.  A scope hook declares a variable that
+// reports the operation until the end of the enclosing block.  Without
+// BOOST_MULTI_ARRAY_INSTRUMENTATION, base.hpp defines them to do nothing
+// (and does not include this header).
+//
+#if defined(BOOST_MULTI_ARRAY_INSTRUMENTATION)
+
+#define BOOST_MULTI_ARRAY_TRACE_ALLOCATION(T,num_dims,elements)            \
+  ::boost::multi_array_instrumentation::detail::instant<T>(                \
+    ::boost::multi_array_instrumentation::allocation,num_dims,elements)
+#define BOOST_MULTI_ARRAY_TRACE_DEALLOCATION(T,num_dims,elements)          \
+  ::boost::multi_array_instrumentation::detail::instant<T>(                \
+    ::boost::multi_array_instrumentation::deallocation,num_dims,elements)
+#define BOOST_MULTI_ARRAY_TRACE_VIEW(T,num_dims,extents)                   \
+  ::boost::multi_array_instrumentation::detail::view_created<T>(           \
+    num_dims,extents)
+#define BOOST_MULTI_ARRAY_TRACE_COPY(source,destination,fast_path)         \
+  ::boost::multi_array_instrumentation::detail::copy_scope                 \
+    boost_multi_array_copy_scope(source,destination,fast_path)
+#define BOOST_MULTI_ARRAY_TRACE_RESIZE(array,new_elements,in_place)        \
+  ::boost::multi_array_instrumentation::detail::resize_scope               \
+    boost_multi_array_resize_scope(array,new_elements,in_place)
+
+#endif
+
+#endif
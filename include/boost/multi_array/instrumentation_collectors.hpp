@@ -0,0 +1,356 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_INSTRUMENTATION_COLLECTORS_HPP
+#define BOOST_MULTI_ARRAY_INSTRUMENTATION_COLLECTORS_HPP
+
+//
+// instrumentation_collectors.hpp - observers for the instrumentation
+// hooks of instrumentation.hpp:
+//
+//   summary_collector       counts the events of each kind with their
+//                           elements, bytes and time, the layouts of the
+//                           copies and the peak of allocated bytes;
+//                           report(os) prints the summary
+//   chrome_trace_collector  records every event with its time and
+//                           thread; write(os) writes them in the Chrome
+//                           trace event format, for chrome://tracing or
+//                           Perfetto: copies and resizes as spans,
+//                           allocations and views as instant events, and
+//                           a counter of the allocated bytes
+//
+// Both are safe to use from several threads.  Without
+// BOOST_MULTI_ARRAY_INSTRUMENTATION they compile but see no events.
+//
+
+#include "boost/multi_array/instrumentation.hpp"
+#include "boost/multi_array/threads.hpp"
+#include "boost/config.hpp"
+#include "boost/cstdint.hpp"
+#include <cstddef>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef BOOST_NO_CXX11_HDR_CHRONO
+#  include <chrono>
+#endif
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+#  include <map>
+#endif
+
+namespace boost {
+namespace multi_array_instrumentation {
+
+inline const char* kind_name(event_kind kind) {
+  switch (kind) {
+  case allocation: return "allocation";
+  case deallocation: return "deallocation";
+  case copy: return "copy";
+  case resize: return "resize";
+  case view_creation: return "view";
+  }
+  return "unknown";
+}
+
+inline const char* layout_name(layout_kind layout) {
+  switch (layout) {
+  case no_layout: return "none";
+  case c_contiguous: return "c";
+  case fortran_contiguous: return "fortran";
+  case strided: return "strided";
+  }
+  return "unknown";
+}
+
+namespace detail {
+
+// Microseconds since an arbitrary start.
+inline boost::uint64_t now_us() {
+#ifndef BOOST_NO_CXX11_HDR_CHRONO
+  return boost::uint64_t(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+  return boost::uint64_t(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+// A mutex when there are threads; otherwise nothing.
+class collector_mutex {
+public:
+  collector_mutex() { }
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+  void lock() { mutex_.lock(); }
+  void unlock() { mutex_.unlock(); }
+private:
+  std::mutex mutex_;
+#else
+  void lock() { }
+  void unlock() { }
+#endif
+private:
+  collector_mutex(const collector_mutex&);             // noncopyable
+  collector_mutex& operator=(const collector_mutex&);
+};
+
+class collector_lock {
+public:
+  explicit collector_lock(collector_mutex& m) : mutex_(m) { mutex_.lock(); }
+  ~collector_lock() { mutex_.unlock(); }
+private:
+  collector_lock(const collector_lock&);             // noncopyable
+  collector_lock& operator=(const collector_lock&);
+  collector_mutex& mutex_;
+};
+
+const std::size_t num_kinds = view_creation + 1;
+const std::size_t num_layouts = strided + 1;
+
+} // namespace detail
+
+class summary_collector : public observer {
+public:
+  struct totals {
+    std::size_t count;
+    boost::uint64_t elements;
+    boost::uint64_t bytes;
+    boost::uint64_t microseconds;   // copies and resizes
+    std::size_t fast_paths;         // copies and resizes
+  };
+
+  summary_collector() { reset(); }
+
+  virtual void instant(const event& e) {
+    detail::collector_lock lock(mutex_);
+    add(e,0);
+    if (e.kind == allocation) {
+      allocated_ += e.bytes;
+      if (allocated_ > peak_)
+        peak_ = allocated_;
+    } else if (e.kind == deallocation) {
+      allocated_ = e.bytes > allocated_ ? 0 : allocated_ - e.bytes;
+    }
+  }
+
+  virtual boost::uint64_t begin(const event&) { return detail::now_us(); }
+
+  virtual void end(const event& e, boost::uint64_t start) {
+    const boost::uint64_t elapsed = detail::now_us() - start;
+    detail::collector_lock lock(mutex_);
+    add(e,elapsed);
+    if (e.kind == copy)
+      ++copy_layouts_[e.source][e.destination];
+  }
+
+  totals get(event_kind kind) const {
+    detail::collector_lock lock(mutex_);
+    return totals_[kind];
+  }
+
+  // the copies from source to destination layouts
+  std::size_t copies(layout_kind source, layout_kind destination) const {
+    detail::collector_lock lock(mutex_);
+    return copy_layouts_[source][destination];
+  }
+
+  // the most bytes allocated at once while observing
+  boost::uint64_t peak_bytes() const {
+    detail::collector_lock lock(mutex_);
+    return peak_;
+  }
+
+  void reset() {
+    detail::collector_lock lock(mutex_);
+    for (std::size_t k = 0; k != detail::num_kinds; ++k) {
+      totals t = { 0, 0, 0, 0, 0 };
+      totals_[k] = t;
+    }
+    for (std::size_t s = 0; s != detail::num_layouts; ++s)
+      for (std::size_t d = 0; d != detail::num_layouts; ++d)
+        copy_layouts_[s][d] = 0;
+    allocated_ = 0;
+    peak_ = 0;
+  }
+
+  void report(std::ostream& os) const {
+    detail::collector_lock lock(mutex_);
+    std::ostringstream out;
+    out << "Boost.MultiArray instrumentation summary\n"
+        << std::left << std::setw(14) << "event" << std::right
+        << std::setw(10) << "count" << std::setw(14) << "elements"
+        << std::setw(16) << "bytes" << std::setw(12) << "ms"
+        << std::setw(12) << "fast path" << '\n';
+    for (std::size_t k = 0; k != detail::num_kinds; ++k) {
+      const totals& t = totals_[k];
+      const bool timed = k == copy || k == resize;
+      out << std::left << std::setw(14) << kind_name(event_kind(k))
+          << std::right << std::setw(10) << t.count << std::setw(14)
+          << t.elements << std::setw(16) << t.bytes << std::setw(12);
+      if (timed)
+        out << std::fixed << std::setprecision(3)
+            << double(t.microseconds) / 1000 << std::setw(12)
+            << t.fast_paths;
+      else
+        out << '-' << std::setw(12) << '-';
+      out << '\n';
+    }
+    out << "peak allocated bytes: " << peak_ << '\n';
+    if (totals_[copy].count != 0) {
+      out << "copies by layout (source -> destination):\n";
+      for (std::size_t s = 0; s != detail::num_layouts; ++s)
+        for (std::size_t d = 0; d != detail::num_layouts; ++d)
+          if (copy_layouts_[s][d] != 0)
+            out << "  " << layout_name(layout_kind(s)) << " -> "
+                << layout_name(layout_kind(d)) << ": "
+                << copy_layouts_[s][d] << '\n';
+    }
+    os << out.str();
+  }
+
+private:
+  void add(const event& e, boost::uint64_t elapsed) {
+    totals& t = totals_[e.kind];
+    ++t.count;
+    t.elements += e.elements;
+    t.bytes += e.bytes;
+    t.microseconds += elapsed;
+    if (e.fast_path)
+      ++t.fast_paths;
+  }
+
+  mutable detail::collector_mutex mutex_;
+  totals totals_[detail::num_kinds];
+  std::size_t copy_layouts_[detail::num_layouts][detail::num_layouts];
+  boost::uint64_t allocated_;
+  boost::uint64_t peak_;
+};
+
+class chrome_trace_collector : public observer {
+public:
+  chrome_trace_collector() : start_(detail::now_us()), allocated_(0) { }
+
+  virtual void instant(const event& e) {
+    const boost::uint64_t now = detail::now_us();
+    detail::collector_lock lock(mutex_);
+    record r = make_record(e,now,0,'i');
+    records_.push_back(r);
+    if (e.kind == allocation || e.kind == deallocation) {
+      if (e.kind == allocation)
+        allocated_ += e.bytes;
+      else
+        allocated_ = e.bytes > allocated_ ? 0 : allocated_ - e.bytes;
+      r.phase = 'C';
+      r.allocated = allocated_;
+      records_.push_back(r);
+    }
+  }
+
+  virtual boost::uint64_t begin(const event&) { return detail::now_us(); }
+
+  virtual void end(const event& e, boost::uint64_t start) {
+    const boost::uint64_t now = detail::now_us();
+    detail::collector_lock lock(mutex_);
+    records_.push_back(make_record(e,start,now - start,'X'));
+  }
+
+  std::size_t size() const {
+    detail::collector_lock lock(mutex_);
+    return records_.size();
+  }
+
+  void clear() {
+    detail::collector_lock lock(mutex_);
+    records_.clear();
+  }
+
+  void write(std::ostream& os) const {
+    detail::collector_lock lock(mutex_);
+    std::ostringstream out;
+    out << "{\"traceEvents\":[";
+    for (std::size_t i = 0; i != records_.size(); ++i) {
+      const record& r = records_[i];
+      const event& e = r.e;
+      out << (i == 0 ? "\n" : ",\n") << "{\"pid\":1,\"tid\":" << r.thread
+          << ",\"ts\":" << r.time - start_ << ",\"ph\":\"" << r.phase
+          << '"';
+      if (r.phase == 'C') {
+        out << ",\"name\":\"allocated bytes\",\"args\":{\"bytes\":"
+            << r.allocated << "}}";
+        continue;
+      }
+      out << ",\"name\":\"" << kind_name(e.kind) << "\",\"cat\":\"multi_array\"";
+      if (r.phase == 'X')
+        out << ",\"dur\":" << r.duration;
+      else
+        out << ",\"s\":\"t\"";
+      out << ",\"args\":{\"dimensions\":" << e.num_dimensions
+          << ",\"elements\":" << e.elements << ",\"bytes\":" << e.bytes
+          << ",\"element_size\":" << e.element_size;
+      if (e.kind == copy)
+        out << ",\"source\":\"" << layout_name(e.source)
+            << "\",\"destination\":\"" << layout_name(e.destination)
+            << "\",\"fast_path\":" << (e.fast_path ? "true" : "false");
+      if (e.kind == resize)
+        out << ",\"old_elements\":" << e.old_elements
+            << ",\"in_place\":" << (e.fast_path ? "true" : "false");
+      out << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    os << out.str();
+  }
+
+private:
+  struct record {
+    event e;
+    char phase;                 // 'X' span, 'i' instant, 'C' counter
+    boost::uint64_t time;
+    boost::uint64_t duration;
+    boost::uint64_t allocated;
+    std::size_t thread;
+  };
+
+  // with the mutex held
+  record make_record(const event& e, boost::uint64_t time,
+                     boost::uint64_t duration, char phase) {
+    record r;
+    r.e = e;
+    r.phase = phase;
+    r.time = time;
+    r.duration = duration;
+    r.allocated = 0;
+    r.thread = thread_number();
+    return r;
+  }
+
+  std::size_t thread_number() {
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+    const std::thread::id id = std::this_thread::get_id();
+    std::map<std::thread::id,std::size_t>::iterator i = threads_.find(id);
+    if (i == threads_.end())
+      i = threads_.insert(std::make_pair(id,threads_.size() + 1)).first;
+    return i->second;
+#else
+    return 1;
+#endif
+  }
+
+  mutable detail::collector_mutex mutex_;
+  boost::uint64_t start_;
+  boost::uint64_t allocated_;
+  std::vector<record> records_;
+#if defined(BOOST_MULTI_ARRAY_HAS_THREADS)
+  std::map<std::thread::id,std::size_t> threads_;
+#endif
+};
+
+} // namespace multi_array_instrumentation
+} // namespace boost
+
+#endif
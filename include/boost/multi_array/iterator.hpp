@@ -27,6 +27,7 @@
 namespace boost {
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
 /////////////////////////////////////////////////////////////////////////
 // iterator components
@@ -53,7 +54,7 @@ class array_iterator
   : public
     iterator_facade<
         array_iterator<T,TPtr,NumDims,Reference,IteratorCategory>
-      , typename associated_types<T,NumDims>::value_type
+      , typename value_accessor_generator<T,NumDims>::type::value_type
       , IteratorCategory
       , Reference
     >
@@ -61,11 +62,11 @@ class array_iterator
           value_accessor_generator<T,NumDims>::type
 {
   friend class ::boost::iterator_core_access;
-  typedef detail::multi_array::associated_types<T,NumDims> access_t;
+  typedef typename value_accessor_generator<T,NumDims>::type access_t;
 
   typedef iterator_facade<
             array_iterator<T,TPtr,NumDims,Reference,IteratorCategory>
-      , typename detail::multi_array::associated_types<T,NumDims>::value_type
+      , typename access_t::value_type
       , boost::random_access_traversal_tag
       , Reference
     > facade_type;
@@ -85,6 +86,9 @@ class array_iterator
   const size_type* extents_;
   const index* strides_;
   const index* index_base_;
+  // The element counts handed to the sub_arrays this iterator refers
+  // to; null when iterating over a view.
+  const size_type* element_counts_;
  
 public:
   // Typedefs to circumvent ambiguities between parent classes
@@ -96,9 +100,11 @@ public:
 
   array_iterator(index idx, TPtr base, const size_type* extents,
                 const index* strides,
-                const index* index_base) :
+                const index* index_base,
+                const size_type* element_counts = 0) :
     idx_(idx), base_(base), extents_(extents),
-    strides_(strides), index_base_(index_base) { }
+    strides_(strides), index_base_(index_base),
+    element_counts_(element_counts) { }
 
   template <typename OPtr, typename ORef, typename Cat>
   array_iterator(
@@ -106,7 +112,8 @@ public:
     , typename boost::enable_if_convertible<OPtr,TPtr>::type* = 0
   )
     : idx_(rhs.idx_), base_(rhs.base_), extents_(rhs.extents_),
-    strides_(rhs.strides_), index_base_(rhs.index_base_) { }
+    strides_(rhs.strides_), index_base_(rhs.index_base_),
+    element_counts_(rhs.element_counts_) { }
 
 
   // RG - we make our own operator->
@@ -119,13 +126,13 @@ public:
 
   reference dereference() const
   {
-    typedef typename value_accessor_generator<T,NumDims>::type accessor;
-    return accessor::access(boost::type<reference>(),
+    return access_t::access(boost::type<reference>(),
                             idx_,
                             base_,
                             extents_,
                             strides_,
-                            index_base_);
+                            index_base_,
+                            element_counts_);
   }
   
   void increment() { ++idx_; }
@@ -158,6 +165,8 @@ public:
 
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
 } // namespace boost
@@ -0,0 +1,190 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_MDSPAN_HPP
+#define BOOST_MULTI_ARRAY_MDSPAN_HPP
+
+//
+// mdspan.hpp - zero-copy conversions between the MultiArray types and
+// C++23 std::mdspan.  Everything here is only defined when the standard
+// library provides <mdspan>; BOOST_MULTI_ARRAY_HAS_MDSPAN tells.
+//
+//   to_mdspan(a)
+//     An mdspan over any array, subarray or view.  The default layout
+//     is std::layout_stride, which describes every storage order.
+//     std::layout_right or std::layout_left may be requested instead
+//     when the array is known to be C or Fortran ordered; that is
+//     checked with BOOST_ASSERT.  Extents are dynamic unless an
+//     extents type with static extents is given, e.g.
+//       to_mdspan<std::layout_right, std::extents<std::ptrdiff_t,4,4> >(a)
+//     The mdspan starts at the element at a's index bases.  mdspan
+//     requires positive strides, so views with reversed dimensions
+//     cannot be converted.
+//
+//   make_array_view(m) / make_const_array_view(m)
+//     A view of the elements of a strided mdspan with a pointer data
+//     handle (see view.hpp).  make_array_view yields a const view when
+//     the mdspan's element type is const.
+//
+
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/multi_array/view.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include <cstddef>
+
+#if defined(__has_include)
+#  if __has_include(<version>)
+#    include <version>
+#  endif
+#endif
+
+#if defined(__cpp_lib_mdspan)
+
+#define BOOST_MULTI_ARRAY_HAS_MDSPAN
+
+#include <algorithm>
+#include <array>
+#include <mdspan>
+#include <type_traits>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Extents, typename Array>
+Extents mdspan_extents(const Array& a) {
+  typedef typename Extents::index_type index_type;
+  std::array<index_type,Extents::rank()> all;
+  for (std::size_t r = 0; r != Extents::rank(); ++r) {
+    BOOST_ASSERT(Extents::static_extent(r) == std::dynamic_extent ||
+                 Extents::static_extent(r) == a.shape()[r]);
+    all[r] = index_type(a.shape()[r]);
+  }
+  return Extents(all);
+}
+
+template <typename Layout, typename Extents, typename Array>
+typename Layout::template mapping<Extents>
+mdspan_mapping(const Extents& extents, const Array& a) {
+  typedef typename Layout::template mapping<Extents> mapping_type;
+  typedef typename Extents::index_type index_type;
+  // The stride of a dimension of extent one is never used, and neither
+  // is any stride of an empty array, which may be zero.
+  const bool empty = a.num_elements() == 0;
+  if constexpr (std::is_same_v<Layout,std::layout_stride>) {
+    // layout_stride wants positive strides of a unique layout; an empty
+    // array gets those of a C ordered array with its zero extents
+    // counted as one, and a dimension of extent one gets a stride of one
+    std::array<index_type,Extents::rank()> strides;
+    index_type packed = 1;
+    for (std::size_t r = Extents::rank(); r != 0; --r) {
+      const std::size_t d = r - 1;
+      if (empty) {
+        strides[d] = packed;
+        packed *= (std::max)(index_type(a.shape()[d]),index_type(1));
+      } else if (a.shape()[d] == 1) {
+        strides[d] = 1;
+      } else {
+        BOOST_ASSERT(a.strides()[d] > 0);
+        strides[d] = index_type(a.strides()[d]);
+      }
+    }
+    return mapping_type(extents,strides);
+  } else {
+    mapping_type mapping(extents);
+    for (std::size_t r = 0; r != Extents::rank(); ++r)
+      BOOST_ASSERT(empty || a.shape()[r] < 2 ||
+                   index(mapping.stride(r)) == a.strides()[r]);
+    return mapping;
+  }
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Layout = std::layout_stride, typename Extents = void,
+          typename Array>
+auto to_mdspan(Array&& a) {
+  typedef std::remove_cvref_t<Array> array_type;
+  const std::size_t NumDims = array_type::dimensionality;
+  typedef std::conditional_t<std::is_void_v<Extents>,
+                             std::dextents<multi_array_types::index,NumDims>,
+                             Extents> extents_type;
+  static_assert(extents_type::rank() == NumDims,
+                "to_mdspan: the extents type has the wrong rank");
+
+  auto first = detail::multi_array::first_element(a.origin(),NumDims,
+                                                  a.strides(),
+                                                  a.index_bases());
+  typedef std::remove_pointer_t<decltype(first)> element_type;
+
+  const extents_type extents =
+    detail::multi_array::mdspan_extents<extents_type>(a);
+  return std::mdspan<element_type,extents_type,Layout>(
+    first,detail::multi_array::mdspan_mapping<Layout>(extents,a));
+}
+
+template <typename Element, typename Extents, typename Layout,
+          typename Accessor>
+auto make_const_array_view(
+    const std::mdspan<Element,Extents,Layout,Accessor>& m) {
+  static_assert(Extents::rank() != 0,
+                "make_const_array_view: rank 0 mdspans have no view");
+  static_assert(std::is_same_v<typename Accessor::data_handle_type,
+                               Element*>,
+                "make_const_array_view: the data handle must be a pointer");
+  BOOST_ASSERT(m.is_strided());
+
+  const std::size_t NumDims = Extents::rank();
+  boost::array<multi_array_types::size_type,NumDims> extents;
+  boost::array<multi_array_types::index,NumDims> strides;
+  for (std::size_t r = 0; r != NumDims; ++r) {
+    extents[r] = m.extent(r);
+    strides[r] = m.stride(r);
+  }
+  const std::remove_const_t<Element>* base = m.data_handle();
+  return make_const_array_view(base,extents,strides);
+}
+
+template <typename Element, typename Extents, typename Layout,
+          typename Accessor>
+auto make_array_view(const std::mdspan<Element,Extents,Layout,Accessor>& m) {
+  if constexpr (std::is_const_v<Element>) {
+    return make_const_array_view(m);
+  } else {
+    static_assert(Extents::rank() != 0,
+                  "make_array_view: rank 0 mdspans have no view");
+    static_assert(std::is_same_v<typename Accessor::data_handle_type,
+                                 Element*>,
+                  "make_array_view: the data handle must be a pointer");
+    BOOST_ASSERT(m.is_strided());
+
+    const std::size_t NumDims = Extents::rank();
+    boost::array<multi_array_types::size_type,NumDims> extents;
+    boost::array<multi_array_types::index,NumDims> strides;
+    for (std::size_t r = 0; r != NumDims; ++r) {
+      extents[r] = m.extent(r);
+      strides[r] = m.stride(r);
+    }
+    return make_array_view(m.data_handle(),extents,strides);
+  }
+}
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif // __cpp_lib_mdspan
+
+#endif
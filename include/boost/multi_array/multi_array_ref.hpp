@@ -38,6 +38,8 @@
 
 namespace boost {
 
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
 template <typename T, std::size_t NumDims,
   typename TPtr = const T*
 >
@@ -55,6 +57,7 @@ public:
   typedef typename super_type::difference_type difference_type;
   typedef typename super_type::index index;
   typedef typename super_type::extent_range extent_range;
+  typedef typename super_type::collapsed_shape_type collapsed_shape_type;
   typedef general_storage_order<NumDims> storage_order_type;
 
   // template typedefs
@@ -84,7 +87,7 @@ public:
       index_base_list_(other.index_base_list_),
       origin_offset_(other.origin_offset_),
       directional_offset_(other.directional_offset_),
-      num_elements_(other.num_elements_)  {  }
+      element_counts_(other.element_counts_)  {  }
 
   template <typename ExtentList>
   explicit const_multi_array_ref(TPtr base, const ExtentList& extents) :
@@ -131,7 +134,7 @@ public:
     InputIterator in_iter = begin;
     T* out_iter = base_;
     std::size_t copy_count=0;
-    while (in_iter != end && copy_count < num_elements_) {
+    while (in_iter != end && copy_count < num_elements()) {
       *out_iter++ = *in_iter++;
       copy_count++;      
     }
@@ -165,11 +168,14 @@ public:
   void reshape(const SizeList& extents) {
     boost::function_requires<
       CollectionConcept<SizeList> >();
-    BOOST_ASSERT(num_elements_ ==
+    BOOST_ASSERT(num_elements() ==
                  std::accumulate(extents.begin(),extents.end(),
                                  size_type(1),std::multiplies<size_type>()));
+    boost::detail::multi_array::
+      checked_num_elements(extents.begin(),NumDims);
 
     std::copy(extents.begin(),extents.end(),extent_list_.begin());
+    compute_element_counts();
     this->compute_strides(stride_list_,extent_list_,storage_);
 
     origin_offset_ =
@@ -197,7 +203,7 @@ public:
   const element* origin() const { return base_+origin_offset_; }
   const element* data() const { return base_; }
 
-  size_type num_elements() const { return num_elements_; }
+  size_type num_elements() const { return element_counts_.front(); }
 
   const index* index_bases() const {
     return index_base_list_.data();
@@ -208,8 +214,41 @@ public:
     return storage_;
   }
 
+  // Layout queries: whether the elements lie densely in memory, in any
+  // order or in C or Fortran order; the length of the runs a walk in
+  // index order makes; the dimensions left once those that walk on
+  // from one another are merged; and the number of elements from the
+  // lowest addressed element to the highest.
+  bool is_contiguous() const { return true; }
+
+  bool is_c_contiguous() const {
+    return detail::multi_array::
+      is_c_contiguous(NumDims,shape(),strides());
+  }
+
+  bool is_f_contiguous() const {
+    return detail::multi_array::
+      is_f_contiguous(NumDims,shape(),strides());
+  }
+
+  size_type contiguous_inner_extent() const {
+    return detail::multi_array::
+      contiguous_inner_extent<NumDims>(shape(),strides());
+  }
+
+  collapsed_shape_type collapsed_shape() const {
+    collapsed_shape_type result;
+    detail::multi_array::
+      collapse_in_order<NumDims>(shape(),strides(),result);
+    return result;
+  }
+
+  size_type memory_span() const { return num_elements(); }
+
   template <typename IndexList>
-  const element& operator()(IndexList indices) const {
+  typename detail::multi_array::
+    index_list_result<IndexList,const element&>::type
+  operator()(IndexList indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<const element&>(),
@@ -217,11 +256,54 @@ public:
                                       shape(),strides(),index_bases());
   }
 
+  // As operator(), but throwing std::out_of_range for an index out of
+  // range, whether or not assertions are enabled.
+  template <typename IndexList>
+  typename detail::multi_array::
+    index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::access_element_checked(boost::type<const element&>(),
+                                              indices,origin(),
+                                              shape(),strides(),index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  // A(i,j,k): the element at NumDims integral indices.
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::access_indices(boost::type<const element&>(),
+                                      origin(),shape(),strides(),index_bases(),
+                                      indices...);
+  }
+
+  // As operator()(i,j,k), never checking the indices.
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::access_indices_unchecked(boost::type<const element&>(),
+                                                origin(),strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::access_indices_checked(boost::type<const element&>(),
+                                              origin(),shape(),strides(),
+                                              index_bases(),indices...);
+  }
+#endif
+
   // Only allow const element access
   const_reference operator[](index idx) const {
     return super_type::access(boost::type<const_reference>(),
                               idx,origin(),
-                              shape(),strides(),index_bases());
+                              shape(),strides(),index_bases(),
+                              element_counts_.data() + 1);
   }
 
   // see generate_array_view in base.hpp
@@ -242,12 +324,14 @@ public:
   
   const_iterator begin() const {
     return const_iterator(*index_bases(),origin(),
-                          shape(),strides(),index_bases());
+                          shape(),strides(),index_bases(),
+                          element_counts_.data() + 1);
   }
 
   const_iterator end() const {
     return const_iterator(*index_bases()+(index)*shape(),origin(),
-                          shape(),strides(),index_bases());
+                          shape(),strides(),index_bases(),
+                          element_counts_.data() + 1);
   }
 
   const_reverse_iterator rbegin() const {
@@ -266,7 +350,7 @@ public:
     if(std::equal(extent_list_.begin(),
                   extent_list_.end(),
                   rhs.extent_list_.begin()))
-      return std::equal(begin(),end(),rhs.begin());
+      return detail::multi_array::equal_elements(*this,rhs);
     else return false;
   }
 
@@ -353,7 +437,11 @@ public:
   index_list index_base_list_;
   index origin_offset_;
   index directional_offset_;
-  size_type num_elements_;
+  // element_counts_[n]: the product of the extents of dimensions n and
+  // above, so that element_counts_[0] is num_elements() and a sub_array
+  // taken by operator[] knows its number of elements without
+  // multiplying its extents.
+  size_list element_counts_;
 
 private:
   // const_multi_array_ref cannot be assigned to (no deep copies!)
@@ -393,9 +481,7 @@ public:
     boost::detail::multi_array::
       copy_n(extents_iter,num_dimensions(),extent_list_.begin());
 
-    // Calculate the array size
-    num_elements_ = std::accumulate(extent_list_.begin(),extent_list_.end(),
-                            size_type(1),std::multiplies<size_type>());
+    compute_element_counts();
 
     this->compute_strides(stride_list_,extent_list_,storage_);
 
@@ -406,6 +492,14 @@ public:
       this->calculate_descending_dimension_offset(stride_list_,extent_list_,
                                             storage_);
   }
+
+  void compute_element_counts() {
+    boost::detail::multi_array::
+      checked_num_elements(extent_list_.begin(),NumDims);
+    size_type count = 1;
+    for (size_type n = NumDims; n != 0; --n)
+      element_counts_[n - 1] = count *= extent_list_[n - 1];
+  }
 };
 
 template <typename T, std::size_t NumDims>
@@ -474,16 +568,14 @@ public:
   // Assignment from other ConstMultiArray types.
   template <typename ConstMultiArray>
   multi_array_ref& operator=(const ConstMultiArray& other) {
-    function_requires< 
-      multi_array_concepts::
-      ConstMultiArrayConcept<ConstMultiArray,NumDims> >();
+    detail::multi_array::
+      check_const_multi_array<ConstMultiArray,NumDims>();
 
     // make sure the dimensions agree
     BOOST_ASSERT(other.num_dimensions() == this->num_dimensions());
     BOOST_ASSERT(std::equal(other.shape(),other.shape()+this->num_dimensions(),
                             this->shape()));
-    // iterator-based copy
-    std::copy(other.begin(),other.end(),this->begin());
+    detail::multi_array::copy_elements(other,*this);
     return *this;
   }
 
@@ -495,8 +587,7 @@ public:
       BOOST_ASSERT(std::equal(other.shape(),
                               other.shape()+this->num_dimensions(),
                               this->shape()));
-      // iterator-based copy
-      std::copy(other.begin(),other.end(),this->begin());
+      detail::multi_array::copy_elements(other,*this);
     }
     return *this;
   }
@@ -506,7 +597,9 @@ public:
   element* data() { return super_type::base_; }
 
   template <class IndexList>
-  element& operator()(const IndexList& indices) {
+  typename detail::multi_array::
+    index_list_result<IndexList,element&>::type
+  operator()(const IndexList& indices) {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<element&>(),
@@ -515,12 +608,54 @@ public:
                                       this->index_bases());
   }
 
+  template <class IndexList>
+  typename detail::multi_array::
+    index_list_result<IndexList,element&>::type
+  at(const IndexList& indices) {
+    return super_type::access_element_checked(boost::type<element&>(),
+                                              indices,origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,element&,Indices...>::type
+  operator()(Indices... indices) {
+    return super_type::access_indices(boost::type<element&>(),
+                                      origin(),
+                                      this->shape(),this->strides(),
+                                      this->index_bases(),indices...);
+  }
+
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,element&,Indices...>::type
+  unchecked(Indices... indices) {
+    return super_type::access_indices_unchecked(boost::type<element&>(),
+                                                origin(),this->strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,element&,Indices...>::type
+  at(Indices... indices) {
+    return super_type::access_indices_checked(boost::type<element&>(),
+                                              origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases(),indices...);
+  }
+#endif
+
 
   reference operator[](index idx) {
     return super_type::access(boost::type<reference>(),
                               idx,origin(),
                               this->shape(),this->strides(),
-                              this->index_bases());
+                              this->index_bases(),
+                              this->element_counts_.data() + 1);
   }
 
 
@@ -542,13 +677,15 @@ public:
   
   iterator begin() {
     return iterator(*this->index_bases(),origin(),this->shape(),
-                    this->strides(),this->index_bases());
+                    this->strides(),this->index_bases(),
+                    this->element_counts_.data() + 1);
   }
 
   iterator end() {
     return iterator(*this->index_bases()+(index)*this->shape(),origin(),
                     this->shape(),this->strides(),
-                    this->index_bases());
+                    this->index_bases(),
+                    this->element_counts_.data() + 1);
   }
 
   // rbegin() and rend() written naively to thwart MSVC ICE.
@@ -569,17 +706,50 @@ public:
   const element* data() const { return super_type::data(); }
 
   template <class IndexList>
-  const element& operator()(const IndexList& indices) const {
+  typename detail::multi_array::
+    index_list_result<IndexList,const element&>::type
+  operator()(const IndexList& indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::operator()(indices);
   }
 
+  template <class IndexList>
+  typename detail::multi_array::
+    index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::at(indices);
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::operator()(indices...);
+  }
+
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::unchecked(indices...);
+  }
+
+  template <typename... Indices>
+  typename detail::multi_array::
+    indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::at(indices...);
+  }
+#endif
+
   const_reference operator[](index idx) const {
     return super_type::access(boost::type<const_reference>(),
                               idx,origin(),
                               this->shape(),this->strides(),
-                              this->index_bases());
+                              this->index_bases(),
+                              this->element_counts_.data() + 1);
   }
 
   // See note attached to generate_array_view in base.hpp
@@ -617,6 +787,8 @@ protected:
 
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace boost
 
 #endif
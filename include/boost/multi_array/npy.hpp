@@ -0,0 +1,491 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_NPY_HPP
+#define BOOST_MULTI_ARRAY_NPY_HPP
+
+//
+// npy.hpp - reading and writing NumPy .npy files.
+//
+//   save_npy(os,a)      writes any array, subarray or view.  Arrays laid
+//                       out in Fortran order are written with
+//                       fortran_order True, everything else in C order.
+//   load_npy(is,a)      reads into a multi_array, which takes the file's
+//                       shape (with zero index bases), or into a
+//                       multi_array_ref, subarray or view of that shape.
+//   mapped_npy_array    a const_multi_array_ref over a memory mapped .npy
+//                       file, in the file's C or Fortran storage order;
+//                       nothing is copied.  Only available where
+//                       BOOST_MULTI_ARRAY_HAS_MMAP is defined (POSIX).
+//
+// Elements may be bool, integers and floating point numbers; the file's
+// descr must match the element type's kind and size.  Files written in
+// the other byte order are swapped by load_npy; mapped_npy_array rejects
+// them.  Errors throw std::ios_base::failure.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/collapse.hpp"
+#include "boost/multi_array/storage_order.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/config.hpp"
+#include "boost/core/no_exceptions_support.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/type_traits/alignment_of.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#if defined(BOOST_HAS_UNISTD_H)
+#  define BOOST_MULTI_ARRAY_HAS_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+static const char npy_magic[6] = { '\x93','N','U','M','P','Y' };
+
+template <std::size_t NumDims>
+struct npy_header {
+  bool swap;
+  bool fortran_order;
+  boost::array<size_type,NumDims> extents;
+
+  general_storage_order<NumDims> storage_order() const {
+    if (fortran_order)
+      return fortran_storage_order();
+    return c_storage_order();
+  }
+};
+
+template <typename T>
+std::string npy_descr() {
+  BOOST_STATIC_ASSERT(element_kind<T>::value != 'r');
+  std::ostringstream descr;
+  descr << (sizeof(T) == 1 ? '|' : host_is_little_endian() ? '<' : '>')
+        << element_kind<T>::value << sizeof(T);
+  return descr.str();
+}
+
+// The header dictionary, padded with spaces and a newline so that the
+// data starts on a 64 byte boundary, preceded by the magic string,
+// version and length.
+template <typename T, std::size_t NumDims>
+std::string npy_preamble(const size_type* extents, bool fortran_order) {
+  std::ostringstream dict;
+  dict << "{'descr': '" << npy_descr<T>() << "', 'fortran_order': "
+       << (fortran_order ? "True" : "False") << ", 'shape': (";
+  for (std::size_t n = 0; n != NumDims; ++n)
+    dict << (n == 0 ? "" : ", ") << extents[n];
+  dict << (NumDims == 1 ? ",), }" : "), }");
+
+  std::string text = dict.str();
+  // version 1.0 has a 2 byte length, version 2.0 a 4 byte length
+  std::size_t prefix = sizeof(npy_magic) + 2 + 2;
+  if (text.size() + 1 + 64 + prefix > 65535)
+    prefix = sizeof(npy_magic) + 2 + 4;
+  const std::size_t total = (prefix + text.size() + 1 + 63) / 64 * 64;
+  text.append(total - prefix - text.size() - 1,' ');
+  text += '\n';
+
+  std::string preamble(npy_magic,sizeof(npy_magic));
+  preamble += char(prefix == sizeof(npy_magic) + 4 ? 1 : 2);
+  preamble += '\0';
+  std::size_t length = text.size();
+  for (std::size_t i = sizeof(npy_magic) + 2; i != prefix; ++i) {
+    preamble += char(length & 0xff);
+    length >>= 8;
+  }
+  return preamble + text;
+}
+
+// The length of the header dictionary, given the first ten bytes of the
+// file, and the number of further length bytes to read (0 or 2).
+inline std::size_t npy_dict_length(const unsigned char* prefix,
+                                   std::size_t& extra) {
+  if (std::memcmp(prefix,npy_magic,sizeof(npy_magic)) != 0)
+    io_failure("boost::multi_array: not a .npy file");
+  const unsigned char major = prefix[6];
+  if (major < 1 || major > 3)
+    io_failure("boost::multi_array: unsupported .npy version");
+  extra = major == 1 ? 0 : 2;
+  return std::size_t(prefix[8]) | std::size_t(prefix[9]) << 8;
+}
+
+// A minimal reader for the Python literal in the header: a dictionary
+// of strings, booleans and tuples of integers.
+class npy_dict_parser {
+public:
+  explicit npy_dict_parser(const std::string& text) :
+    text_(text), pos_(0) { }
+
+  void skip_space() {
+    while (pos_ != text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n'))
+      ++pos_;
+  }
+
+  bool accept(char c) {
+    skip_space();
+    if (pos_ != text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!accept(c))
+      io_failure("boost::multi_array: malformed .npy header");
+  }
+
+  std::string string() {
+    skip_space();
+    if (pos_ == text_.size() || (text_[pos_] != '\'' && text_[pos_] != '"'))
+      io_failure("boost::multi_array: malformed .npy header");
+    const char quote = text_[pos_++];
+    const std::size_t end = text_.find(quote,pos_);
+    if (end == std::string::npos)
+      io_failure("boost::multi_array: malformed .npy header");
+    const std::string result = text_.substr(pos_,end - pos_);
+    pos_ = end + 1;
+    return result;
+  }
+
+  bool boolean() {
+    skip_space();
+    if (text_.compare(pos_,4,"True") == 0) {
+      pos_ += 4;
+      return true;
+    }
+    if (text_.compare(pos_,5,"False") == 0) {
+      pos_ += 5;
+      return false;
+    }
+    io_failure("boost::multi_array: malformed .npy header");
+    return false;
+  }
+
+  boost::uint64_t integer() {
+    skip_space();
+    const boost::uint64_t highest =
+      (std::numeric_limits<boost::uint64_t>::max)();
+    boost::uint64_t value = 0;
+    const std::size_t start = pos_;
+    for (; pos_ != text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9';
+         ++pos_) {
+      const unsigned digit = unsigned(text_[pos_] - '0');
+      if (value > (highest - digit) / 10)
+        io_failure("boost::multi_array: integer too large in .npy header");
+      value = value * 10 + digit;
+    }
+    // Python 2 era writers append L to long integers
+    if (pos_ != start && pos_ != text_.size() && text_[pos_] == 'L')
+      ++pos_;
+    if (pos_ == start)
+      io_failure("boost::multi_array: malformed .npy header");
+    return value;
+  }
+
+private:
+  const std::string& text_;
+  std::size_t pos_;
+};
+
+template <typename T, std::size_t NumDims>
+void parse_npy_header(const std::string& text, npy_header<NumDims>& header) {
+  npy_dict_parser parser(text);
+  bool have_descr = false, have_order = false, have_shape = false;
+  parser.expect('{');
+  while (!parser.accept('}')) {
+    const std::string key = parser.string();
+    parser.expect(':');
+    if (key == "descr") {
+      const std::string descr = parser.string();
+      std::ostringstream size;
+      size << sizeof(T);
+      if (descr.size() < 3 || descr[1] != element_kind<T>::value ||
+          descr.substr(2) != size.str())
+        io_failure("boost::multi_array: element type mismatch");
+      const char order = descr[0];
+      if (order != '<' && order != '>' && order != '|' && order != '=')
+        io_failure("boost::multi_array: bad byte order in .npy header");
+      header.swap = sizeof(T) != 1 &&
+        ((order == '<' && !host_is_little_endian()) ||
+         (order == '>' && host_is_little_endian()));
+      have_descr = true;
+    } else if (key == "fortran_order") {
+      header.fortran_order = parser.boolean();
+      have_order = true;
+    } else if (key == "shape") {
+      parser.expect('(');
+      boost::array<boost::uint64_t,NumDims> extents;
+      std::size_t rank = 0;
+      while (!parser.accept(')')) {
+        const boost::uint64_t extent = parser.integer();
+        if (rank == NumDims)
+          io_failure("boost::multi_array: dimensionality mismatch");
+        extents[rank++] = extent;
+        if (!parser.accept(',')) {
+          parser.expect(')');
+          break;
+        }
+      }
+      if (rank != NumDims)
+        io_failure("boost::multi_array: dimensionality mismatch");
+      // see binary_io.hpp; this covers the mapped arrays too
+      checked_element_count<T>(NumDims,extents.data());
+      for (std::size_t n = 0; n != NumDims; ++n)
+        header.extents[n] = size_type(extents[n]);
+      have_shape = true;
+    } else {
+      io_failure("boost::multi_array: unknown key in .npy header");
+    }
+    if (!parser.accept(',')) {
+      parser.expect('}');
+      break;
+    }
+  }
+  if (!have_descr || !have_order || !have_shape)
+    io_failure("boost::multi_array: incomplete .npy header");
+}
+
+template <typename T, std::size_t NumDims>
+void read_npy_header(std::istream& is, npy_header<NumDims>& header) {
+  unsigned char prefix[10];
+  read_bytes(is,prefix,sizeof(prefix));
+  std::size_t extra;
+  std::size_t length = npy_dict_length(prefix,extra);
+  if (extra != 0) {
+    unsigned char high[2];
+    read_bytes(is,high,sizeof(high));
+    length |= std::size_t(high[0]) << 16 | std::size_t(high[1]) << 24;
+  }
+  std::string text(length,' ');
+  if (length != 0)
+    read_bytes(is,&text[0],length);
+  parse_npy_header<T,NumDims>(text,header);
+}
+
+template <typename T, std::size_t NumDims>
+void save_npy_elements(std::ostream& os, const T* origin,
+                       const size_type* extents, const index* strides,
+                       const index* index_bases) {
+  // Only an array that is laid out in Fortran order, as far as the
+  // strides tell, is worth writing that way.
+  const bool fortran_order = NumDims > 1 &&
+    storage_order_from_strides<NumDims>(strides) ==
+      general_storage_order<NumDims>(fortran_storage_order());
+  const std::string preamble =
+    npy_preamble<T,NumDims>(extents,fortran_order);
+  write_bytes(os,preamble.data(),preamble.size());
+  const general_storage_order<NumDims> so = fortran_order ?
+    general_storage_order<NumDims>(fortran_storage_order()) :
+    general_storage_order<NumDims>(c_storage_order());
+  write_elements<T,NumDims>(os,so,origin,extents,strides,index_bases);
+}
+
+template <typename T, std::size_t NumDims>
+void load_npy_into(std::istream& is, T* origin, const size_type* extents,
+                   const index* strides, const index* index_bases) {
+  npy_header<NumDims> header;
+  read_npy_header<T,NumDims>(is,header);
+  if (!std::equal(header.extents.begin(),header.extents.end(),extents))
+    io_failure("boost::multi_array: shape mismatch");
+  read_elements<T,NumDims>(is,header.swap,header.storage_order(),origin,
+                           extents,strides,index_bases);
+}
+
+#ifdef BOOST_MULTI_ARRAY_HAS_MMAP
+// Owns the mapping of a .npy file; the base class of mapped_npy_array,
+// so that the file is mapped before the array reference is set up.
+template <typename T, std::size_t NumDims>
+class npy_file_mapping {
+protected:
+  explicit npy_file_mapping(const char* path) : address_(0), length_(0) {
+    const int fd = ::open(path,O_RDONLY);
+    if (fd < 0)
+      io_failure("boost::multi_array: cannot open .npy file");
+    struct stat status;
+    if (::fstat(fd,&status) != 0 || status.st_size == 0) {
+      ::close(fd);
+      io_failure("boost::multi_array: cannot map .npy file");
+    }
+    length_ = std::size_t(status.st_size);
+    address_ = ::mmap(0,length_,PROT_READ,MAP_SHARED,fd,0);
+    ::close(fd);
+    if (address_ == MAP_FAILED) {
+      address_ = 0;
+      io_failure("boost::multi_array: cannot map .npy file");
+    }
+    BOOST_TRY {
+      parse();
+    }
+    BOOST_CATCH(...) {
+      ::munmap(address_,length_);
+      BOOST_RETHROW
+    }
+    BOOST_CATCH_END
+  }
+
+  ~npy_file_mapping() { ::munmap(address_,length_); }
+
+  const T* mapped_data() const { return data_; }
+
+  npy_header<NumDims> header_;
+
+private:
+  void parse() {
+    const unsigned char* bytes = static_cast<const unsigned char*>(address_);
+    if (length_ < 10)
+      io_failure("boost::multi_array: unexpected end of .npy file");
+    std::size_t extra;
+    std::size_t length = npy_dict_length(bytes,extra);
+    std::size_t offset = 10;
+    if (extra != 0) {
+      if (length_ < 12)
+        io_failure("boost::multi_array: unexpected end of .npy file");
+      length |= std::size_t(bytes[10]) << 16 | std::size_t(bytes[11]) << 24;
+      offset = 12;
+    }
+    if (length_ - offset < length)
+      io_failure("boost::multi_array: unexpected end of .npy file");
+    const std::string text(reinterpret_cast<const char*>(bytes) + offset,
+                           length);
+    parse_npy_header<T,NumDims>(text,header_);
+    offset += length;
+
+    if (header_.swap)
+      io_failure("boost::multi_array: cannot map a .npy file of the "
+                 "other byte order");
+    if (offset % boost::alignment_of<T>::value != 0)
+      io_failure("boost::multi_array: misaligned .npy data");
+    size_type count = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      count *= header_.extents[n];
+    if ((length_ - offset) / sizeof(T) < count)
+      io_failure("boost::multi_array: unexpected end of .npy file");
+    data_ = reinterpret_cast<const T*>(bytes + offset);
+  }
+
+  // noncopyable
+  npy_file_mapping(const npy_file_mapping&);
+  npy_file_mapping& operator=(const npy_file_mapping&);
+
+  void* address_;
+  std::size_t length_;
+  const T* data_;
+};
+#endif // BOOST_MULTI_ARRAY_HAS_MMAP
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename Array>
+void save_npy(std::ostream& os, const Array& a) {
+  typedef typename Array::element element;
+  detail::multi_array::save_npy_elements<element,Array::dimensionality>(
+    os,a.origin(),a.shape(),a.strides(),a.index_bases());
+}
+
+// Loading into a multi_array gives it the file's shape, with zero index
+// bases; the array keeps its own storage order.  As with load(), a
+// failed load leaves the array as it was.
+template <typename T, std::size_t NumDims, typename Allocator>
+void load_npy(std::istream& is, multi_array<T,NumDims,Allocator>& a) {
+  detail::multi_array::npy_header<NumDims> header;
+  detail::multi_array::read_npy_header<T,NumDims>(is,header);
+
+  typedef detail::multi_array::extent_gen<NumDims> gen_type;
+  typedef typename gen_type::range range_type;
+  gen_type ranges;
+  for (std::size_t n = 0; n != NumDims; ++n)
+    ranges.ranges_[n] =
+      range_type(0,typename range_type::index(header.extents[n]));
+  multi_array<T,NumDims,Allocator> loaded(ranges,a.storage_order(),
+                                          a.get_allocator());
+  detail::multi_array::read_elements<T,NumDims>(is,header.swap,
+                                                header.storage_order(),
+                                                loaded.origin(),
+                                                loaded.shape(),
+                                                loaded.strides(),
+                                                loaded.index_bases());
+  a.swap(loaded);
+}
+
+// Loading into references, subarrays and views requires the file's shape.
+template <typename T, std::size_t NumDims>
+void load_npy(std::istream& is, multi_array_ref<T,NumDims> a) {
+  detail::multi_array::load_npy_into<T,NumDims>(is,a.origin(),a.shape(),
+                                                a.strides(),
+                                                a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load_npy(std::istream& is,
+              detail::multi_array::sub_array<T,NumDims> a) {
+  detail::multi_array::load_npy_into<T,NumDims>(is,a.origin(),a.shape(),
+                                                a.strides(),
+                                                a.index_bases());
+}
+
+template <typename T, std::size_t NumDims>
+void load_npy(std::istream& is,
+              detail::multi_array::multi_array_view<T,NumDims> a) {
+  detail::multi_array::load_npy_into<T,NumDims>(is,a.origin(),a.shape(),
+                                                a.strides(),
+                                                a.index_bases());
+}
+
+#ifdef BOOST_MULTI_ARRAY_HAS_MMAP
+//
+// mapped_npy_array
+//   A read-only array over the data of a .npy file, which stays mapped
+//   for the lifetime of the object.  It is a const_multi_array_ref and
+//   may be used, or sliced to one, wherever those are accepted.
+//
+template <typename T, std::size_t NumDims>
+class mapped_npy_array :
+    private detail::multi_array::npy_file_mapping<T,NumDims>,
+    public const_multi_array_ref<T,NumDims> {
+  typedef detail::multi_array::npy_file_mapping<T,NumDims> mapping;
+  typedef const_multi_array_ref<T,NumDims> super_type;
+public:
+  explicit mapped_npy_array(const char* path) :
+    mapping(path),
+    super_type(mapping::mapped_data(),mapping::header_.extents,
+               mapping::header_.storage_order()) { }
+
+  explicit mapped_npy_array(const std::string& path) :
+    mapping(path.c_str()),
+    super_type(mapping::mapped_data(),mapping::header_.extents,
+               mapping::header_.storage_order()) { }
+};
+#endif // BOOST_MULTI_ARRAY_HAS_MMAP
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
@@ -0,0 +1,643 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_PAGED_ARRAY_HPP
+#define BOOST_MULTI_ARRAY_PAGED_ARRAY_HPP
+
+//
+// paged_array.hpp - an array kept in a file of tiles, of which only a
+// bounded number are held in memory at a time.
+//
+//   paged_array<T,NumDims> a(path,extents,tile_extents,cache_tiles)
+//     Creates (or truncates) the file at path for an array of the given
+//     extents, divided into tiles of tile_extents, every element zero.
+//   paged_array<T,NumDims> a(path,cache_tiles)
+//     Opens a file created that way.
+//
+//   a(idx)           the element at an index list, as a proxy reference;
+//                    reading it leaves its tile clean, assigning to it
+//                    marks the tile dirty
+//   a.get(idx), a.set(idx,x)
+//   a.tile(t)        a tile_handle for the tile at position t of the tile
+//                    grid (see tile_counts()).  Its array() is a
+//                    multi_array_ref whose index bases are the indices of
+//                    the tile's first element, so indexing, slicing, views
+//                    and iterators work on the tile with array-wide
+//                    indices.  The tile is marked dirty, and stays pinned
+//                    in the cache while any copy of the handle lives.
+//   a.const_tile(t)  the same, read only, leaving the tile clean
+//   a.flush()        writes the dirty tiles back; the destructor does too
+//
+// Tiles are evicted least recently used first, dirty ones after being
+// written back.  Pinned tiles are never evicted; when every cached tile
+// is pinned no other tile can be loaded and std::length_error is thrown.
+// When a miss loads the neighbour of the previously used tile along one
+// dimension, the tile after it in that direction is announced to the
+// operating system (posix_fadvise), so that reading it overlaps work on
+// the current one.  Subarrays, views and iterators cannot span tiles, as
+// they need their elements at fixed strides in memory.
+//
+// The file holds a 4096 byte header (magic "BMPAGED", then the fields of
+// binary_io.hpp's header up to the rank, extents and tile extents)
+// followed by one tile-sized slot per tile, in row-major order of the
+// tile grid, each holding the tile's elements in row-major order.
+// I/O errors throw std::ios_base::failure, as does opening a file whose
+// extents or tile extents overflow or whose tiles run past its end.
+// paged_array is not thread safe, and is only available on POSIX
+// systems (BOOST_MULTI_ARRAY_HAS_PAGED_ARRAY).
+//
+
+#include "boost/config.hpp"
+
+#if defined(BOOST_HAS_UNISTD_H)
+
+#define BOOST_MULTI_ARRAY_HAS_PAGED_ARRAY
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/chunk_grid.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/core/no_exceptions_support.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/throw_exception.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <list>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+static const char paged_magic[8] = { 'B','M','P','A','G','E','D','\0' };
+const std::size_t paged_header_bytes = 4096;
+
+// A file descriptor with positioned, complete reads and writes.
+class tile_file {
+public:
+  tile_file() : fd_(-1) { }
+  ~tile_file() { if (fd_ >= 0) ::close(fd_); }
+
+  void open(const char* path, bool create) {
+    fd_ = ::open(path,create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR,0666);
+    if (fd_ < 0)
+      io_failure("boost::multi_array: cannot open paged array file");
+  }
+
+  void read(void* data, std::size_t size, boost::uint64_t offset) {
+    char* bytes = static_cast<char*>(data);
+    while (size != 0) {
+      const ssize_t n = ::pread(fd_,bytes,size,off_t(offset));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        io_failure("boost::multi_array: paged array read failed");
+      bytes += n;
+      size -= std::size_t(n);
+      offset += boost::uint64_t(n);
+    }
+  }
+
+  void write(const void* data, std::size_t size, boost::uint64_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size != 0) {
+      const ssize_t n = ::pwrite(fd_,bytes,size,off_t(offset));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        io_failure("boost::multi_array: paged array write failed");
+      bytes += n;
+      size -= std::size_t(n);
+      offset += boost::uint64_t(n);
+    }
+  }
+
+  boost::uint64_t size() {
+    struct stat status;
+    if (::fstat(fd_,&status) != 0)
+      io_failure("boost::multi_array: cannot size paged array file");
+    return boost::uint64_t(status.st_size);
+  }
+
+  void resize(boost::uint64_t size) {
+    if (::ftruncate(fd_,off_t(size)) != 0)
+      io_failure("boost::multi_array: cannot size paged array file");
+  }
+
+  // a hint only: the range will be read soon
+  void will_need(boost::uint64_t offset, boost::uint64_t size) {
+#ifdef POSIX_FADV_WILLNEED
+    ::posix_fadvise(fd_,off_t(offset),off_t(size),POSIX_FADV_WILLNEED);
+#else
+    (void)offset; (void)size;
+#endif
+  }
+
+private:
+  // noncopyable
+  tile_file(const tile_file&);
+  tile_file& operator=(const tile_file&);
+
+  int fd_;
+};
+
+//
+// pinned_tile
+//   A tile of a paged_array that may not be evicted while the handle, or
+//   a copy of it, exists.  ArrayRef is multi_array_ref or
+//   const_multi_array_ref.
+//
+template <typename Owner, typename ArrayRef>
+class pinned_tile {
+public:
+  pinned_tile(Owner& owner, std::size_t slot, const ArrayRef& array) :
+    owner_(&owner), slot_(slot), array_(array) { owner_->pin(slot_); }
+
+  pinned_tile(const pinned_tile& other) :
+    owner_(other.owner_), slot_(other.slot_), array_(other.array_) {
+    owner_->pin(slot_);
+  }
+
+  ~pinned_tile() { owner_->unpin(slot_); }
+
+  ArrayRef& array() { return array_; }
+  const ArrayRef& array() const { return array_; }
+
+private:
+  // Assigning a multi_array_ref copies elements; handles are not
+  // assignable to avoid the confusion.
+  pinned_tile& operator=(const pinned_tile&);
+
+  Owner* owner_;
+  std::size_t slot_;
+  ArrayRef array_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims>
+class paged_array {
+  BOOST_STATIC_ASSERT(detail::multi_array::is_bitwise_copyable<T>::value);
+public:
+  typedef T element;
+  typedef T value_type;
+  typedef multi_array_types::index index;
+  typedef multi_array_types::size_type size_type;
+  BOOST_STATIC_CONSTANT(std::size_t, dimensionality = NumDims);
+
+  typedef detail::multi_array::pinned_tile<paged_array,
+                                           multi_array_ref<T,NumDims> >
+    tile_handle;
+  typedef detail::multi_array::pinned_tile<paged_array,
+                                           const_multi_array_ref<T,NumDims> >
+    const_tile_handle;
+
+  struct cache_statistics {
+    size_type hits;        // element and tile accesses served from memory
+    size_type misses;      // tiles read from the file
+    size_type writebacks;  // dirty tiles written to the file
+    size_type prefetches;  // tiles announced ahead of a traversal
+  };
+
+  // A proxy for an element; see operator().
+  class reference {
+  public:
+    operator T() const { return array_->get(idx_); }
+    reference& operator=(const T& x) {
+      array_->set(idx_,x);
+      return *this;
+    }
+    reference& operator=(const reference& other) {
+      return *this = T(other);
+    }
+  private:
+    friend class paged_array;
+    reference(paged_array& a, const boost::array<index,NumDims>& idx) :
+      array_(&a), idx_(idx) { }
+
+    paged_array* array_;
+    boost::array<index,NumDims> idx_;
+  };
+
+  template <typename ExtentList, typename TileExtentList>
+  paged_array(const char* path, const ExtentList& extents,
+              const TileExtentList& tile_extents, size_type cache_tiles) {
+    boost::function_requires<
+      CollectionConcept<ExtentList> >();
+    boost::function_requires<
+      CollectionConcept<TileExtentList> >();
+    BOOST_ASSERT(extents.size() == NumDims &&
+                 tile_extents.size() == NumDims);
+    std::copy(extents.begin(),extents.end(),grid_.extents.begin());
+    std::copy(tile_extents.begin(),tile_extents.end(),
+              grid_.chunk_extents.begin());
+    detail::multi_array::checked_num_elements(grid_.extents.begin(),NumDims);
+    detail::multi_array::
+      checked_num_elements(grid_.chunk_extents.begin(),NumDims);
+    init(cache_tiles);
+
+    file_.open(path,true);
+    write_header();
+    file_.resize(tile_offset(grid_.num_chunks));
+  }
+
+  paged_array(const char* path, size_type cache_tiles) {
+    file_.open(path,false);
+    read_header();
+    init(cache_tiles);
+    // Every tile must lie within the file, so that no read runs short.
+    const boost::uint64_t tile_bytes =
+      boost::uint64_t(tile_elements_) * sizeof(T);
+    const boost::uint64_t length = file_.size();
+    if (length < detail::multi_array::paged_header_bytes ||
+        grid_.num_chunks >
+          (length - detail::multi_array::paged_header_bytes) / tile_bytes)
+      detail::multi_array::io_failure(
+        "boost::multi_array: paged array file too short");
+  }
+
+  ~paged_array() {
+    BOOST_ASSERT(pinned_ == 0);
+    BOOST_TRY {
+      flush();
+    }
+    BOOST_CATCH(...) {
+    }
+    BOOST_CATCH_END
+  }
+
+  const size_type* shape() const { return grid_.extents.data(); }
+  const size_type* tile_shape() const { return grid_.chunk_extents.data(); }
+  const size_type* tile_counts() const { return grid_.counts.data(); }
+  size_type num_tiles() const { return grid_.num_chunks; }
+  size_type num_dimensions() const { return NumDims; }
+
+  size_type num_elements() const {
+    size_type count = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      count *= grid_.extents[n];
+    return count;
+  }
+
+  size_type cache_tiles() const { return capacity_; }
+  const cache_statistics& statistics() const { return statistics_; }
+
+  template <typename IndexList>
+  reference operator()(const IndexList& indices) {
+    boost::function_requires<
+      CollectionConcept<IndexList> >();
+    boost::array<index,NumDims> idx;
+    std::copy(indices.begin(),indices.end(),idx.begin());
+    return reference(*this,idx);
+  }
+
+  template <typename IndexList>
+  element get(const IndexList& indices) {
+    return element_at(indices.begin(),false);
+  }
+
+  template <typename IndexList>
+  void set(const IndexList& indices, const element& x) {
+    element_at(indices.begin(),true) = x;
+  }
+
+  template <typename IndexList>
+  tile_handle tile(const IndexList& position) {
+    const std::size_t s = acquire(tile_id(position.begin()));
+    slots_[s].dirty = true;
+    return tile_handle(*this,s,
+      multi_array_ref<T,NumDims>(&slots_[s].data[0],tile_ranges(s)));
+  }
+
+  template <typename IndexList>
+  const_tile_handle const_tile(const IndexList& position) {
+    const std::size_t s = acquire(tile_id(position.begin()));
+    return const_tile_handle(*this,s,
+      const_multi_array_ref<T,NumDims>(&slots_[s].data[0],tile_ranges(s)));
+  }
+
+  void flush() {
+    for (std::size_t s = 0; s != slots_.size(); ++s)
+      write_back(s);
+  }
+
+private:
+  friend class detail::multi_array::pinned_tile<paged_array,
+                                                multi_array_ref<T,NumDims> >;
+  friend class detail::multi_array::pinned_tile<paged_array,
+                                          const_multi_array_ref<T,NumDims> >;
+
+  typedef std::list<std::size_t> lru_list;
+
+  struct slot {
+    size_type tile;
+    bool dirty;
+    std::size_t pins;
+    boost::array<index,NumDims> start;
+    boost::array<size_type,NumDims> extents;
+    boost::array<index,NumDims> strides;
+    std::vector<T> data;
+    typename lru_list::iterator lru;
+  };
+
+  static size_type no_tile() { return size_type(-1); }
+
+  void init(size_type cache_tiles) {
+    BOOST_ASSERT(cache_tiles != 0);
+    grid_.init();
+    tile_elements_ = 1;
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      BOOST_ASSERT(grid_.chunk_extents[n] != 0);
+      tile_elements_ *= grid_.chunk_extents[n];
+    }
+    capacity_ = cache_tiles;
+    // Slots never move once created: pinned tiles hand out pointers.
+    slots_.reserve(capacity_);
+    last_tile_ = no_tile();
+    last_slot_ = 0;
+    pinned_ = 0;
+    statistics_.hits = statistics_.misses = 0;
+    statistics_.writebacks = statistics_.prefetches = 0;
+  }
+
+  boost::uint64_t tile_offset(size_type id) const {
+    return detail::multi_array::paged_header_bytes +
+      boost::uint64_t(id) * tile_elements_ * sizeof(T);
+  }
+
+  void write_header() {
+    using detail::multi_array::write_field;
+    std::ostringstream header;
+    detail::multi_array::write_bytes(header,detail::multi_array::paged_magic,
+      sizeof(detail::multi_array::paged_magic));
+    const unsigned char prefix[4] = {
+      1, static_cast<unsigned char>(
+        detail::multi_array::host_is_little_endian() ? 1 : 2),
+      static_cast<unsigned char>(detail::multi_array::element_kind<T>::value),
+      static_cast<unsigned char>(sizeof(T))
+    };
+    detail::multi_array::write_bytes(header,prefix,sizeof(prefix));
+    write_field(header,boost::uint32_t(NumDims));
+    for (std::size_t n = 0; n != NumDims; ++n)
+      write_field(header,boost::uint64_t(grid_.extents[n]));
+    for (std::size_t n = 0; n != NumDims; ++n)
+      write_field(header,boost::uint64_t(grid_.chunk_extents[n]));
+    std::string bytes = header.str();
+    bytes.resize(detail::multi_array::paged_header_bytes,'\0');
+    file_.write(bytes.data(),bytes.size(),0);
+  }
+
+  void read_header() {
+    using detail::multi_array::io_failure;
+    using detail::multi_array::read_field;
+    std::string bytes(detail::multi_array::paged_header_bytes,'\0');
+    file_.read(&bytes[0],bytes.size(),0);
+    std::istringstream header(bytes);
+    char magic[sizeof(detail::multi_array::paged_magic)];
+    detail::multi_array::read_bytes(header,magic,sizeof(magic));
+    if (std::memcmp(magic,detail::multi_array::paged_magic,
+                    sizeof(magic)) != 0)
+      io_failure("boost::multi_array: not a paged array file");
+    unsigned char prefix[4];
+    detail::multi_array::read_bytes(header,prefix,sizeof(prefix));
+    if (prefix[0] != 1)
+      io_failure("boost::multi_array: unsupported format version");
+    if (prefix[1] != (detail::multi_array::host_is_little_endian() ? 1 : 2))
+      io_failure("boost::multi_array: paged array file of the other "
+                 "byte order");
+    if (prefix[2] != static_cast<unsigned char>(
+          detail::multi_array::element_kind<T>::value) ||
+        prefix[3] != sizeof(T))
+      io_failure("boost::multi_array: element type mismatch");
+    if (read_field<boost::uint32_t>(header,false) != NumDims)
+      io_failure("boost::multi_array: dimensionality mismatch");
+    // Checked before they size the grid and the cache slots: neither the
+    // elements of the array nor those of a tile may overflow.
+    boost::array<boost::uint64_t,NumDims> extents, tile_extents;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      extents[n] = read_field<boost::uint64_t>(header,false);
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      tile_extents[n] = read_field<boost::uint64_t>(header,false);
+      if (tile_extents[n] == 0)
+        io_failure("boost::multi_array: bad tile extents");
+    }
+    detail::multi_array::checked_element_count<T>(NumDims,extents.data());
+    detail::multi_array::
+      checked_element_count<T>(NumDims,tile_extents.data());
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      grid_.extents[n] = size_type(extents[n]);
+      grid_.chunk_extents[n] = size_type(tile_extents[n]);
+    }
+  }
+
+  template <typename IndexIter>
+  size_type tile_id(IndexIter position) const {
+    size_type id = 0;
+    for (std::size_t n = 0; n != NumDims; ++n, ++position) {
+      BOOST_ASSERT(size_type(*position) < grid_.counts[n]);
+      id = id * grid_.counts[n] + size_type(*position);
+    }
+    return id;
+  }
+
+  detail::multi_array::extent_gen<NumDims> tile_ranges(std::size_t s) const {
+    typedef typename detail::multi_array::extent_gen<NumDims>::range range;
+    detail::multi_array::extent_gen<NumDims> ranges;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      ranges.ranges_[n] = range(slots_[s].start[n],
+                                slots_[s].start[n] +
+                                  index(slots_[s].extents[n]));
+    return ranges;
+  }
+
+  template <typename IndexIter>
+  T& element_at(IndexIter indices, bool dirty) {
+    boost::array<index,NumDims> idx;
+    for (std::size_t n = 0; n != NumDims; ++n, ++indices) {
+      idx[n] = *indices;
+      BOOST_ASSERT(idx[n] >= 0 && size_type(idx[n]) < grid_.extents[n]);
+    }
+    slot& s = slots_[acquire(grid_.chunk_of(idx.begin()))];
+    index offset = 0;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      offset += (idx[n] - s.start[n]) * s.strides[n];
+    if (dirty)
+      s.dirty = true;
+    return s.data[std::size_t(offset)];
+  }
+
+  // The cache slot holding tile id, loading it if need be.
+  std::size_t acquire(size_type id) {
+    if (id == last_tile_) {
+      ++statistics_.hits;
+      return last_slot_;
+    }
+    std::size_t s;
+    const typename std::map<size_type,std::size_t>::iterator found =
+      resident_.find(id);
+    if (found != resident_.end()) {
+      ++statistics_.hits;
+      s = found->second;
+      lru_.splice(lru_.begin(),lru_,slots_[s].lru);
+    } else {
+      ++statistics_.misses;
+      const size_type previous = last_tile_;
+      s = evict();
+      load(s,id);
+      prefetch_after(previous,id);
+    }
+    last_tile_ = id;
+    last_slot_ = s;
+    return s;
+  }
+
+  // A free slot, at the front of the LRU list.
+  std::size_t evict() {
+    if (slots_.size() != capacity_) {
+      slots_.push_back(slot());
+      const std::size_t s = slots_.size() - 1;
+      slots_[s].tile = no_tile();
+      slots_[s].dirty = false;
+      slots_[s].pins = 0;
+      slots_[s].data.resize(tile_elements_);
+      lru_.push_front(s);
+      slots_[s].lru = lru_.begin();
+      return s;
+    }
+    for (typename lru_list::reverse_iterator i = lru_.rbegin();
+         i != lru_.rend(); ++i) {
+      const std::size_t s = *i;
+      if (slots_[s].pins != 0)
+        continue;
+      write_back(s);
+      if (slots_[s].tile != no_tile())
+        resident_.erase(slots_[s].tile);
+      if (last_slot_ == s)
+        last_tile_ = no_tile();
+      slots_[s].tile = no_tile();
+      lru_.splice(lru_.begin(),lru_,slots_[s].lru);
+      return s;
+    }
+    boost::throw_exception(std::length_error(
+      "boost::multi_array: every cached tile is pinned"));
+    return 0;
+  }
+
+  void load(std::size_t s, size_type id) {
+    slot& sl = slots_[s];
+    grid_.chunk(id,sl.start.data(),sl.extents.data());
+    index stride = 1;
+    for (std::size_t n = NumDims; n != 0; --n) {
+      sl.strides[n-1] = stride;
+      stride *= index(sl.extents[n-1]);
+    }
+    file_.read(&sl.data[0],std::size_t(stride) * sizeof(T),tile_offset(id));
+    sl.tile = id;
+    sl.dirty = false;
+    resident_[id] = s;
+  }
+
+  void write_back(std::size_t s) {
+    slot& sl = slots_[s];
+    if (!sl.dirty || sl.tile == no_tile())
+      return;
+    size_type count = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      count *= sl.extents[n];
+    file_.write(&sl.data[0],count * sizeof(T),tile_offset(sl.tile));
+    sl.dirty = false;
+    ++statistics_.writebacks;
+  }
+
+  // If id is the neighbour of the previously used tile along a single
+  // dimension, announces the next tile in the same direction.
+  void prefetch_after(size_type previous, size_type id) {
+    if (previous == no_tile())
+      return;
+    size_type current = id;
+    size_type grid_stride = 1, step = 0;
+    std::size_t moved = 0;
+    bool forward = true, at_edge = false;
+    for (std::size_t n = NumDims; n != 0; --n) {
+      const size_type count = grid_.counts[n-1];
+      const size_type c = current % count, p = previous % count;
+      current /= count;
+      previous /= count;
+      if (c != p) {
+        if (c + 1 != p && p + 1 != c)
+          return;
+        ++moved;
+        forward = c > p;
+        at_edge = forward ? c + 1 == count : c == 0;
+        step = grid_stride;
+      }
+      grid_stride *= count;
+    }
+    if (moved != 1 || at_edge)
+      return;
+    const size_type next = forward ? id + step : id - step;
+    if (resident_.find(next) != resident_.end())
+      return;
+    file_.will_need(tile_offset(next),
+                    boost::uint64_t(tile_elements_) * sizeof(T));
+    ++statistics_.prefetches;
+  }
+
+  void pin(std::size_t s) {
+    ++slots_[s].pins;
+    ++pinned_;
+  }
+
+  void unpin(std::size_t s) {
+    BOOST_ASSERT(slots_[s].pins != 0);
+    --slots_[s].pins;
+    --pinned_;
+  }
+
+  // noncopyable
+  paged_array(const paged_array&);
+  paged_array& operator=(const paged_array&);
+
+  detail::multi_array::tile_file file_;
+  detail::multi_array::chunk_grid<NumDims> grid_;
+  size_type tile_elements_;
+  size_type capacity_;
+  std::vector<slot> slots_;
+  lru_list lru_;
+  std::map<size_type,std::size_t> resident_;
+  size_type last_tile_;
+  std::size_t last_slot_;
+  std::size_t pinned_;
+  cache_statistics statistics_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif // BOOST_HAS_UNISTD_H
+
+#endif
@@ -0,0 +1,315 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_SHARED_MEMORY_ARRAY_HPP
+#define BOOST_MULTI_ARRAY_SHARED_MEMORY_ARRAY_HPP
+
+//
+// shared_memory_array.hpp - an array in a named POSIX shared memory
+// segment, which other processes on the same machine can open and use
+// without copying.
+//
+//   shared_memory_array<T,NumDims> a(name,extents[,storage_order])
+//   shared_memory_array<T,NumDims> a(name,extents[ranges][,storage_order])
+//     Creates the segment (shm_open), which must not exist yet, for an
+//     array of the given shape, every element zero.
+//   shared_memory_array<T,NumDims> a(name)
+//     Opens a segment created that way, taking the shape, index bases
+//     and storage order from it.
+//
+//   a is a multi_array_ref<T,NumDims> over the segment's elements, so it
+//   can be indexed, sliced, viewed and assigned to (a = frame copies the
+//   elements of frame in), and bound to a multi_array_ref.
+//
+//   a.sequence()       a counter shared by everyone with the segment open:
+//                      even while the array is stable, odd while it is
+//                      being updated.  A reader that sees the value
+//                      change knows there is a new frame, and one that
+//                      reads the same even value before and after a copy
+//                      knows that the copy is consistent.
+//   a.begin_update(), a.end_update()
+//                      bracket a writer's changes to the elements,
+//                      advancing the sequence by one each
+//   shared_memory_array<T,NumDims>::remove(name)
+//                      removes the name (shm_unlink); the segment lives
+//                      on until every process has closed it
+//
+// The segment holds a 4096 byte header, then the elements.  The header
+// starts with the sequence counter, and at byte 64 holds the header
+// written by save() (see binary_io.hpp), which describes the element
+// type, shape, index bases and storage order; opening the segment as
+// the wrong array type throws.  The destructor unmaps the segment but
+// does not remove its name.  A segment may be opened only once its
+// creator's constructor has returned.  Errors throw
+// std::ios_base::failure, except that a shape too large for the index
+// type or for memory throws std::length_error before any segment is
+// created.
+//
+// Elements are shared as raw memory, so T must be bitwise copyable.
+// The class needs POSIX shared memory and C++11 atomics, that are
+// lock-free for 64-bit integers, and is only available where those are
+// (BOOST_MULTI_ARRAY_HAS_SHARED_MEMORY_ARRAY).
+//
+
+#include "boost/config.hpp"
+
+#if defined(BOOST_HAS_UNISTD_H) && !defined(BOOST_NO_CXX11_HDR_ATOMIC)
+
+#define BOOST_MULTI_ARRAY_HAS_SHARED_MEMORY_ARRAY
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/core/no_exceptions_support.hpp"
+#include "boost/cstdint.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/throw_exception.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+const std::size_t shared_header_bytes = 4096;
+const std::size_t shared_description_offset = 64;
+
+typedef std::atomic<boost::uint64_t> shared_sequence;
+
+// Owns the mapping of a shared memory segment; the base class of
+// shared_memory_array, so that the segment is mapped before the array
+// reference is set up.
+template <typename T, std::size_t NumDims>
+class shared_memory_segment {
+protected:
+  template <typename ExtentList>
+  shared_memory_segment(const std::string& name, const ExtentList& extents,
+                        const general_storage_order<NumDims>& so) {
+    std::copy(extents.begin(),extents.end(),header_.extents.begin());
+    std::fill(header_.index_bases.begin(),header_.index_bases.end(),0);
+    create(name,so);
+  }
+
+  shared_memory_segment(const std::string& name,
+                        const extent_gen<NumDims>& ranges,
+                        const general_storage_order<NumDims>& so) {
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      header_.extents[n] = ranges.ranges_[n].size();
+      header_.index_bases[n] = ranges.ranges_[n].start();
+    }
+    create(name,so);
+  }
+
+  explicit shared_memory_segment(const std::string& name) {
+    const int fd = ::shm_open(name.c_str(),O_RDWR,0);
+    if (fd < 0)
+      io_failure("boost::multi_array: cannot open shared memory segment");
+    struct stat status;
+    if (::fstat(fd,&status) != 0 ||
+        std::size_t(status.st_size) < shared_header_bytes) {
+      ::close(fd);
+      io_failure("boost::multi_array: not a shared array segment");
+    }
+    map(fd,std::size_t(status.st_size));
+    BOOST_TRY {
+      std::istringstream description(std::string(
+        static_cast<const char*>(address_) + shared_description_offset,
+        shared_header_bytes - shared_description_offset));
+      read_binary_header<T,NumDims>(description,header_);
+      if (header_.swap)
+        io_failure("boost::multi_array: shared array of the other byte "
+                   "order");
+      if ((length_ - shared_header_bytes) / sizeof(T) < num_elements())
+        io_failure("boost::multi_array: shared array segment too short");
+    }
+    BOOST_CATCH(...) {
+      ::munmap(address_,length_);
+      BOOST_RETHROW
+    }
+    BOOST_CATCH_END
+  }
+
+  ~shared_memory_segment() { ::munmap(address_,length_); }
+
+  T* mapped_data() const {
+    return reinterpret_cast<T*>(static_cast<char*>(address_) +
+                                shared_header_bytes);
+  }
+
+  shared_sequence* sequence_counter() const {
+    BOOST_ASSERT(static_cast<shared_sequence*>(address_)->is_lock_free());
+    return static_cast<shared_sequence*>(address_);
+  }
+
+  binary_header<NumDims> header_;
+
+private:
+  size_type num_elements() const {
+    size_type count = 1;
+    for (std::size_t n = 0; n != NumDims; ++n)
+      count *= header_.extents[n];
+    return count;
+  }
+
+  void create(const std::string& name,
+              const general_storage_order<NumDims>& so) {
+    // The segment's length must fit std::size_t as well as the count
+    // fitting index; checked before a segment exists to be cleaned up.
+    const size_type count =
+      checked_num_elements(header_.extents.begin(),NumDims);
+    if (count > ((std::numeric_limits<std::size_t>::max)() -
+                 shared_header_bytes) / sizeof(T))
+      boost::throw_exception(std::length_error(
+        "boost::multi_array: shared array too large"));
+
+    for (std::size_t n = 0; n != NumDims; ++n) {
+      header_.ordering[n] = so.ordering(n);
+      header_.ascending[n] = so.ascending(n);
+    }
+    header_.swap = false;
+
+    std::ostringstream description;
+    write_binary_header<T,NumDims>(description,header_.extents.data(),
+                                   header_.index_bases.data(),so);
+    const std::string bytes = description.str();
+    BOOST_ASSERT(bytes.size() <=
+                 shared_header_bytes - shared_description_offset);
+
+    const int fd = ::shm_open(name.c_str(),O_RDWR | O_CREAT | O_EXCL,0666);
+    if (fd < 0)
+      io_failure("boost::multi_array: cannot create shared memory segment");
+    const std::size_t length = shared_header_bytes + count * sizeof(T);
+    if (::ftruncate(fd,off_t(length)) != 0) {
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      io_failure("boost::multi_array: cannot size shared memory segment");
+    }
+    BOOST_TRY {
+      map(fd,length);
+    }
+    BOOST_CATCH(...) {
+      ::shm_unlink(name.c_str());
+      BOOST_RETHROW
+    }
+    BOOST_CATCH_END
+
+    // The segment starts zeroed, so the elements and counter are zero.
+    new (address_) shared_sequence(0);
+    std::copy(bytes.begin(),bytes.end(),
+              static_cast<char*>(address_) + shared_description_offset);
+  }
+
+  // maps and closes fd
+  void map(int fd, std::size_t length) {
+    length_ = length;
+    address_ = ::mmap(0,length_,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+    ::close(fd);
+    if (address_ == MAP_FAILED)
+      io_failure("boost::multi_array: cannot map shared memory segment");
+  }
+
+  // noncopyable
+  shared_memory_segment(const shared_memory_segment&);
+  shared_memory_segment& operator=(const shared_memory_segment&);
+
+  void* address_;
+  std::size_t length_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims>
+class shared_memory_array :
+    private detail::multi_array::shared_memory_segment<T,NumDims>,
+    public multi_array_ref<T,NumDims> {
+  typedef detail::multi_array::shared_memory_segment<T,NumDims> segment;
+  typedef multi_array_ref<T,NumDims> super_type;
+
+  BOOST_STATIC_ASSERT(
+    detail::multi_array::is_bitwise_copyable<T>::value);
+  BOOST_STATIC_ASSERT(sizeof(T) <=
+                      detail::multi_array::shared_header_bytes);
+public:
+  typedef typename super_type::storage_order_type storage_order_type;
+  typedef boost::uint64_t sequence_type;
+
+  template <typename ExtentList>
+  shared_memory_array(const std::string& name, const ExtentList& extents,
+                      const storage_order_type& so = c_storage_order()) :
+    segment(name,extents,so),
+    super_type(segment::mapped_data(),segment::header_.storage_order(),
+               segment::header_.index_bases.data(),
+               segment::header_.extents.data()) {
+    boost::function_requires<
+      CollectionConcept<ExtentList> >();
+  }
+
+  shared_memory_array(const std::string& name,
+                      const detail::multi_array::extent_gen<NumDims>& ranges,
+                      const storage_order_type& so = c_storage_order()) :
+    segment(name,ranges,so),
+    super_type(segment::mapped_data(),segment::header_.storage_order(),
+               segment::header_.index_bases.data(),
+               segment::header_.extents.data()) { }
+
+  explicit shared_memory_array(const std::string& name) :
+    segment(name),
+    super_type(segment::mapped_data(),segment::header_.storage_order(),
+               segment::header_.index_bases.data(),
+               segment::header_.extents.data()) { }
+
+  // Assignment copies elements in, as for multi_array_ref.
+  template <typename ConstMultiArray>
+  shared_memory_array& operator=(const ConstMultiArray& other) {
+    super_type::operator=(other);
+    return *this;
+  }
+
+  sequence_type sequence() const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return segment::sequence_counter()->load(std::memory_order_acquire);
+  }
+
+  void begin_update() {
+    segment::sequence_counter()->fetch_add(1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void end_update() {
+    segment::sequence_counter()->fetch_add(1,std::memory_order_release);
+  }
+
+  static void remove(const std::string& name) {
+    ::shm_unlink(name.c_str());
+  }
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif // BOOST_HAS_UNISTD_H && !BOOST_NO_CXX11_HDR_ATOMIC
+
+#endif
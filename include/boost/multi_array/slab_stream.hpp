@@ -0,0 +1,428 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_SLAB_STREAM_HPP
+#define BOOST_MULTI_ARRAY_SLAB_STREAM_HPP
+
+//
+// slab_stream.hpp - streaming arrays too large for memory through a
+// computation one slab (a range of indices along the first, slowest
+// dimension) at a time, with the I/O for the next slab overlapped with
+// the work on the current one.
+//
+//   slab_reader<T,NumDims> r(is,slab_extent,halo)
+//     Reads a stream written by save() (see binary_io.hpp) from an array
+//     in C storage order.  A second constructor takes the extents of a
+//     raw stream of elements in C order instead.
+//   while (r.next()) { ... r.slab() ... }
+//     slab() is a const_multi_array_ref over slab_extent indices along
+//     the first dimension (fewer in the last slab) plus up to `halo`
+//     further indices on either side, for stencils; interior() is the
+//     range of first indices the slab itself covers.  The index bases
+//     of slab() are the array's, so elements keep their indices.
+//
+//   slab_writer<T,NumDims> w(os,extents,slab_extent)
+//   while (w.next()) { ... fill w.slab() ... }
+//     The writing counterpart, producing a stream that load() and
+//     slab_reader accept.  The stream is complete once next() has
+//     returned false.
+//
+// Each side has two slab buffers: while the caller works on one, the
+// other is read or written on a background thread where
+// BOOST_MULTI_ARRAY_HAS_THREADS is defined (see threads.hpp), and
+// synchronously in next() otherwise.  Halo indices shared with the
+// previous slab are copied rather than read again.  A slab is valid
+// until the following call to next().  I/O errors, including those of
+// the background thread, are thrown from next() as
+// std::ios_base::failure.
+//
+
+#include "boost/multi_array.hpp"
+#include "boost/multi_array/binary_io.hpp"
+#include "boost/multi_array/threads.hpp"
+#include "boost/multi_array/types.hpp"
+#include "boost/array.hpp"
+#include "boost/assert.hpp"
+#include "boost/core/enable_if.hpp"
+#include "boost/core/no_exceptions_support.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/type_traits/is_integral.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace boost {
+namespace detail {
+namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// background_job
+//   Runs one member function call of Owner at a time: on a thread of its
+//   own where threads are available, and otherwise when the result is
+//   waited for.  wait() rethrows whatever the call threw.
+//
+template <typename Owner>
+class background_job {
+public:
+  typedef void (Owner::*function)(std::size_t, size_type);
+
+  background_job() : pending_(false) { }
+  ~background_job() { discard(); }
+
+  void start(Owner* owner, function f, std::size_t buffer, size_type slab) {
+    BOOST_ASSERT(!pending_);
+    owner_ = owner;
+    function_ = f;
+    buffer_ = buffer;
+    slab_ = slab;
+    pending_ = true;
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    thread_ = std::thread(&background_job::run,this);
+#endif
+  }
+
+  void wait() {
+    if (!pending_)
+      return;
+    pending_ = false;
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    thread_.join();
+    if (error_) {
+      std::exception_ptr error = error_;
+      error_ = std::exception_ptr();
+      std::rethrow_exception(error);
+    }
+#else
+    (owner_->*function_)(buffer_,slab_);
+#endif
+  }
+
+  // waits without reporting errors, for destructors
+  void discard() {
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+    if (pending_)
+      thread_.join();
+    error_ = std::exception_ptr();
+#endif
+    pending_ = false;
+  }
+
+private:
+#ifdef BOOST_MULTI_ARRAY_HAS_THREADS
+  void run() {
+    BOOST_TRY {
+      (owner_->*function_)(buffer_,slab_);
+    }
+    BOOST_CATCH(...) {
+      error_ = std::current_exception();
+    }
+    BOOST_CATCH_END
+  }
+
+  std::thread thread_;
+  std::exception_ptr error_;
+#endif
+
+  // noncopyable
+  background_job(const background_job&);
+  background_job& operator=(const background_job&);
+
+  Owner* owner_;
+  function function_;
+  std::size_t buffer_;
+  size_type slab_;
+  bool pending_;
+};
+
+// What is common to the reader and the writer: the array's shape, the
+// division into slabs and the two buffers.
+template <typename T, std::size_t NumDims>
+class slab_stream_base {
+public:
+  typedef multi_array_types::index index;
+  typedef multi_array_types::size_type size_type;
+  typedef multi_array_types::extent_range extent_range;
+
+  const size_type* shape() const { return extents_.data(); }
+  const index* index_bases() const { return index_bases_.data(); }
+  size_type num_slabs() const { return num_slabs_; }
+
+  // the first indices the current slab covers, without its halo
+  extent_range interior() const {
+    const index begin = index(slab_ * slab_extent_);
+    const index end =
+      index((std::min)(extents_[0],(slab_ + 1) * slab_extent_));
+    return extent_range(index_bases_[0] + begin,index_bases_[0] + end);
+  }
+
+protected:
+  slab_stream_base() : slab_(0) { }
+
+  template <typename ExtentIter, typename BaseIter>
+  void init(ExtentIter extents, BaseIter bases, size_type slab_extent,
+            size_type halo) {
+    BOOST_ASSERT(slab_extent != 0);
+    std::copy(extents,extents + NumDims,extents_.begin());
+    std::copy(bases,bases + NumDims,index_bases_.begin());
+    slab_extent_ = slab_extent;
+    halo_ = halo;
+    num_slabs_ = (extents_[0] + slab_extent - 1) / slab_extent;
+    row_elements_ = 1;
+    for (std::size_t n = 1; n != NumDims; ++n)
+      row_elements_ *= extents_[n];
+    const size_type rows = (std::min)(extents_[0],slab_extent + 2 * halo);
+    for (std::size_t b = 0; b != 2; ++b) {
+      buffers_[b].resize(rows * row_elements_);
+      begin_[b] = end_[b] = 0;
+    }
+  }
+
+  // the rows, halo included, that slab s covers
+  void rows(size_type s, size_type& begin, size_type& end) const {
+    begin = s * slab_extent_;
+    end = (std::min)(extents_[0],begin + slab_extent_ + halo_);
+    begin = begin < halo_ ? 0 : begin - halo_;
+  }
+
+  detail::multi_array::extent_gen<NumDims> ranges(std::size_t b) const {
+    typedef typename detail::multi_array::extent_gen<NumDims>::range range;
+    detail::multi_array::extent_gen<NumDims> result;
+    result.ranges_[0] = range(index_bases_[0] + index(begin_[b]),
+                              index_bases_[0] + index(end_[b]));
+    for (std::size_t n = 1; n != NumDims; ++n)
+      result.ranges_[n] = range(index_bases_[n],
+                                index_bases_[n] + index(extents_[n]));
+    return result;
+  }
+
+  T* row(std::size_t b, size_type r) {
+    return buffers_[b].empty() ? 0 :
+      &buffers_[b][0] + (r - begin_[b]) * row_elements_;
+  }
+
+  boost::array<size_type,NumDims> extents_;
+  boost::array<index,NumDims> index_bases_;
+  size_type slab_extent_;
+  size_type halo_;
+  size_type num_slabs_;
+  size_type row_elements_;
+  std::vector<T> buffers_[2];
+  size_type begin_[2];
+  size_type end_[2];
+  std::size_t current_;
+  size_type slab_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace multi_array
+} // namespace detail
+
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+template <typename T, std::size_t NumDims>
+class slab_reader : public detail::multi_array::slab_stream_base<T,NumDims> {
+  BOOST_STATIC_ASSERT(detail::multi_array::is_bitwise_copyable<T>::value);
+  typedef detail::multi_array::slab_stream_base<T,NumDims> super_type;
+public:
+  typedef typename super_type::index index;
+  typedef typename super_type::size_type size_type;
+
+  // a stream written by save()
+  slab_reader(std::istream& is, size_type slab_extent, size_type halo = 0) :
+    is_(is), started_(false), rows_read_(0) {
+    detail::multi_array::binary_header<NumDims> header;
+    detail::multi_array::read_binary_header<T,NumDims>(is,header);
+    if (!(header.storage_order() ==
+          general_storage_order<NumDims>(c_storage_order())))
+      detail::multi_array::io_failure(
+        "boost::multi_array: slab streaming needs C storage order");
+    swap_ = header.swap;
+    this->init(header.extents.begin(),header.index_bases.begin(),
+               slab_extent,halo);
+  }
+
+  // a raw stream of elements in C order, with zero index bases
+  template <typename ExtentList>
+  slab_reader(std::istream& is, const ExtentList& extents,
+              size_type slab_extent, size_type halo = 0,
+              typename disable_if<is_integral<ExtentList> >::type* = 0) :
+    is_(is), swap_(false), started_(false), rows_read_(0) {
+    boost::function_requires<
+      CollectionConcept<ExtentList> >();
+    BOOST_ASSERT(extents.size() == NumDims);
+    boost::array<index,NumDims> bases;
+    bases.assign(0);
+    this->init(extents.begin(),bases.begin(),slab_extent,halo);
+  }
+
+  ~slab_reader() { job_.discard(); }
+
+  // Moves to the next slab; false once every slab has been read.
+  bool next() {
+    if (!started_) {
+      started_ = true;
+      if (this->num_slabs_ == 0)
+        return false;
+      this->current_ = 0;
+      this->slab_ = 0;
+      fill(0,0);
+    } else {
+      if (this->slab_ + 1 >= this->num_slabs_) {
+        job_.wait();
+        this->slab_ = this->num_slabs_;
+        return false;
+      }
+      job_.wait();
+      this->current_ = 1 - this->current_;
+      ++this->slab_;
+    }
+    if (this->slab_ + 1 < this->num_slabs_)
+      job_.start(this,&slab_reader::fill,1 - this->current_,this->slab_ + 1);
+    return true;
+  }
+
+  const_multi_array_ref<T,NumDims> slab() const {
+    BOOST_ASSERT(started_ && this->slab_ < this->num_slabs_);
+    const std::size_t b = this->current_;
+    return const_multi_array_ref<T,NumDims>(
+      this->buffers_[b].empty() ? 0 : &this->buffers_[b][0],this->ranges(b));
+  }
+
+private:
+  friend class detail::multi_array::background_job<slab_reader>;
+
+  // Fills buffer b with slab s: the rows shared with the previous slab,
+  // which is in the other buffer, are copied, the rest read.
+  void fill(std::size_t b, size_type s) {
+    size_type begin, end;
+    this->rows(s,begin,end);
+    this->begin_[b] = begin;
+    this->end_[b] = end;
+    if (begin < rows_read_) {
+      const std::size_t other = 1 - b;
+      std::copy(this->row(other,begin),this->row(other,rows_read_),
+                this->row(b,begin));
+    }
+    if (rows_read_ < end) {
+      T* const first = this->row(b,rows_read_);
+      const std::size_t count = (end - rows_read_) * this->row_elements_;
+      detail::multi_array::read_bytes(is_,first,count * sizeof(T));
+      if (swap_)
+        detail::multi_array::swap_bytes(first,sizeof(T),count);
+      rows_read_ = end;
+    }
+  }
+
+  std::istream& is_;
+  bool swap_;
+  bool started_;
+  size_type rows_read_;
+  detail::multi_array::background_job<slab_reader> job_;
+};
+
+template <typename T, std::size_t NumDims>
+class slab_writer : public detail::multi_array::slab_stream_base<T,NumDims> {
+  BOOST_STATIC_ASSERT(detail::multi_array::is_bitwise_copyable<T>::value);
+  typedef detail::multi_array::slab_stream_base<T,NumDims> super_type;
+public:
+  typedef typename super_type::index index;
+  typedef typename super_type::size_type size_type;
+
+  // Writes the header of save() for an array of the given extents (and
+  // index bases) in C storage order, then the slabs as they complete.
+  template <typename ExtentList>
+  slab_writer(std::ostream& os, const ExtentList& extents,
+              size_type slab_extent) : os_(os), active_(false) {
+    boost::function_requires<
+      CollectionConcept<ExtentList> >();
+    BOOST_ASSERT(extents.size() == NumDims);
+    boost::array<index,NumDims> bases;
+    bases.assign(0);
+    start(extents.begin(),bases.begin(),slab_extent);
+  }
+
+  template <typename ExtentList, typename BaseList>
+  slab_writer(std::ostream& os, const ExtentList& extents,
+              const BaseList& index_bases, size_type slab_extent) :
+    os_(os), active_(false) {
+    boost::function_requires<
+      CollectionConcept<ExtentList> >();
+    boost::function_requires<
+      CollectionConcept<BaseList> >();
+    BOOST_ASSERT(extents.size() == NumDims &&
+                 index_bases.size() == NumDims);
+    start(extents.begin(),index_bases.begin(),slab_extent);
+  }
+
+  ~slab_writer() { job_.discard(); }
+
+  // Hands the current slab, if any, to be written and moves to the next
+  // one; false once every slab has been written.
+  bool next() {
+    if (this->slab_ == this->num_slabs_) {
+      job_.wait();
+      return false;
+    }
+    if (active_) {
+      job_.wait();
+      job_.start(this,&slab_writer::write,this->current_,this->slab_);
+      this->current_ = 1 - this->current_;
+      if (++this->slab_ == this->num_slabs_) {
+        active_ = false;
+        job_.wait();
+        return false;
+      }
+    }
+    active_ = true;
+    size_type begin, end;
+    this->rows(this->slab_,begin,end);
+    this->begin_[this->current_] = begin;
+    this->end_[this->current_] = end;
+    return true;
+  }
+
+  multi_array_ref<T,NumDims> slab() {
+    BOOST_ASSERT(active_);
+    const std::size_t b = this->current_;
+    return multi_array_ref<T,NumDims>(
+      this->buffers_[b].empty() ? 0 : &this->buffers_[b][0],this->ranges(b));
+  }
+
+private:
+  friend class detail::multi_array::background_job<slab_writer>;
+
+  template <typename ExtentIter, typename BaseIter>
+  void start(ExtentIter extents, BaseIter bases, size_type slab_extent) {
+    this->init(extents,bases,slab_extent,0);
+    this->current_ = 0;
+    detail::multi_array::write_binary_header<T,NumDims>(
+      os_,this->extents_.data(),this->index_bases_.data(),
+      general_storage_order<NumDims>(c_storage_order()));
+  }
+
+  void write(std::size_t b, size_type) {
+    const std::size_t count =
+      (this->end_[b] - this->begin_[b]) * this->row_elements_;
+    if (count != 0)
+      detail::multi_array::write_bytes(os_,&this->buffers_[b][0],
+                                       count * sizeof(T));
+  }
+
+  std::ostream& os_;
+  bool active_;
+  detail::multi_array::background_job<slab_writer> job_;
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
+} // namespace boost
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "boost/multi_array/types.hpp"
 #include "boost/array.hpp"
+#include "boost/static_assert.hpp"
 #include "boost/multi_array/algorithm.hpp"
 #include <algorithm>
 #include <cstddef>
@@ -24,6 +25,8 @@
 
 namespace boost {
 
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
   // RG - This is to make things work with VC++. So sad, so sad.
   class c_storage_order; 
   class fortran_storage_order;
@@ -36,8 +39,8 @@ namespace boost {
     template <typename OrderingIter, typename AscendingIter>
     general_storage_order(OrderingIter ordering,
                           AscendingIter ascending) {
-      boost::detail::multi_array::copy_n(ordering,NumDims,ordering_.begin());
-      boost::detail::multi_array::copy_n(ascending,NumDims,ascending_.begin());
+      for (size_type i=0; i != NumDims; ++i, ++ordering, ++ascending)
+        dims_[i] = pack(*ordering,*ascending);
     }
 
     // RG - ideally these would not be necessary, but some compilers
@@ -46,34 +49,51 @@ namespace boost {
     // storage_order objects, I sacrifice that feature for compiler support.
     general_storage_order(const c_storage_order&) {
       for (size_type i=0; i != NumDims; ++i) {
-        ordering_[i] = NumDims - 1 - i;
+        dims_[i] = pack(NumDims - 1 - i,true);
       }
-      ascending_.assign(true);
     }
 
     general_storage_order(const fortran_storage_order&) {
       for (size_type i=0; i != NumDims; ++i) {
-        ordering_[i] = i;
+        dims_[i] = pack(i,true);
       }
-      ascending_.assign(true);
     }
 
-    size_type ordering(size_type dim) const { return ordering_[dim]; }
-    bool ascending(size_type dim) const { return ascending_[dim]; }
+    size_type ordering(size_type dim) const {
+      return dims_[dim] & dimension_mask;
+    }
+    bool ascending(size_type dim) const {
+      return (dims_[dim] & descending_bit) == 0;
+    }
 
     bool all_dims_ascending() const {
-      return std::accumulate(ascending_.begin(),ascending_.end(),true,
-                      std::logical_and<bool>());
+      for (size_type i=0; i != NumDims; ++i)
+        if (dims_[i] & descending_bit)
+          return false;
+      return true;
     }
 
     bool operator==(general_storage_order const& rhs) const {
-      return (ordering_ == rhs.ordering_) &&
-        (ascending_ == rhs.ascending_);
+      return dims_ == rhs.dims_;
     }
 
   protected:
-    boost::array<size_type,NumDims> ordering_;
-    boost::array<bool,NumDims> ascending_;
+    // One byte per dimension, which every array and reference carries:
+    // the n-th entry of the ordering in the low bits of dims_[n], and
+    // descending_bit set when dimension n is stored in descending
+    // order.
+    BOOST_STATIC_ASSERT_MSG(NumDims < 128,
+                            "general_storage_order packs a dimension "
+                            "into seven bits");
+    BOOST_STATIC_CONSTANT(unsigned char, dimension_mask = 0x7f);
+    BOOST_STATIC_CONSTANT(unsigned char, descending_bit = 0x80);
+
+    static unsigned char pack(size_type dim, bool ascending) {
+      return static_cast<unsigned char>(ascending ? dim :
+                                        dim | descending_bit);
+    }
+
+    boost::array<unsigned char,NumDims> dims_;
   };
 
   class c_storage_order 
@@ -120,6 +140,8 @@ namespace boost {
 #endif
   };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace boost
 
 #endif
@@ -29,6 +29,7 @@
 namespace boost {
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
 
 //
 // const_sub_array
@@ -50,6 +51,7 @@ public:
   typedef typename super_type::difference_type difference_type;
   typedef typename super_type::index index;
   typedef typename super_type::extent_range extent_range;
+  typedef typename super_type::collapsed_shape_type collapsed_shape_type;
 
   // template typedefs
   template <std::size_t NDims>
@@ -67,18 +69,20 @@ public:
   template <typename OPtr>
   const_sub_array (const const_sub_array<T,NumDims,OPtr>& rhs) :
     base_(rhs.base_), extents_(rhs.extents_), strides_(rhs.strides_),
-    index_base_(rhs.index_base_) {
+    index_base_(rhs.index_base_), element_counts_(rhs.element_counts_) {
   }
 
   // const_sub_array always returns const types, regardless of its own
   // constness.
   const_reference operator[](index idx) const {
     return super_type::access(boost::type<const_reference>(),
-                              idx,base_,shape(),strides(),index_bases());
+                              idx,base_,shape(),strides(),index_bases(),
+                              element_counts_ ? element_counts_ + 1 : 0);
   }
   
   template <typename IndexList>
-  const element& operator()(const IndexList& indices) const {
+  typename index_list_result<IndexList,const element&>::type
+  operator()(const IndexList& indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<const element&>(),
@@ -86,6 +90,44 @@ public:
                                       shape(),strides(),index_bases());
   }
 
+  // As operator(), but throwing std::out_of_range for an index out of
+  // range, whether or not assertions are enabled.
+  template <typename IndexList>
+  typename index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::access_element_checked(boost::type<const element&>(),
+                                              indices,origin(),
+                                              shape(),strides(),index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  // A(i,j,k): the element at NumDims integral indices.
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::access_indices(boost::type<const element&>(),
+                                      origin(),shape(),strides(),index_bases(),
+                                      indices...);
+  }
+
+  // As operator()(i,j,k), never checking the indices.
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::access_indices_unchecked(boost::type<const element&>(),
+                                                origin(),strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::access_indices_checked(boost::type<const element&>(),
+                                              origin(),shape(),strides(),
+                                              index_bases(),indices...);
+  }
+#endif
+
   // see generate_array_view in base.hpp
   template <int NDims>
   typename const_array_view<NDims>::type 
@@ -110,7 +152,7 @@ public:
   template <typename OPtr>
   bool operator==(const const_sub_array<T,NumDims,OPtr>& rhs) const {
     if(std::equal(shape(),shape()+num_dimensions(),rhs.shape()))
-      return std::equal(begin(),end(),rhs.begin());
+      return equal_elements(*this,rhs);
     else return false;
   }
 
@@ -136,12 +178,14 @@ public:
 
   const_iterator begin() const {
     return const_iterator(*index_bases(),origin(),
-                          shape(),strides(),index_bases());
+                          shape(),strides(),index_bases(),
+                          element_counts_ ? element_counts_ + 1 : 0);
   }
 
   const_iterator end() const {
     return const_iterator(*index_bases()+(index)*shape(),origin(),
-                          shape(),strides(),index_bases());
+                          shape(),strides(),index_bases(),
+                          element_counts_ ? element_counts_ + 1 : 0);
   }
 
   const_reverse_iterator rbegin() const {
@@ -162,10 +206,53 @@ public:
   const index* index_bases() const { return index_base_; }
 
   size_type num_elements() const { 
+    if (element_counts_)
+      return *element_counts_;
     return std::accumulate(shape(),shape() + num_dimensions(),
                            size_type(1), std::multiplies<size_type>());
   }
 
+  // Layout queries: whether the elements lie densely in memory, in any
+  // order or in C or Fortran order; the length of the runs a walk in
+  // index order makes; the dimensions left once those that walk on
+  // from one another are merged; and the number of elements from the
+  // lowest addressed element to the highest.
+  bool is_contiguous() const {
+    // A sub_array of an array never maps two indices to one element, so
+    // it is dense exactly when it spans no more than its element count.
+    if (element_counts_)
+      return memory_span() == *element_counts_;
+    return boost::detail::multi_array::
+      is_contiguous<NumDims>(shape(),strides());
+  }
+
+  bool is_c_contiguous() const {
+    return boost::detail::multi_array::
+      is_c_contiguous(NumDims,shape(),strides());
+  }
+
+  bool is_f_contiguous() const {
+    return boost::detail::multi_array::
+      is_f_contiguous(NumDims,shape(),strides());
+  }
+
+  size_type contiguous_inner_extent() const {
+    return boost::detail::multi_array::
+      contiguous_inner_extent<NumDims>(shape(),strides());
+  }
+
+  collapsed_shape_type collapsed_shape() const {
+    collapsed_shape_type result;
+    boost::detail::multi_array::
+      collapse_in_order<NumDims>(shape(),strides(),result);
+    return result;
+  }
+
+  size_type memory_span() const {
+    return boost::detail::multi_array::
+      memory_span(NumDims,shape(),strides());
+  }
+
 
 #ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
 protected:
@@ -178,15 +265,20 @@ public:  // Should be protected
   const_sub_array (TPtr base,
                  const size_type* extents,
                  const index* strides,
-                 const index* index_base) :
+                 const index* index_base,
+                 const size_type* element_counts = 0) :
     base_(base), extents_(extents), strides_(strides),
-    index_base_(index_base) {
+    index_base_(index_base), element_counts_(element_counts) {
   }
 
   TPtr base_;
   const size_type* extents_;
   const index* strides_;
   const index* index_base_;
+  // The number of elements of this sub_array and of those below it,
+  // from the table of the array it was taken from, whether through
+  // operator[] or an iterator; null when taken from a view.
+  const size_type* element_counts_;
 private:
   // const_sub_array cannot be assigned to (no deep copies!)
   const_sub_array& operator=(const const_sub_array&);
@@ -227,15 +319,14 @@ public:
   // Assignment from other ConstMultiArray types.
   template <typename ConstMultiArray>
   sub_array& operator=(const ConstMultiArray& other) {
-    function_requires< boost::multi_array_concepts::ConstMultiArrayConcept< 
-        ConstMultiArray, NumDims> >();
+    detail::multi_array::
+      check_const_multi_array<ConstMultiArray,NumDims>();
 
     // make sure the dimensions agree
     BOOST_ASSERT(other.num_dimensions() == this->num_dimensions());
     BOOST_ASSERT(std::equal(other.shape(),other.shape()+this->num_dimensions(),
                             this->shape()));
-    // iterator-based copy
-    std::copy(other.begin(),other.end(),begin());
+    copy_elements(other,*this);
     return *this;
   }
 
@@ -247,8 +338,7 @@ public:
       BOOST_ASSERT(std::equal(other.shape(),
                               other.shape()+this->num_dimensions(),
                               this->shape()));
-      // iterator-based copy
-      std::copy(other.begin(),other.end(),begin());
+      copy_elements(other,*this);
     }
     return *this;
   }
@@ -259,7 +349,9 @@ public:
   reference operator[](index idx) {
     return super_type::access(boost::type<reference>(),
                               idx,this->base_,this->shape(),this->strides(),
-                              this->index_bases());
+                              this->index_bases(),
+                              this->element_counts_ ?
+                                this->element_counts_ + 1 : 0);
   }
 
   // see generate_array_view in base.hpp
@@ -278,7 +370,8 @@ public:
   }
 
   template <class IndexList>
-  element& operator()(const IndexList& indices) {
+  typename index_list_result<IndexList,element&>::type
+  operator()(const IndexList& indices) {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<element&>(),
@@ -287,14 +380,53 @@ public:
                                       this->index_bases());
   }
 
+  template <class IndexList>
+  typename index_list_result<IndexList,element&>::type
+  at(const IndexList& indices) {
+    return super_type::access_element_checked(boost::type<element&>(),
+                                              indices,origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  operator()(Indices... indices) {
+    return super_type::access_indices(boost::type<element&>(),
+                                      origin(),
+                                      this->shape(),this->strides(),
+                                      this->index_bases(),indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  unchecked(Indices... indices) {
+    return super_type::access_indices_unchecked(boost::type<element&>(),
+                                                origin(),this->strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  at(Indices... indices) {
+    return super_type::access_indices_checked(boost::type<element&>(),
+                                              origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases(),indices...);
+  }
+#endif
+
   iterator begin() {
     return iterator(*this->index_bases(),origin(),
-                    this->shape(),this->strides(),this->index_bases());
+                    this->shape(),this->strides(),this->index_bases(),
+                    this->element_counts_ ? this->element_counts_ + 1 : 0);
   }
 
   iterator end() {
     return iterator(*this->index_bases()+(index)*this->shape(),origin(),
-                    this->shape(),this->strides(),this->index_bases());
+                    this->shape(),this->strides(),this->index_bases(),
+                    this->element_counts_ ? this->element_counts_ + 1 : 0);
   }
 
   // RG - rbegin() and rend() written naively to thwart MSVC ICE.
@@ -313,12 +445,39 @@ public:
   //
 
   template <class IndexList>
-  const element& operator()(const IndexList& indices) const {
+  typename index_list_result<IndexList,const element&>::type
+  operator()(const IndexList& indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::operator()(indices);
   }
 
+  template <class IndexList>
+  typename index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::at(indices);
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::operator()(indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::unchecked(indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::at(indices...);
+  }
+#endif
+
   const_reference operator[](index idx) const {
     return super_type::operator[](idx);
   }
@@ -358,14 +517,19 @@ public: // should be private
   sub_array (T* base,
             const size_type* extents,
             const index* strides,
-            const index* index_base) :
-    super_type(base,extents,strides,index_base) {
+            const index* index_base,
+            const size_type* element_counts = 0) :
+    super_type(base,extents,strides,index_base,element_counts) {
   }
 
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
 //
 // traits classes to get sub_array types
 //
@@ -382,6 +546,8 @@ class const_subarray_gen {
 public:
   typedef boost::detail::multi_array::const_sub_array<element,N> type;  
 };
+
+BOOST_MULTI_ARRAY_ABI_END
 } // namespace boost
   
 #endif
@@ -0,0 +1,32 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+#ifndef BOOST_MULTI_ARRAY_THREADS_HPP
+#define BOOST_MULTI_ARRAY_THREADS_HPP
+
+//
+// threads.hpp - defines BOOST_MULTI_ARRAY_HAS_THREADS when the standard
+// library has the C++11 thread support the I/O headers use to overlap
+// work (threads, mutexes, atomics and exception_ptr).  Define
+// BOOST_MULTI_ARRAY_NO_THREADS to do everything on the calling thread.
+//
+
+#include "boost/config.hpp"
+
+#if !defined(BOOST_MULTI_ARRAY_NO_THREADS) && \
+  !defined(BOOST_NO_CXX11_HDR_THREAD) && \
+  !defined(BOOST_NO_CXX11_HDR_MUTEX) && \
+  !defined(BOOST_NO_CXX11_HDR_ATOMIC) && \
+  !defined(BOOST_NO_CXX11_HDR_EXCEPTION)
+#  define BOOST_MULTI_ARRAY_HAS_THREADS
+#  include <atomic>
+#  include <exception>
+#  include <mutex>
+#  include <thread>
+#endif
+
+#endif
@@ -17,16 +17,102 @@
 //
 // types.hpp - supply types that are needed by several headers
 //
+// The index and size types of every array, view and iterator are
+// std::ptrdiff_t and std::size_t unless BOOST_MULTI_ARRAY_INDEX_TYPE and
+// BOOST_MULTI_ARRAY_SIZE_TYPE name others, for example
+//
+//   #define BOOST_MULTI_ARRAY_INDEX_TYPE boost::int32_t
+//   #define BOOST_MULTI_ARRAY_SIZE_TYPE boost::uint32_t
+//
+// which halves the extents, strides and index bases each array and view
+// carries, and lets offsets be computed in 32 bits.  The index type must
+// be signed and the size type unsigned.
+//
+// The choice is made for each translation unit, not for each array:
+// every array, view and iterator takes these types.  So that units
+// configured differently cannot silently share definitions, the
+// classes and functions whose layout or behaviour depends on the types
+// are declared between BOOST_MULTI_ARRAY_ABI_BEGIN and
+// BOOST_MULTI_ARRAY_ABI_END.  With configured types and C++11 those
+// open and close an inline namespace, configured_types, which changes
+// their mangled names but not how they are spelled.  A unit with the
+// default types and one with configured types then use distinct
+// entities, and passing an array from one to the other fails to link.
+// Under MSVC, #pragma detect_mismatch also makes any two units whose
+// macros differ fail to link.  Without either (a C++03 build with
+// another compiler) nothing is detected, so define both macros or
+// neither, the same way in every translation unit.
+//
+// An array whose shape holds more elements
+// than the index type can count is refused with std::length_error when
+// it is constructed, reshaped or resized (see checked_num_elements in
+// base.hpp), so with 32-bit types extents[70000][70000] throws instead
+// of wrapping.
+//
 #include "boost/config.hpp"
+#include "boost/static_assert.hpp"
+#include "boost/type_traits/has_trivial_assign.hpp"
+#include "boost/type_traits/has_trivial_copy.hpp"
+#include "boost/type_traits/is_signed.hpp"
+#include "boost/type_traits/is_unsigned.hpp"
 #include <cstddef>
+#if defined(BOOST_MULTI_ARRAY_INDEX_TYPE) || \
+    defined(BOOST_MULTI_ARRAY_SIZE_TYPE)
+#include "boost/cstdint.hpp"
+#endif
+
+#if defined(BOOST_MULTI_ARRAY_INDEX_TYPE) != \
+    defined(BOOST_MULTI_ARRAY_SIZE_TYPE)
+#error "BOOST_MULTI_ARRAY_INDEX_TYPE and BOOST_MULTI_ARRAY_SIZE_TYPE must be defined together"
+#endif
+
+#if defined(BOOST_MULTI_ARRAY_INDEX_TYPE) && \
+    !defined(BOOST_NO_CXX11_INLINE_NAMESPACES)
+#define BOOST_MULTI_ARRAY_ABI_BEGIN inline namespace configured_types {
+#define BOOST_MULTI_ARRAY_ABI_END }
+#else
+#define BOOST_MULTI_ARRAY_ABI_BEGIN
+#define BOOST_MULTI_ARRAY_ABI_END
+#endif
+
+#if defined(BOOST_MSVC)
+#include "boost/config/helper_macros.hpp"
+#if defined(BOOST_MULTI_ARRAY_INDEX_TYPE)
+#pragma detect_mismatch("boost_multi_array_types", \
+  BOOST_STRINGIZE(BOOST_MULTI_ARRAY_INDEX_TYPE) "," \
+  BOOST_STRINGIZE(BOOST_MULTI_ARRAY_SIZE_TYPE))
+#else
+#pragma detect_mismatch("boost_multi_array_types", "default")
+#endif
+#endif
 
 namespace boost {
 namespace detail {
 namespace multi_array{
 
 // needed typedefs
+#if defined(BOOST_MULTI_ARRAY_INDEX_TYPE)
+typedef BOOST_MULTI_ARRAY_SIZE_TYPE size_type;
+typedef BOOST_MULTI_ARRAY_INDEX_TYPE index;
+
+BOOST_STATIC_ASSERT_MSG(boost::is_signed<index>::value,
+                        "BOOST_MULTI_ARRAY_INDEX_TYPE must be signed");
+BOOST_STATIC_ASSERT_MSG(boost::is_unsigned<size_type>::value,
+                        "BOOST_MULTI_ARRAY_SIZE_TYPE must be unsigned");
+BOOST_STATIC_ASSERT_MSG(sizeof(index) == sizeof(size_type),
+                        "the index and size types must be the same size");
+#else
 typedef std::size_t size_type;
 typedef std::ptrdiff_t index;
+#endif
+
+// Elements that may be copied with memcpy, memset or raw I/O.
+template <typename T>
+struct is_bitwise_copyable {
+  BOOST_STATIC_CONSTANT(bool, value =
+    (boost::has_trivial_assign<T>::value &&
+     boost::has_trivial_copy<T>::value));
+};
 
 } // namespace multi_array
 } // namespace detail
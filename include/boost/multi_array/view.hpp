@@ -35,6 +35,9 @@
 namespace boost {
 namespace detail {
 namespace multi_array {
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+struct view_factory;
 
 // TPtr = const T* defaulted in base.hpp
 template <typename T, std::size_t NumDims, typename TPtr>
@@ -52,6 +55,7 @@ public:
   typedef typename super_type::difference_type difference_type;
   typedef typename super_type::index index;
   typedef typename super_type::extent_range extent_range;
+  typedef typename super_type::collapsed_shape_type collapsed_shape_type;
 
   // template typedefs
   template <std::size_t NDims>
@@ -67,8 +71,7 @@ public:
   template <typename OPtr>
   const_multi_array_view(const 
                          const_multi_array_view<T,NumDims,OPtr>& other) :
-    base_(other.base_), origin_offset_(other.origin_offset_),
-    num_elements_(other.num_elements_), extent_list_(other.extent_list_),
+    origin_(other.origin_), extent_list_(other.extent_list_),
     stride_list_(other.stride_list_), index_base_list_(other.index_base_list_)
   { }
 
@@ -83,16 +86,20 @@ public:
   reindex(const BaseList& values) {
     boost::function_requires<
       CollectionConcept<BaseList> >();
+    const index old_offset =
+      this->calculate_indexing_offset(stride_list_,index_base_list_);
     boost::detail::multi_array::
       copy_n(values.begin(),num_dimensions(),index_base_list_.begin());
-    origin_offset_ =
-      this->calculate_indexing_offset(stride_list_,index_base_list_);
+    origin_ += this->calculate_indexing_offset(stride_list_,index_base_list_) -
+      old_offset;
   }
 
   void reindex(index value) {
-    index_base_list_.assign(value);
-    origin_offset_ =
+    const index old_offset =
       this->calculate_indexing_offset(stride_list_,index_base_list_);
+    index_base_list_.assign(value);
+    origin_ += this->calculate_indexing_offset(stride_list_,index_base_list_) -
+      old_offset;
   }
 
   size_type num_dimensions() const { return NumDims; }
@@ -109,16 +116,57 @@ public:
     return stride_list_.data();
   }
 
-  const T* origin() const { return base_+origin_offset_; }
+  const T* origin() const { return origin_; }
 
-  size_type num_elements() const { return num_elements_; }
+  size_type num_elements() const {
+    return std::accumulate(extent_list_.begin(),extent_list_.end(),
+                           size_type(1),std::multiplies<size_type>());
+  }
 
   const index* index_bases() const {
     return index_base_list_.data();
   }
 
+  // Layout queries: whether the elements lie densely in memory, in any
+  // order or in C or Fortran order; the length of the runs a walk in
+  // index order makes; the dimensions left once those that walk on
+  // from one another are merged; and the number of elements from the
+  // lowest addressed element to the highest.
+  bool is_contiguous() const {
+    return boost::detail::multi_array::
+      is_contiguous<NumDims>(shape(),strides());
+  }
+
+  bool is_c_contiguous() const {
+    return boost::detail::multi_array::
+      is_c_contiguous(NumDims,shape(),strides());
+  }
+
+  bool is_f_contiguous() const {
+    return boost::detail::multi_array::
+      is_f_contiguous(NumDims,shape(),strides());
+  }
+
+  size_type contiguous_inner_extent() const {
+    return boost::detail::multi_array::
+      contiguous_inner_extent<NumDims>(shape(),strides());
+  }
+
+  collapsed_shape_type collapsed_shape() const {
+    collapsed_shape_type result;
+    boost::detail::multi_array::
+      collapse_in_order<NumDims>(shape(),strides(),result);
+    return result;
+  }
+
+  size_type memory_span() const {
+    return boost::detail::multi_array::
+      memory_span(NumDims,shape(),strides());
+  }
+
   template <typename IndexList>
-  const element& operator()(IndexList indices) const {
+  typename index_list_result<IndexList,const element&>::type
+  operator()(IndexList indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<const element&>(),
@@ -126,6 +174,44 @@ public:
                                       shape(),strides(),index_bases());
   }
 
+  // As operator(), but throwing std::out_of_range for an index out of
+  // range, whether or not assertions are enabled.
+  template <typename IndexList>
+  typename index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::access_element_checked(boost::type<const element&>(),
+                                              indices,origin(),
+                                              shape(),strides(),index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  // A(i,j,k): the element at NumDims integral indices.
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::access_indices(boost::type<const element&>(),
+                                      origin(),shape(),strides(),index_bases(),
+                                      indices...);
+  }
+
+  // As operator()(i,j,k), never checking the indices.
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::access_indices_unchecked(boost::type<const element&>(),
+                                                origin(),strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::access_indices_checked(boost::type<const element&>(),
+                                              origin(),shape(),strides(),
+                                              index_bases(),indices...);
+  }
+#endif
+
   // Only allow const element access
   const_reference operator[](index idx) const {
     return super_type::access(boost::type<const_reference>(),
@@ -175,7 +261,7 @@ public:
     if(std::equal(extent_list_.begin(),
                   extent_list_.end(),
                   rhs.extent_list_.begin()))
-      return std::equal(begin(),end(),rhs.begin());
+      return equal_elements(*this,rhs);
     else return false;
   }
 
@@ -219,6 +305,7 @@ public:
 protected:
   template <typename,std::size_t> friend class multi_array_impl_base;
   template <typename,std::size_t,typename> friend class const_multi_array_view;
+  friend struct view_factory;
 #else
 public: // should be protected
 #endif
@@ -229,7 +316,7 @@ public: // should be protected
   explicit const_multi_array_view(TPtr base,
                            const ExtentList& extents,
                            const boost::array<Index,NumDims>& strides): 
-    base_(base), origin_offset_(0) {
+    origin_(base) {
 
     index_base_list_.assign(0);
 
@@ -238,18 +325,16 @@ public: // should be protected
       copy_n(extents.begin(),NumDims,extent_list_.begin());
     boost::detail::multi_array::
       copy_n(strides.begin(),NumDims,stride_list_.begin());
-
-    // Calculate the array size
-    num_elements_ = std::accumulate(extent_list_.begin(),extent_list_.end(),
-                                    size_type(1),std::multiplies<size_type>());
   }
 
   typedef boost::array<size_type,NumDims> size_list;
   typedef boost::array<index,NumDims> index_list;
 
-  TPtr base_;
-  index origin_offset_;
-  size_type num_elements_;
+  // origin_ is where the element with all indices zero would be, so
+  // that indexing adds to it directly; reindex() moves it.  The number
+  // of elements is computed from the extents when asked for rather
+  // than carried by every view.
+  TPtr origin_;
   size_list extent_list_;
   index_list stride_list_;
   index_list index_base_list_;
@@ -293,16 +378,14 @@ public:
   // Assignment from other ConstMultiArray types.
   template <typename ConstMultiArray>
   multi_array_view& operator=(const ConstMultiArray& other) {
-    function_requires< 
-      boost::multi_array_concepts::
-      ConstMultiArrayConcept<ConstMultiArray,NumDims> >();
+    detail::multi_array::
+      check_const_multi_array<ConstMultiArray,NumDims>();
 
     // make sure the dimensions agree
     BOOST_ASSERT(other.num_dimensions() == this->num_dimensions());
     BOOST_ASSERT(std::equal(other.shape(),other.shape()+this->num_dimensions(),
                             this->shape()));
-    // iterator-based copy
-    std::copy(other.begin(),other.end(),begin());
+    copy_elements(other,*this);
     return *this;
   }
 
@@ -314,16 +397,16 @@ public:
       BOOST_ASSERT(std::equal(other.shape(),
                               other.shape()+this->num_dimensions(),
                               this->shape()));
-      // iterator-based copy
-      std::copy(other.begin(),other.end(),begin());
+      copy_elements(other,*this);
     }
     return *this;
   }
 
-  element* origin() { return this->base_+this->origin_offset_; }
+  element* origin() { return this->origin_; }
 
   template <class IndexList>
-  element& operator()(const IndexList& indices) {
+  typename index_list_result<IndexList,element&>::type
+  operator()(const IndexList& indices) {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::access_element(boost::type<element&>(),
@@ -332,6 +415,43 @@ public:
                                       this->index_bases());
   }
 
+  template <class IndexList>
+  typename index_list_result<IndexList,element&>::type
+  at(const IndexList& indices) {
+    return super_type::access_element_checked(boost::type<element&>(),
+                                              indices,origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases());
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  operator()(Indices... indices) {
+    return super_type::access_indices(boost::type<element&>(),
+                                      origin(),
+                                      this->shape(),this->strides(),
+                                      this->index_bases(),indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  unchecked(Indices... indices) {
+    return super_type::access_indices_unchecked(boost::type<element&>(),
+                                                origin(),this->strides(),
+                                                indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,element&,Indices...>::type
+  at(Indices... indices) {
+    return super_type::access_indices_checked(boost::type<element&>(),
+                                              origin(),
+                                              this->shape(),this->strides(),
+                                              this->index_bases(),indices...);
+  }
+#endif
+
 
   reference operator[](index idx) {
     return super_type::access(boost::type<reference>(),
@@ -383,12 +503,39 @@ public:
   const element* origin() const { return super_type::origin(); }
 
   template <class IndexList>
-  const element& operator()(const IndexList& indices) const {
+  typename index_list_result<IndexList,const element&>::type
+  operator()(const IndexList& indices) const {
     boost::function_requires<
       CollectionConcept<IndexList> >();
     return super_type::operator()(indices);
   }
 
+  template <class IndexList>
+  typename index_list_result<IndexList,const element&>::type
+  at(const IndexList& indices) const {
+    return super_type::at(indices);
+  }
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  operator()(Indices... indices) const {
+    return super_type::operator()(indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  unchecked(Indices... indices) const {
+    return super_type::unchecked(indices...);
+  }
+
+  template <typename... Indices>
+  typename indices_result<NumDims,const element&,Indices...>::type
+  at(Indices... indices) const {
+    return super_type::at(indices...);
+  }
+#endif
+
   const_reference operator[](index idx) const {
     return super_type::operator[](idx);
   }
@@ -421,6 +568,7 @@ public:
 #ifndef BOOST_NO_MEMBER_TEMPLATE_FRIENDS
 private:
   template <typename,std::size_t> friend class multi_array_impl_base;
+  friend struct view_factory;
 #else
 public: // should be private
 #endif
@@ -435,9 +583,57 @@ public: // should be private
 
 };
 
+// Gives make_array_view and make_const_array_view access to the
+// constructor generate_array_view uses.
+struct view_factory {
+  template <typename View, typename TPtr, typename ExtentList,
+            typename Index, std::size_t NumDims>
+  static View make(TPtr base, const ExtentList& extents,
+                   const boost::array<Index,NumDims>& strides) {
+    return View(base,extents,strides);
+  }
+};
+
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace multi_array
 } // namespace detail
 
+BOOST_MULTI_ARRAY_ABI_BEGIN
+
+//
+// make_array_view / make_const_array_view
+//   Views of external memory laid out with arbitrary strides: a pitched
+//   image, a sub-rectangle of a larger buffer, one channel of
+//   interleaved data.  Strides are counted in elements and may be
+//   negative or leave gaps; base is the address of the element with
+//   all indices zero.  Like every view, the result is zero-based
+//   (see reindex()) and does not own the memory.
+//
+template <typename T, typename ExtentList, typename Index,
+          std::size_t NumDims>
+detail::multi_array::multi_array_view<T,NumDims>
+make_array_view(T* base, const ExtentList& extents,
+                const boost::array<Index,NumDims>& strides) {
+  boost::function_requires<
+    CollectionConcept<ExtentList> >();
+  typedef detail::multi_array::multi_array_view<T,NumDims> view_type;
+  return detail::multi_array::view_factory::
+    make<view_type>(base,extents,strides);
+}
+
+template <typename T, typename ExtentList, typename Index,
+          std::size_t NumDims>
+detail::multi_array::const_multi_array_view<T,NumDims>
+make_const_array_view(const T* base, const ExtentList& extents,
+                      const boost::array<Index,NumDims>& strides) {
+  boost::function_requires<
+    CollectionConcept<ExtentList> >();
+  typedef detail::multi_array::const_multi_array_view<T,NumDims> view_type;
+  return detail::multi_array::view_factory::
+    make<view_type>(base,extents,strides);
+}
+
 //
 // traits classes to get array_view types
 //
@@ -455,6 +651,8 @@ public:
   typedef boost::detail::multi_array::const_multi_array_view<element,N> type;  
 };
 
+BOOST_MULTI_ARRAY_ABI_END
+
 } // namespace boost
 
 #endif
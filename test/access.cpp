@@ -17,6 +17,7 @@
 
 #include "generative_tests.hpp"
 #include <boost/static_assert.hpp>
+#include <stdexcept>
 
 template <typename Array>
 void access(Array& A, const mutable_array_tag&) {
@@ -54,10 +55,47 @@ void access(Array& A, const const_array_tag&) {
         indices[0] = i2; indices[1] = j2; indices[2] = k2;
         BOOST_TEST(A(indices) == A[i2][j2][k2]);
         BOOST_TEST(CA(indices) == A(indices));
+        BOOST_TEST(A.at(indices) == A(indices));
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+        BOOST_TEST(A(i2,j2,k2) == A(indices));
+        BOOST_TEST(CA(i2,j2,k2) == A(indices));
+        BOOST_TEST(&A.unchecked(i2,j2,k2) == &A(indices));
+        BOOST_TEST(&A.at(i2,j2,k2) == &A(indices));
+#endif
       }
+
+  // at() checks the indices
+  {
+    boost::array<index,ndims> indices;
+    indices[0] = idx0; indices[1] = idx1 + 3; indices[2] = idx2;
+    BOOST_TEST_THROWS(A.at(indices),std::out_of_range);
+    BOOST_TEST_THROWS(CA.at(indices),std::out_of_range);
+    // so does the number of them
+    boost::array<index,ndims - 1> short_list;
+    short_list[0] = idx0; short_list[1] = idx1;
+    BOOST_TEST_THROWS(A.at(short_list),std::out_of_range);
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    BOOST_TEST_THROWS(A.at(idx0 - 1,idx1,idx2),std::out_of_range);
+    BOOST_TEST_THROWS(CA.at(idx0,idx1,idx2 + 4),std::out_of_range);
+#endif
+  }
   ++tests_run;
 }
 
 int main() {
+  // one dimension: an integer is an index, not an index list
+  {
+    boost::multi_array<int,1> A(boost::extents[4]);
+    boost::array<boost::multi_array_types::index,1> idx = {{ 2 }};
+    A[2] = 7;
+    BOOST_TEST(A(idx) == 7);
+    BOOST_TEST(A.at(idx) == 7);
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    BOOST_TEST(A(2) == 7);
+    BOOST_TEST(A.unchecked(2u) == 7);
+    BOOST_TEST(A.at(2L) == 7);
+    BOOST_TEST_THROWS(A.at(4),std::out_of_range);
+#endif
+  }
   return run_generative_tests();
 }
@@ -0,0 +1,169 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// access_profile.cpp - Test of the access-pattern profiler
+//
+
+#include <boost/multi_array/access_profile.hpp>
+#include <boost/multi_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef boost::multi_array<double,3> array;
+typedef boost::multi_array_types::index_range range;
+typedef boost::access_site_profile site_profile;
+
+const site_profile& only_site(const boost::access_profile& profile) {
+  BOOST_TEST(profile.sites().size() == 1);
+  return profile.sites().begin()->second;
+}
+
+int
+main()
+{
+  // a walk in storage order: unit strides, the last dimension changing
+  {
+    array A(boost::extents[4][5][8]);
+    boost::access_profile profile;
+    boost::profiled_array<boost::multi_array_ref<double,3> > p =
+      boost::profile_accesses(profile,A,"rows");
+    for (int i = 0; i != 4; ++i)
+      for (int j = 0; j != 5; ++j)
+        for (int k = 0; k != 8; ++k)
+          p[i][j][k] = i + j + k;
+    BOOST_TEST(A[3][4][7] == 14);
+
+    const site_profile& s = only_site(profile);
+    BOOST_TEST(s.site == "rows");
+    BOOST_TEST(s.accesses == 160);
+    BOOST_TEST(s.sampled == 159);
+    BOOST_TEST(s.strides_histogram[site_profile::unit_stride] == 159);
+    BOOST_TEST(s.lines_per_access() < 0.2);
+    BOOST_TEST(s.changes(2) == 159);
+    BOOST_TEST(s.changes(1) == 19);
+    BOOST_TEST(s.changes(0) == 3);
+    BOOST_TEST(s.steps[2][site_profile::step_forward] == 140);
+    BOOST_TEST(s.steps[2][site_profile::step_back_far] == 19);
+
+    std::vector<std::size_t> expected(3);
+    expected[0] = 2; expected[1] = 1; expected[2] = 0;
+    BOOST_TEST(s.current_ordering() == expected);
+    BOOST_TEST(s.recommended_ordering() == expected);
+
+    std::ostringstream os;
+    profile.report(os);
+    BOOST_TEST(os.str().find("rows: 3-d") == 0);
+    BOOST_TEST(os.str().find("(keep)") != std::string::npos);
+  }
+
+  // a walk against storage order: the first dimension changing fastest
+  {
+    array A(boost::extents[4][5][8]);
+    boost::access_profile profile;
+    boost::profiled_array<boost::multi_array_ref<double,3> > p =
+      BOOST_MULTI_ARRAY_PROFILE(profile,A);
+    boost::array<array::index,3> idx;
+    for (idx[2] = 0; idx[2] != 8; ++idx[2])
+      for (idx[1] = 0; idx[1] != 5; ++idx[1])
+        for (idx[0] = 0; idx[0] != 4; ++idx[0])
+          p(idx) = 1;
+
+    const site_profile& s = only_site(profile);
+    BOOST_TEST(s.site.find("access_profile.cpp:") != std::string::npos);
+    BOOST_TEST(s.strides_histogram[site_profile::beyond_line] == 159);
+    BOOST_TEST(s.lines_per_access() == 1);
+
+    std::vector<std::size_t> expected(3);
+    expected[0] = 0; expected[1] = 1; expected[2] = 2;
+    BOOST_TEST(s.recommended_ordering() == expected);
+
+    std::ostringstream os;
+    profile.report(os);
+    BOOST_TEST(os.str().find("recommended 0 1 2 (change)") !=
+               std::string::npos);
+  }
+
+  // views, sampling, and sites shared between arrays
+  {
+    array A(boost::extents[4][5][8]);
+    array::array_view<2>::type v = A[boost::indices[range()][2][range()]];
+    boost::access_profile profile(4);
+    for (int pass = 0; pass != 2; ++pass) {
+      boost::profiled_array<array::array_view<2>::type> p =
+        boost::profile_accesses(profile,v,"view");
+      for (int i = 0; i != 4; ++i)
+        for (int k = 0; k != 8; ++k)
+          p[i][k] += 1;
+    }
+    BOOST_TEST(A[3][2][7] == 2);
+    BOOST_TEST(A[3][1][7] == 0);
+
+    const site_profile& s = only_site(profile);
+    BOOST_TEST(s.num_dimensions() == 2);
+    BOOST_TEST(s.strides[0] == 40);
+    BOOST_TEST(s.accesses == 64);
+    // the first of the 31 steps of each pass, then one in four
+    BOOST_TEST(s.sampled == 16);
+
+    profile.clear();
+    BOOST_TEST(profile.sites().empty());
+  }
+
+  // iterators record the elements they reach, as p[i][j][k] does
+  {
+    array A(boost::extents[4][5][8]);
+    boost::access_profile profile;
+    boost::profiled_array<boost::multi_array_ref<double,3> > p =
+      boost::profile_accesses(profile,A,"iterators");
+    BOOST_TEST(p.end() - p.begin() == 4);
+    double n = 0;
+    typedef boost::profiled_array<boost::multi_array_ref<double,3> >::iterator
+      iterator;
+    for (iterator it = p.begin(); it != p.end(); ++it)
+      for (int j = 0; j != 5; ++j)
+        for (int k = 0; k != 8; ++k)
+          (*it)[j][k] = n++;
+    BOOST_TEST(A[3][4][7] == 159);
+    const site_profile& s = only_site(profile);
+    BOOST_TEST(s.accesses == 160);
+    BOOST_TEST(s.strides_histogram[site_profile::unit_stride] == 159);
+
+    boost::multi_array<double,1> B(boost::extents[6]);
+    boost::access_profile row_profile;
+    boost::profiled_array<boost::multi_array_ref<double,1> > r =
+      boost::profile_accesses(row_profile,B,"row");
+    std::fill(r.begin(),r.end(),2.5);
+    BOOST_TEST(B[5] == 2.5);
+    BOOST_TEST(only_site(row_profile).accesses == 6);
+  }
+
+  // read-only kernels: const arrays, references and views
+  {
+    array A(boost::extents[4][5][8]);
+    A[1][2][3] = 7;
+    const array& CA = A;
+    boost::access_profile profile;
+    boost::profiled_array<boost::const_multi_array_ref<double,3> > p =
+      boost::profile_accesses(profile,CA,"const");
+    BOOST_TEST(p[1][2][3] == 7);
+
+    boost::const_multi_array_ref<double,3> ref(A.data(),
+                                               boost::extents[4][5][8]);
+    BOOST_TEST(boost::profile_accesses(profile,ref,"ref")[1][2][3] == 7);
+
+    typedef array::const_array_view<2>::type const_view;
+    const_view v = CA[boost::indices[range()][2][range()]];
+    BOOST_TEST(boost::profile_accesses(profile,v,"view")[1][3] == 7);
+    BOOST_TEST(profile.sites().size() == 3);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,74 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// adopt.cpp - Test of adopting and releasing multi_array storage
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <memory>
+
+int
+main()
+{
+  typedef boost::multi_array<float,3> array;
+  typedef std::allocator<float> allocator;
+
+  // adopt a buffer, use it, and hand it back
+  {
+    allocator alloc;
+    float* buffer = alloc.allocate(2*3*4);
+    for (int i = 0; i != 2*3*4; ++i)
+      new (buffer + i) float(float(i));
+
+    boost::array<array::index,3> shape = {{2,3,4}};
+    array A(boost::adopt_storage,buffer,2*3*4,shape);
+    BOOST_TEST(A.data() == buffer);
+    BOOST_TEST(A.capacity() == 2*3*4);
+    BOOST_TEST(A[1][2][3] == 23);
+
+    // the allocation is the array's own: in-place resizing works on it
+    A.resize(boost::extents[1][3][4]);
+    BOOST_TEST(A.data() == buffer);
+
+    array::size_type capacity = A.capacity();
+    float* released = A.release();
+    BOOST_TEST(released == buffer);
+    BOOST_TEST(A.num_elements() == 0);
+    BOOST_TEST(A.capacity() == 0);
+    BOOST_TEST(released[11] == 11);
+
+    // the array stays usable after release
+    A.resize(boost::extents[2][2][2]);
+    BOOST_TEST(A.num_elements() == 8);
+    BOOST_TEST(A[1][1][1] == 0);
+
+    alloc.deallocate(released,capacity);
+  }
+
+  // storage order and index bases are honoured, and ownership can pass
+  // from one array to another without copying
+  {
+    typedef array::extent_range range;
+    array A(boost::extents[range(1,3)][3][4],boost::fortran_storage_order());
+    A[2][1][3] = 42;
+    array::size_type capacity = A.capacity();
+    allocator alloc = A.get_allocator();
+    float* storage = A.release();
+
+    array B(boost::adopt_storage,storage,capacity,
+            boost::extents[range(1,3)][3][4],
+            boost::fortran_storage_order(),alloc);
+    BOOST_TEST(B.data() == storage);
+    BOOST_TEST(B[2][1][3] == 42);
+    BOOST_TEST(B.storage_order() ==
+               boost::general_storage_order<3>(boost::fortran_storage_order()));
+  }
+
+  return boost::report_errors();
+}
@@ -59,12 +59,13 @@ operator!=(const creator<T>& a, const creator<U>& b)
   return !(a == b);
 }
 
-void test(const double&, std::size_t*, int*, unsigned)
+void test(const double&, boost::multi_array_types::size_type*, int*, unsigned)
 {
 }
 
 template<class Array>
-void test(const Array& array, std::size_t* sizes, int* strides,
+void test(const Array& array, boost::multi_array_types::size_type* sizes,
+    int* strides,
     unsigned elements)
 {
   BOOST_TEST(array.num_elements() == elements);
@@ -0,0 +1,116 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// append.cpp - Test of push_back_slice() and emplace_back_slice()
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <memory>
+
+// counts the allocations made through it
+std::size_t allocations = 0;
+
+template <typename T>
+struct counting_allocator : std::allocator<T> {
+  template <typename U> struct rebind { typedef counting_allocator<U> other; };
+  counting_allocator() { }
+  template <typename U>
+  counting_allocator(const counting_allocator<U>&) { }
+  T* allocate(std::size_t n) {
+    ++allocations;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+int
+main()
+{
+  typedef boost::multi_array<double,2> series;
+  typedef boost::multi_array<double,1> row;
+
+  // rows of a time series, with geometric growth of the capacity
+  {
+    series S(boost::extents[0][4]);
+    row r(boost::extents[4]);
+    int reallocations = 0;
+    const double* storage = S.data();
+    for (int t = 0; t != 1000; ++t) {
+      for (int j = 0; j != 4; ++j)
+        r[j] = t * 10 + j;
+      S.push_back_slice(r);
+      if (S.data() != storage) {
+        ++reallocations;
+        storage = S.data();
+      }
+    }
+    BOOST_TEST(S.shape()[0] == 1000);
+    BOOST_TEST(S.shape()[1] == 4);
+    BOOST_TEST(S.capacity() >= S.num_elements());
+    BOOST_TEST(reallocations <= 12);
+    for (int t = 0; t != 1000; ++t)
+      for (int j = 0; j != 4; ++j)
+        BOOST_TEST(S[t][j] == t * 10 + j);
+  }
+
+  // slices may come from subarrays and views of other arrays
+  {
+    series A(boost::extents[3][2]);
+    series B(boost::extents[2][2]);
+    B[0][0] = 1; B[0][1] = 2; B[1][0] = 3; B[1][1] = 4;
+    A.push_back_slice(B[1]);
+    A.push_back_slice(B[boost::indices[series::index_range()][0]]);
+    BOOST_TEST(A.shape()[0] == 5);
+    BOOST_TEST(A[3][0] == 3 && A[3][1] == 4);
+    BOOST_TEST(A[4][0] == 1 && A[4][1] == 3);
+    BOOST_TEST(A[0][0] == 0);
+  }
+
+  // emplace_back_slice returns the new, value-initialized slice
+  {
+    typedef series::extent_range range;
+    series A(boost::extents[range(1,2)][range(-1,2)]);
+    series::array_view<1>::type last = A.emplace_back_slice();
+    BOOST_TEST(last.num_elements() == 3);
+    // views are zero-based
+    BOOST_TEST(last[0] == 0 && last[2] == 0);
+    last[1] = 7;
+    BOOST_TEST(A[2][0] == 7);
+  }
+
+  // fortran storage appends along the last dimension
+  {
+    series F(boost::extents[3][1],boost::fortran_storage_order());
+    F[0][0] = 1; F[1][0] = 2; F[2][0] = 3;
+    row r(boost::extents[3]);
+    r[0] = 4; r[1] = 5; r[2] = 6;
+    F.push_back_slice(r);
+    BOOST_TEST(F.shape()[0] == 3 && F.shape()[1] == 2);
+    BOOST_TEST(F[0][0] == 1 && F[2][0] == 3);
+    BOOST_TEST(F[0][1] == 4 && F[2][1] == 6);
+  }
+
+  // a descending slowest dimension cannot grow in place, so no spare
+  // capacity is reserved ahead of the copying resize
+  {
+    typedef boost::multi_array<double,2,counting_allocator<double> > counted;
+    bool ascending[] = { false, true };
+    counted::size_type ordering[] = { 1, 0 };
+    counted D(boost::extents[2][3],
+              boost::general_storage_order<2>(ordering,ascending));
+    D[1][2] = 9;
+    allocations = 0;
+    counted::array_view<1>::type last = D.emplace_back_slice();
+    last[0] = 4;
+    BOOST_TEST(allocations == 1);
+    BOOST_TEST(D.shape()[0] == 3);
+    BOOST_TEST(D[1][2] == 9 && D[2][0] == 4);
+  }
+
+  return boost::report_errors();
+}
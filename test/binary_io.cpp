@@ -0,0 +1,199 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// binary_io.cpp - Test of save() and load()
+//
+
+// small staging buffer, so that strided transfers refill it many times
+#define BOOST_MULTI_ARRAY_IO_BUFFER_BYTES 16
+
+#include <boost/multi_array/binary_io.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+
+typedef boost::multi_array<int,3> array;
+typedef array::index_range range;
+typedef array::extent_range erange;
+
+// A generic save() of another library, which unqualified calls on
+// types from namespace boost must still reach.
+namespace archive {
+template <typename T>
+int save(std::ostream&, const T&) { return 1; }
+}
+
+template <typename Array>
+void fill_pattern(Array& A) {
+  for (array::index i = 0; i != 2; ++i)
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k)
+        A[i][j][k] = int(i*100 + j*10 + k);
+}
+
+template <typename Array>
+bool has_pattern(const Array& A) {
+  for (array::index i = 0; i != 2; ++i)
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k)
+        if (A[i][j][k] != i*100 + j*10 + k) return false;
+  return true;
+}
+
+int
+main()
+{
+  // round trips between every pair of storage orders
+  {
+    bool descending[] = {false,true,false};
+    array::size_type odd_ordering[] = {1,2,0};
+    boost::general_storage_order<3> orders[] = {
+      boost::c_storage_order(), boost::fortran_storage_order(),
+      boost::general_storage_order<3>(odd_ordering,descending)
+    };
+    for (int from = 0; from != 3; ++from)
+      for (int to = 0; to != 3; ++to) {
+        array A(boost::extents[2][3][4],orders[from]);
+        fill_pattern(A);
+        std::stringstream stream;
+        boost::save(stream,A);
+        array B(boost::extents[1][1][1],orders[to]);
+        boost::load(stream,B);
+        BOOST_TEST(B.storage_order() == orders[to]);
+        BOOST_TEST(has_pattern(B));
+      }
+  }
+
+  // a dense array goes out as header plus one block of elements
+  {
+    array A(boost::extents[2][3][4]);
+    fill_pattern(A);
+    std::stringstream stream;
+    boost::save(stream,A);
+    std::string bytes = stream.str();
+    const std::size_t header = 8 + 4 + 4 + 3*(8 + 8 + 4 + 1);
+    BOOST_TEST(bytes.size() == header + 2*3*4*sizeof(int));
+    BOOST_TEST(std::memcmp(bytes.data() + header,A.data(),
+                           24*sizeof(int)) == 0);
+  }
+
+  // index bases are restored
+  {
+    array A(boost::extents[erange(1,3)][erange(-1,2)][4]);
+    A[2][1][3] = 7;
+    std::stringstream stream;
+    boost::save(stream,A);
+    array B;
+    boost::load(stream,B);
+    BOOST_TEST(B.index_bases()[0] == 1 && B.index_bases()[1] == -1);
+    BOOST_TEST(B[2][1][3] == 7);
+  }
+
+  // strided views and subarrays, in and out
+  {
+    array A(boost::extents[4][6][4]);
+    fill_pattern(A);
+    std::stringstream stream;
+    boost::save(stream,A[boost::indices[range(0,4,2)][range(0,3)][range()]]);
+    boost::save(stream,A[1][boost::indices[range(0,3)][range(3,-1,-1)]]);
+
+    array B(boost::extents[2][3][4]);
+    boost::load(stream,B);
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k) {
+        BOOST_TEST(B[0][j][k] == A[0][j][k]);
+        BOOST_TEST(B[1][j][k] == A[2][j][k]);
+      }
+
+    array C(boost::extents[2][6][4]);
+    boost::load(stream,C[1][boost::indices[range(0,6,2)][range()]]);
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k)
+        BOOST_TEST(C[1][2*j][k] == A[1][j][3-k]);
+  }
+
+  // a stream written on a machine of the other byte order
+  {
+    boost::multi_array<short,1> A(boost::extents[3]);
+    A[0] = 1; A[1] = 0x0102; A[2] = -2;
+    std::stringstream stream;
+    boost::save(stream,A);
+    std::string bytes = stream.str();
+    bytes[9] = bytes[9] == 1 ? 2 : 1;
+    std::reverse(&bytes[12],&bytes[16]);     // rank
+    std::reverse(&bytes[16],&bytes[24]);     // extent
+    std::reverse(&bytes[24],&bytes[32]);     // index base
+    std::reverse(&bytes[32],&bytes[36]);     // ordering
+    for (std::size_t i = 37; i != bytes.size(); i += 2)
+      std::swap(bytes[i],bytes[i+1]);
+    std::stringstream swapped(bytes);
+    boost::multi_array<short,1> B;
+    boost::load(swapped,B);
+    BOOST_TEST(B.num_elements() == 3);
+    BOOST_TEST(B[0] == 1 && B[1] == 0x0102 && B[2] == -2);
+  }
+
+  // malformed input
+  {
+    array A(boost::extents[2][3][4]);
+    std::stringstream stream;
+    boost::save(stream,A);
+    std::string bytes = stream.str();
+
+    boost::multi_array<float,3> F;
+    std::stringstream wrong_type(bytes);
+    BOOST_TEST_THROWS(boost::load(wrong_type,F),std::ios_base::failure);
+
+    // a failed load leaves the array as it was
+    array B(boost::extents[2][3][4]);
+    fill_pattern(B);
+    std::stringstream truncated(bytes.substr(0,bytes.size() - 1));
+    BOOST_TEST_THROWS(boost::load(truncated,B),std::ios_base::failure);
+    BOOST_TEST(B.num_elements() == 24 && has_pattern(B));
+
+    // extents whose product wraps: 4 * (2^62 + 1) elements
+    std::string wrapped = bytes;
+    const boost::uint64_t huge = (boost::uint64_t(1) << 62) + 1;
+    const boost::uint64_t four = 4, one = 1;
+    std::memcpy(&wrapped[16],&huge,8);
+    std::memcpy(&wrapped[24],&four,8);
+    std::memcpy(&wrapped[32],&one,8);
+    std::stringstream wraps(wrapped);
+    BOOST_TEST_THROWS(boost::load(wraps,B),std::ios_base::failure);
+    BOOST_TEST(B.num_elements() == 24 && has_pattern(B));
+
+    // an index base whose last index does not fit
+    std::string high = bytes;
+    const boost::int64_t top = (std::numeric_limits<boost::int64_t>::max)();
+    std::memcpy(&high[40],&top,8);
+    std::stringstream high_base(high);
+    BOOST_TEST_THROWS(boost::load(high_base,B),std::ios_base::failure);
+
+    array C(boost::extents[2][3][5]);
+    std::stringstream wrong_shape(bytes);
+    BOOST_TEST_THROWS(boost::load(wrong_shape,
+                        C[boost::indices[range()][range()][range(0,5)]]),
+                      std::ios_base::failure);
+
+    std::stringstream garbage("not an array at all");
+    BOOST_TEST_THROWS(boost::load(garbage,B),std::ios_base::failure);
+  }
+
+  // save() is not offered for other types from namespace boost
+  {
+    using archive::save;
+    std::stringstream stream;
+    const boost::array<int,2> pair = {{1,2}};
+    BOOST_TEST(save(stream,pair) == 1);
+  }
+
+  return boost::report_errors();
+}
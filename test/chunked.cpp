@@ -0,0 +1,159 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// chunked.cpp - Test of save_chunked() and chunked_reader
+//
+
+#include <boost/multi_array/chunked.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef boost::multi_array<double,3> array;
+typedef array::index_range range;
+
+double value(array::index i, array::index j, array::index k) {
+  return double(i*10000 + j*100 + k) / 8;
+}
+
+int
+main()
+{
+  array A(boost::extents[9][10][11]);
+  for (array::index i = 0; i != 9; ++i)
+    for (array::index j = 0; j != 10; ++j)
+      for (array::index k = 0; k != 11; ++k)
+        A[i][j][k] = value(i,j,k);
+  boost::array<array::size_type,3> chunk_extents = {{4,3,5}};
+
+  // round trip, with edge chunks, one thread and several
+  for (unsigned threads = 1; threads <= 4; threads += 3) {
+    std::stringstream stream;
+    boost::save_chunked(stream,A,chunk_extents,threads);
+    // the smooth data compresses
+    BOOST_TEST(stream.str().size() < A.num_elements() * sizeof(double));
+
+    boost::chunked_reader<double,3> reader(stream);
+    BOOST_TEST(reader.shape()[0] == 9 && reader.shape()[2] == 11);
+    BOOST_TEST(reader.chunk_shape()[1] == 3);
+    BOOST_TEST(reader.num_chunks() == 3*4*3);
+    array B;
+    reader.read(B);
+    BOOST_TEST(B == A);
+  }
+
+  // regions: strided, reversed and reduced in rank
+  {
+    std::stringstream stream;
+    boost::save_chunked(stream,A,chunk_extents);
+    boost::chunked_reader<double,3> reader(stream);
+
+    array B;
+    reader.read(boost::indices[range(1,8,3)][range(9,-1,-4)][range(2,11)],B);
+    BOOST_TEST(B.shape()[0] == 3 && B.shape()[1] == 3 && B.shape()[2] == 9);
+    BOOST_TEST(B == A[boost::indices[range(1,8,3)][range(9,-1,-4)]
+                                    [range(2,11)]]);
+
+    boost::multi_array<double,2> P;
+    reader.read(boost::indices[range()][7][range(0,11,2)],P);
+    BOOST_TEST(P == A[boost::indices[range()][7][range(0,11,2)]]);
+
+    // into a view of a larger array
+    boost::multi_array<double,2> Q(boost::extents[5][12]);
+    reader.read(boost::indices[3][range(0,10,2)][range(0,6)],
+                Q[boost::indices[range()][range(0,12,2)]]);
+    for (array::index j = 0; j != 5; ++j)
+      for (array::index k = 0; k != 6; ++k)
+        BOOST_TEST(Q[j][2*k] == value(3,2*j,k));
+  }
+
+  // saving a strided view; the writer gathers its elements
+  {
+    std::stringstream stream;
+    boost::save_chunked(stream,A[boost::indices[range(8,-1,-2)][range()][5]],
+                        std::vector<std::size_t>(2,3));
+    boost::chunked_reader<double,2> reader(stream);
+    boost::multi_array<double,2> B;
+    reader.read(B);
+    BOOST_TEST(B == A[boost::indices[range(8,-1,-2)][range()][5]]);
+  }
+
+  // data that does not compress is stored
+  {
+    boost::multi_array<unsigned,1> N(boost::extents[4096]);
+    unsigned x = 12345;
+    for (std::size_t i = 0; i != N.num_elements(); ++i)
+      N[i] = x = x * 1103515245u + 12345u;
+    std::stringstream stream;
+    boost::save_chunked(stream,N,std::vector<std::size_t>(1,1000));
+    boost::chunked_reader<unsigned,1> reader(stream);
+    boost::multi_array<unsigned,1> M;
+    reader.read(M);
+    BOOST_TEST(M == N);
+  }
+
+  // corruption and mismatches
+  {
+    std::stringstream stream;
+    boost::save_chunked(stream,A,chunk_extents);
+    std::string bytes = stream.str();
+
+    std::stringstream wrong_type(bytes);
+    typedef boost::chunked_reader<float,3> float_reader;
+    BOOST_TEST_THROWS(float_reader reader(wrong_type),
+                      std::ios_base::failure);
+
+    typedef boost::chunked_reader<double,3> reader_type;
+
+    // a truncated stream: the last chunk ends past it
+    std::stringstream truncated(bytes.substr(0,bytes.size() - 20));
+    BOOST_TEST_THROWS(reader_type reader(truncated),std::ios_base::failure);
+
+    // extents whose product wraps: 4 * (2^62 + 1) elements
+    std::string wrapped = bytes;
+    const boost::uint64_t huge = (boost::uint64_t(1) << 62) + 1;
+    const boost::uint64_t four = 4, one = 1;
+    std::memcpy(&wrapped[16],&huge,8);
+    std::memcpy(&wrapped[24],&four,8);
+    std::memcpy(&wrapped[32],&one,8);
+    std::stringstream wraps(wrapped);
+    BOOST_TEST_THROWS(reader_type reader(wraps),std::ios_base::failure);
+
+    // a chunk index entry that points past the stream
+    std::string misplaced = bytes;
+    const boost::uint64_t far = boost::uint64_t(1) << 40;
+    std::memcpy(&misplaced[65],&far,8);
+    std::stringstream points_away(misplaced);
+    BOOST_TEST_THROWS(reader_type reader(points_away),
+                      std::ios_base::failure);
+
+    // damaged chunk data
+    bytes[bytes.size() - 40] ^= 0x5a;
+    bytes[bytes.size() - 30] ^= 0x5a;
+    bytes[bytes.size() - 20] ^= 0x5a;
+    std::stringstream damaged(bytes);
+    reader_type reader(damaged);
+    array B(boost::extents[2][2][2]);
+    std::fill(B.data(),B.data() + B.num_elements(),7.0);
+    BOOST_TEST_THROWS(reader.read(B),std::ios_base::failure);
+
+    // a multi_array destination is left as it was
+    BOOST_TEST(B.num_elements() == 8 && B.shape()[0] == 2);
+    BOOST_TEST(std::count(B.data(),B.data() + 8,7.0) == 8);
+    BOOST_TEST_THROWS(reader.read(boost::indices[range()][range()][range()],
+                                  B),
+                      std::ios_base::failure);
+    BOOST_TEST(B.num_elements() == 8 && B.shape()[2] == 2);
+  }
+
+  return boost::report_errors();
+}
@@ -19,14 +19,17 @@
 
 #include <boost/multi_array.hpp>
 #include <algorithm>
+#include <limits>
 #include <list>
+#include <stdexcept>
 
-void check_shape(const double&, std::size_t*, int*, unsigned int)
+void check_shape(const double&, boost::multi_array_types::size_type*, int*,
+                 unsigned int)
 {}
 
 template <class Array>
 void check_shape(const Array& A,
-                 std::size_t* sizes,
+                 boost::multi_array_types::size_type* sizes,
                  int* strides,
                  unsigned int num_elements)
 {
@@ -212,6 +215,39 @@ main()
     BOOST_TEST(::equal(A[1][0],C));
     BOOST_TEST(::equal(B[0],C));
   }
+
+  // shapes with more elements than the index type can count are refused
+  // rather than wrapping, before anything is allocated
+  {
+    typedef boost::multi_array<char,2> array;
+    typedef array::size_type size_type;
+    const size_type half = size_type(1) << (sizeof(size_type) * 4);
+    const size_type most =
+      size_type((std::numeric_limits<array::index>::max)());
+
+    BOOST_TEST_THROWS(array(boost::extents[half][half]), std::length_error);
+    typedef boost::multi_array<char,3> array3;
+    BOOST_TEST_THROWS(array3(boost::extents[0][half][half]),
+                      std::length_error);
+
+    char c = 0;
+    BOOST_TEST_THROWS(
+      (boost::multi_array_ref<char,2>(&c,boost::extents[2][most])),
+      std::length_error);
+
+    // neither a resize that moves the elements nor one in place
+    // changes the array when it throws
+    array A(boost::extents[2][3]);
+    BOOST_TEST_THROWS(A.resize(boost::extents[2][most]), std::length_error);
+    BOOST_TEST_THROWS(A.resize(boost::extents[most][3]), std::length_error);
+    BOOST_TEST(A.num_elements() == 6);
+    BOOST_TEST(A.shape()[0] == 2 && A.shape()[1] == 3);
+
+    // the largest count the index type allows is accepted; a reference
+    // allocates nothing
+    boost::multi_array_ref<char,2> R(&c,boost::extents[1][most]);
+    BOOST_TEST(R.num_elements() == most);
+  }
   return boost::report_errors();
 }
 
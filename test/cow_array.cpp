@@ -0,0 +1,99 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// cow_array.cpp - Test of cow_multi_array
+//
+
+#include <boost/multi_array/cow_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+typedef boost::cow_multi_array<int,3> cow_type;
+typedef boost::multi_array_types::extent_range range;
+
+// a reader stage takes a const_multi_array_ref
+int sum(const boost::const_multi_array_ref<int,3>& a) {
+  int result = 0;
+  for (std::size_t i = 0; i != a.num_elements(); ++i)
+    result += a.data()[i];
+  return result;
+}
+
+int
+main()
+{
+  // constructed as a multi_array is
+  {
+    cow_type A(boost::extents[2][3][4]);
+    BOOST_TEST(A.num_elements() == 24);
+    BOOST_TEST(A.shape()[1] == 3);
+    BOOST_TEST(A.unique());
+
+    boost::array<int,3> shape = {{4,3,2}};
+    cow_type B(shape,boost::fortran_storage_order());
+    BOOST_TEST(B.strides()[0] == 1);
+
+    boost::multi_array<int,3> source(boost::extents[2][2][2]);
+    source[1][1][1] = 5;
+    cow_type C(source);
+    BOOST_TEST(C[1][1][1] == 5);
+    BOOST_TEST(C.data() != source.data());
+  }
+
+  // copies share until modified
+  {
+    cow_type A(boost::extents[range(1,3)][3][4]);
+    int n = 0;
+    boost::multi_array<int,3>& a = A.modify();
+    for (int* p = a.data(); p != a.data() + a.num_elements(); ++p)
+      *p = n++;
+
+    cow_type B = A;
+    cow_type C;
+    C = B;
+    BOOST_TEST(A.use_count() == 3);
+    BOOST_TEST(B.data() == A.data());
+    BOOST_TEST(C.index_bases()[0] == 1);
+
+    const boost::const_multi_array_ref<int,3> view = B.view();
+    BOOST_TEST(view.data() == A.data());
+    BOOST_TEST(view.index_bases()[0] == 1);
+    BOOST_TEST(view[2][2][3] == 23);
+    BOOST_TEST(sum(B.view()) == 23 * 24 / 2);
+
+    // the first modification detaches, copying index bases and elements
+    B.modify()[1][0][0] = 100;
+    BOOST_TEST(B.data() != A.data());
+    BOOST_TEST(B.unique());
+    BOOST_TEST(A.use_count() == 2);
+    BOOST_TEST(B[1][0][0] == 100);
+    BOOST_TEST(A[1][0][0] == 0);
+    BOOST_TEST(C[1][0][0] == 0);
+    BOOST_TEST(B.index_bases()[0] == 1);
+
+    // an unshared array is modified in place
+    const int* before = B.data();
+    B.modify()[2][0][0] = 7;
+    BOOST_TEST(B.data() == before);
+
+    // the last copy to go frees the elements
+    {
+      cow_type D = C;
+      BOOST_TEST(C.use_count() == 3);
+    }
+    BOOST_TEST(C.use_count() == 2);
+    A = B;
+    BOOST_TEST(C.unique());
+    BOOST_TEST(A.use_count() == 2);
+
+    swap(A,C);
+    BOOST_TEST(A[1][0][0] == 0);
+    BOOST_TEST(C[1][0][0] == 100);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,145 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// delta.cpp - Test of save_delta and apply_delta
+//
+
+#include <boost/multi_array/delta.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <ios>
+#include <sstream>
+#include <string>
+
+typedef boost::multi_array<double,3> array;
+typedef boost::multi_array_types::index_range range;
+
+int
+main()
+{
+  array A(boost::extents[20][30][40]);
+  for (std::size_t i = 0; i != A.num_elements(); ++i)
+    A.data()[i] = double(i);
+
+  // identical arrays: an empty delta
+  {
+    array B = A;
+    std::stringstream delta;
+    BOOST_TEST_EQ(boost::save_delta(delta,A,B), 0u);
+    array C = A;
+    boost::apply_delta(delta,C);
+    BOOST_TEST(C == A);
+  }
+
+  // a few scattered changes, a changed run crossing rows, and changes
+  // at both ends
+  array B = A;
+  B[0][0][0] = -1;
+  B[3][7][11] = -2;
+  for (int k = 35; k != 40; ++k)
+    B[5][2][k] = -3;
+  for (int k = 0; k != 3; ++k)
+    B[5][3][k] = -4;
+  B[19][29][39] = -5;
+  const std::size_t changed = 1 + 1 + 5 + 3 + 1;
+
+  std::stringstream delta;
+  BOOST_TEST_EQ(boost::save_delta(delta,A,B), changed);
+  const std::string bytes = delta.str();
+  BOOST_TEST(bytes.size() < changed * sizeof(double) + 120);
+
+  {
+    array C = A;
+    boost::apply_delta(delta,C);
+    BOOST_TEST(C == B);
+  }
+
+  // between and into arrays of other storage orders
+  {
+    array F(boost::extents[20][30][40],boost::fortran_storage_order());
+    F = A;
+    array G(boost::extents[20][30][40],boost::fortran_storage_order());
+    G = B;
+    std::stringstream fortran;
+    BOOST_TEST_EQ(boost::save_delta(fortran,F,G), changed);
+    BOOST_TEST(fortran.str() == bytes);
+
+    array H = F;
+    delta.clear();
+    delta.seekg(0);
+    boost::apply_delta(delta,H);
+    BOOST_TEST(H == B);
+  }
+
+  // views: the delta of a strided, reversed subset
+  {
+    array::const_array_view<3>::type from =
+      A[boost::indices[range(19,-1,-2)][range(0,30,3)][range()]];
+    array::const_array_view<3>::type to =
+      B[boost::indices[range(19,-1,-2)][range(0,30,3)][range()]];
+    std::stringstream view_delta;
+    // of the changes only B[5][3][0..2] are on an odd row and a row
+    // that is a multiple of 3
+    BOOST_TEST_EQ(boost::save_delta(view_delta,from,to), 3u);
+    array C = A;
+    boost::apply_delta(view_delta,
+      C[boost::indices[range(19,-1,-2)][range(0,30,3)][range()]]);
+    BOOST_TEST(C[5][3][2] == -4);
+    BOOST_TEST(C[5][2][37] == A[5][2][37]);
+
+    array::const_array_view<3>::type from2 =
+      A[boost::indices[range()][range(2,4)][range(30,40)]];
+    array::const_array_view<3>::type to2 =
+      B[boost::indices[range()][range(2,4)][range(30,40)]];
+    std::stringstream view_delta2;
+    BOOST_TEST_EQ(boost::save_delta(view_delta2,from2,to2), 5u);
+
+    C = A;
+    boost::apply_delta(view_delta2,
+      C[boost::indices[range()][range(2,4)][range(30,40)]]);
+    BOOST_TEST(C[5][2][37] == -3);
+    BOOST_TEST(C[5][3][0] == A[5][3][0]);
+    boost::multi_array_ref<double,3> ref(C.data(),boost::extents[20][30][40]);
+    BOOST_TEST(ref[5][2][39] == -3);
+  }
+
+  // a long run, crossing memcmp blocks and rows
+  {
+    array D = A;
+    for (std::size_t i = 1000; i != 1500; ++i)
+      D.data()[i] = -double(i);
+    std::stringstream long_delta;
+    BOOST_TEST_EQ(boost::save_delta(long_delta,A,D), 500u);
+    array C = A;
+    boost::apply_delta(long_delta,C);
+    BOOST_TEST(C == D);
+  }
+
+  // errors
+  {
+    boost::multi_array<double,3> wrong(boost::extents[20][30][41]);
+    delta.clear();
+    delta.seekg(0);
+    BOOST_TEST_THROWS(boost::apply_delta(delta,wrong),
+                      std::ios_base::failure);
+    boost::multi_array<float,3> other(boost::extents[20][30][40]);
+    delta.clear();
+    delta.seekg(0);
+    BOOST_TEST_THROWS(boost::apply_delta(delta,other),
+                      std::ios_base::failure);
+    std::stringstream truncated(bytes.substr(0,bytes.size() - 10));
+    array C = A;
+    BOOST_TEST_THROWS(boost::apply_delta(truncated,C),
+                      std::ios_base::failure);
+    std::stringstream saved;
+    boost::save(saved,A);
+    BOOST_TEST_THROWS(boost::apply_delta(saved,C),
+                      std::ios_base::failure);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,140 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// dirty_tiles.cpp - Test of dirty_tracked_array and incremental
+// checkpoints
+//
+
+#include <boost/multi_array/dirty_tiles.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <ios>
+#include <sstream>
+#include <vector>
+
+typedef boost::multi_array<int,3> array;
+typedef boost::dirty_tracked_array<int,3> tracked;
+typedef boost::multi_array_types::index_range range;
+typedef boost::multi_array_types::extent_range extent_range;
+
+int
+main()
+{
+  // A 10x9x7 array with index bases 1,0,-2, in tiles of 4x4x4: a grid
+  // of 3x3x2 tiles.
+  array A(boost::extents[extent_range(1,11)][9][extent_range(-2,5)]);
+  for (std::size_t i = 0; i != A.num_elements(); ++i)
+    A.data()[i] = int(i);
+  const boost::array<std::size_t,3> tile_extents = {{4,4,4}};
+
+  std::stringstream full;
+  boost::save(full,A);
+
+  tracked T(A,tile_extents);
+  BOOST_TEST(T.num_tiles() == 18);
+  BOOST_TEST(T.tile_counts()[2] == 2);
+  BOOST_TEST(T.num_dirty() == 0);
+
+  // reading marks nothing
+  boost::array<array::index,3> idx = {{10,8,4}};
+  BOOST_TEST(T(idx) == A(idx));
+  BOOST_TEST(T[1][0][-2] == 0);
+  BOOST_TEST(T.array()[10][8][4] == A[10][8][4]);
+  BOOST_TEST(T.num_dirty() == 0);
+
+  // writes through operator() and operator[]: last tile, first tile
+  T(idx) = -1;
+  BOOST_TEST(A[10][8][4] == -1);
+  BOOST_TEST(T.is_dirty(17));
+  T[1][0][-2] += 5;
+  BOOST_TEST(A[1][0][-2] == 5);
+  BOOST_TEST(T.is_dirty(0));
+  BOOST_TEST(T.num_dirty() == 2);
+
+  // a view marks every tile it touches: rows 5..8 of dimension 0 are
+  // tile 1, and the degenerate index 3 of dimension 2 is tile 1
+  T.view(boost::indices[range(5,9)][range(0,9,4)][3])[0][0] = 42;
+  BOOST_TEST(A[5][0][3] == 42);
+  std::vector<array::size_type> dirty = T.dirty_tiles();
+  BOOST_TEST_EQ(dirty.size(), 5u);
+  BOOST_TEST(T.is_dirty(1*6 + 0*2 + 1));
+  BOOST_TEST(T.is_dirty(1*6 + 1*2 + 1));
+  BOOST_TEST(T.is_dirty(1*6 + 2*2 + 1));
+  BOOST_TEST(!T.is_dirty(1*6 + 0*2 + 0));
+
+  // an empty selection marks nothing
+  T.mark_dirty(boost::indices[range(3,3)][range()][range()]);
+  BOOST_TEST(T.num_dirty() == 5);
+
+  // tile regions, relative to the index bases
+  boost::array<array::index,3> start;
+  boost::array<array::size_type,3> extents;
+  T.tile_region(17,start.data(),extents.data());
+  BOOST_TEST(start[0] == 8 && start[1] == 8 && start[2] == 4);
+  BOOST_TEST(extents[0] == 2 && extents[1] == 1 && extents[2] == 3);
+
+  // an increment holds the dirty tiles, and clears them
+  std::stringstream increment;
+  boost::save_dirty_tiles(increment,T);
+  BOOST_TEST(T.num_dirty() == 0);
+
+  // the full checkpoint, then the increment, restores A
+  array B;
+  boost::load(full,B);
+  const boost::array<array::index,3> bases = {{1,0,-2}};
+  B.reindex(bases);
+  BOOST_TEST(B != A);
+  boost::load_dirty_tiles(increment,B);
+  BOOST_TEST(B == A);
+
+  // into a view of another storage order
+  {
+    // load() gives C the saved index bases
+    array C(boost::extents[10][9][7],boost::fortran_storage_order());
+    full.clear();
+    full.seekg(0);
+    boost::load(full,C);
+    increment.clear();
+    increment.seekg(0);
+    boost::load_dirty_tiles(increment,
+      C[boost::indices[range()][range()][range()]]);
+    BOOST_TEST(C[10][8][4] == -1);
+    BOOST_TEST(C[5][0][3] == 42);
+    BOOST_TEST(C == A);
+  }
+
+  // mark_all_dirty writes everything
+  {
+    T.mark_all_dirty();
+    std::stringstream all;
+    boost::save_dirty_tiles(all,T);
+    array D(boost::extents[extent_range(1,11)][9][extent_range(-2,5)]);
+    boost::load_dirty_tiles(all,D);
+    BOOST_TEST(D == A);
+  }
+
+  // errors
+  {
+    typedef boost::multi_array<int,2> matrix;
+    matrix M(boost::extents[10][9]);
+    increment.clear();
+    increment.seekg(0);
+    BOOST_TEST_THROWS(boost::load_dirty_tiles(increment,M),
+                      std::ios_base::failure);
+    array E(boost::extents[10][9][6]);
+    increment.clear();
+    increment.seekg(0);
+    BOOST_TEST_THROWS(boost::load_dirty_tiles(increment,E),
+                      std::ios_base::failure);
+    full.clear();
+    full.seekg(0);
+    BOOST_TEST_THROWS(boost::load_dirty_tiles(full,B),
+                      std::ios_base::failure);
+  }
+
+  return boost::report_errors();
+}
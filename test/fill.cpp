@@ -0,0 +1,129 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// fill.cpp - Test of fill_elements() and fill_elements_with() on arrays,
+// subarrays and views
+//
+
+// exercise the streaming path on small arrays
+#define BOOST_MULTI_ARRAY_STREAMING_FILL_BYTES 256
+
+#include <boost/multi_array.hpp>
+#include <boost/multi_array/fill.hpp>
+// Boost.Range puts its own fill in namespace boost
+#include <boost/range/algorithm.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <string>
+
+struct counter {
+  counter() : next(0) { }
+  int operator()() { return next++; }
+  int next;
+};
+
+template <typename Array, typename T>
+bool all_equal(const Array& A, const T& value) {
+  for (const T* p = A.data(); p != A.data() + A.num_elements(); ++p)
+    if (*p != value) return false;
+  return true;
+}
+
+int
+main()
+{
+  typedef boost::multi_array<double,3> array3;
+  typedef array3::index_range range;
+  boost::multi_array_types::index_gen indices;
+
+  // dense arrays in any storage order
+  {
+    array3 A(boost::extents[3][4][5]);
+    boost::fill_elements(A,1.5);
+    BOOST_TEST(all_equal(A,1.5));
+    boost::fill_elements(A,0.0);
+    BOOST_TEST(all_equal(A,0.0));
+
+    array3 F(boost::extents[3][4][5],boost::fortran_storage_order());
+    boost::fill_elements(F,-2.0);
+    BOOST_TEST(all_equal(F,-2.0));
+
+    bool ascending[] = {false,true,false};
+    array3::size_type ordering[] = {1,0,2};
+    array3 D(boost::extents[3][4][5],
+             boost::general_storage_order<3>(ordering,ascending));
+    boost::fill_elements(D,7.0);
+    BOOST_TEST(all_equal(D,7.0));
+  }
+
+  // large enough to take the streaming path, with an odd-sized tail
+  {
+    boost::multi_array<float,2> A(boost::extents[17][31]);
+    boost::fill_elements(A,3.25f);
+    BOOST_TEST(all_equal(A,3.25f));
+    boost::multi_array<char,1> C(boost::extents[1001]);
+    boost::fill_elements(C,'x');
+    BOOST_TEST(all_equal(C,'x'));
+  }
+
+  // subarrays and strided views leave the rest of the array alone
+  {
+    array3 A(boost::extents[3][4][5]);
+    boost::fill_elements(A,0.0);
+    boost::fill_elements(A[1],4.0);
+    boost::fill_elements(A[indices[range()][range(0,4,2)][range(4,-1,-2)]],9.0);
+    for (array3::index i = 0; i != 3; ++i)
+      for (array3::index j = 0; j != 4; ++j)
+        for (array3::index k = 0; k != 5; ++k) {
+          double expected = (i == 1) ? 4.0 : 0.0;
+          if (j % 2 == 0 && k % 2 == 0) expected = 9.0;
+          BOOST_TEST(A[i][j][k] == expected);
+        }
+  }
+
+  // non-zero index bases
+  {
+    typedef array3::extent_range erange;
+    array3 A(boost::extents[erange(1,3)][erange(-1,2)][2]);
+    boost::fill_elements(A,5.0);
+    BOOST_TEST(all_equal(A,5.0));
+    boost::fill_elements(A[indices[2][range()][range()]],6.0);
+    BOOST_TEST(A[1][0][0] == 5.0);
+    BOOST_TEST(A[2][-1][1] == 6.0);
+  }
+
+  // elements that are not trivially copyable
+  {
+    boost::multi_array<std::string,2> S(boost::extents[2][3]);
+    boost::fill_elements(S,std::string("abc"));
+    BOOST_TEST(all_equal(S,std::string("abc")));
+  }
+
+  // fill_elements_with visits elements in index order regardless of
+  // storage order
+  {
+    array3 F(boost::extents[2][3][4],boost::fortran_storage_order());
+    boost::fill_elements_with(F,counter());
+    int expected = 0;
+    for (array3::index i = 0; i != 2; ++i)
+      for (array3::index j = 0; j != 3; ++j)
+        for (array3::index k = 0; k != 4; ++k)
+          BOOST_TEST(F[i][j][k] == expected++);
+
+    array3 A(boost::extents[2][3][4]);
+    boost::fill_elements(A,-1.0);
+    boost::fill_elements_with(A[indices[range()][range(2,-1,-1)][range(1,3)]],
+                     counter());
+    BOOST_TEST(A[0][2][1] == 0);
+    BOOST_TEST(A[0][2][2] == 1);
+    BOOST_TEST(A[0][1][1] == 2);
+    BOOST_TEST(A[1][0][2] == 11);
+    BOOST_TEST(A[1][0][0] == -1.0);
+  }
+
+  return boost::report_errors();
+}
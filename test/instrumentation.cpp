@@ -0,0 +1,207 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// instrumentation.cpp - Test of the instrumentation hooks and collectors
+//
+
+#define BOOST_MULTI_ARRAY_INSTRUMENTATION
+#include <boost/multi_array.hpp>
+#include <boost/multi_array/instrumentation_collectors.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mai = boost::multi_array_instrumentation;
+
+typedef boost::multi_array<double,3> array;
+typedef boost::multi_array_types::index_range range;
+
+// records the events it sees
+struct recorder : mai::observer {
+  recorder() : open(0) { }
+
+  virtual void instant(const mai::event& e) { events.push_back(e); }
+  virtual boost::uint64_t begin(const mai::event&) { return ++open; }
+  virtual void end(const mai::event& e, boost::uint64_t token) {
+    BOOST_TEST(token == open);
+    --open;
+    events.push_back(e);
+  }
+
+  std::size_t count(mai::event_kind kind) const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i != events.size(); ++i)
+      if (events[i].kind == kind)
+        ++n;
+    return n;
+  }
+
+  const mai::event& last(mai::event_kind kind) const {
+    std::size_t i = events.size();
+    while (events[--i].kind != kind) { }
+    return events[i];
+  }
+
+  std::vector<mai::event> events;
+  boost::uint64_t open;
+};
+
+int
+main()
+{
+  // no observer by default; scoped_observer installs and restores
+  {
+    BOOST_TEST(mai::get_observer() == 0);
+    recorder r;
+    {
+      mai::scoped_observer scope(r);
+      BOOST_TEST(mai::get_observer() == &r);
+      array A(boost::extents[2][3][4]);
+    }
+    BOOST_TEST(mai::get_observer() == 0);
+    array B(boost::extents[2][3][4]);
+    BOOST_TEST(r.events.size() == 2);
+  }
+
+  // allocations and deallocations
+  {
+    recorder r;
+    mai::scoped_observer scope(r);
+    {
+      array A(boost::extents[2][3][4]);
+      BOOST_TEST(r.count(mai::allocation) == 1);
+      const mai::event& e = r.last(mai::allocation);
+      BOOST_TEST(e.elements == 24);
+      BOOST_TEST(e.bytes == 24 * sizeof(double));
+      BOOST_TEST(e.num_dimensions == 3);
+      BOOST_TEST(*e.element_type == typeid(double));
+    }
+    BOOST_TEST(r.count(mai::deallocation) == 1);
+    BOOST_TEST(r.last(mai::deallocation).bytes == 24 * sizeof(double));
+  }
+
+  // deep copies: one event each, not one per sub-array
+  {
+    array A(boost::extents[2][3][4]);
+    recorder r;
+    mai::scoped_observer scope(r);
+
+    array B(A);
+    BOOST_TEST(r.count(mai::copy) == 1);
+    BOOST_TEST(r.last(mai::copy).fast_path);
+    BOOST_TEST(r.last(mai::copy).source == mai::c_contiguous);
+    BOOST_TEST(r.last(mai::copy).elements == 24);
+
+    B = A;
+    BOOST_TEST(r.count(mai::copy) == 2);
+    BOOST_TEST(r.last(mai::copy).fast_path);
+
+    array F(boost::extents[2][3][4],boost::fortran_storage_order());
+    F = A;
+    BOOST_TEST(r.count(mai::copy) == 3);
+    BOOST_TEST(!r.last(mai::copy).fast_path);
+    BOOST_TEST(r.last(mai::copy).source == mai::c_contiguous);
+    BOOST_TEST(r.last(mai::copy).destination == mai::fortran_contiguous);
+
+    array::array_view<2>::type v = B[boost::indices[range(0,2)][1][range()]];
+    BOOST_TEST(r.count(mai::view_creation) == 1);
+    BOOST_TEST(r.last(mai::view_creation).elements == 8);
+    BOOST_TEST(r.last(mai::view_creation).num_dimensions == 2);
+    v = A[boost::indices[range(0,2)][2][range()]];
+    BOOST_TEST(r.count(mai::copy) == 4);
+    BOOST_TEST(r.last(mai::copy).source == mai::strided);
+    BOOST_TEST(r.last(mai::copy).destination == mai::strided);
+    BOOST_TEST(r.last(mai::copy).elements == 8);
+
+    boost::multi_array<double,2> C(v);
+    BOOST_TEST(r.count(mai::copy) == 5);
+    BOOST_TEST(r.last(mai::copy).destination == mai::c_contiguous);
+    BOOST_TEST(r.open == 0);
+  }
+
+  // resizes, in place or through a copy
+  {
+    array A(boost::extents[2][3][4]);
+    recorder r;
+    mai::scoped_observer scope(r);
+
+    A.resize(boost::extents[4][3][4]);
+    BOOST_TEST(r.count(mai::resize) == 1);
+    BOOST_TEST(r.last(mai::resize).fast_path);
+    BOOST_TEST(r.last(mai::resize).old_elements == 24);
+    BOOST_TEST(r.last(mai::resize).elements == 48);
+    BOOST_TEST(r.count(mai::copy) == 0);
+
+    r.events.clear();
+    A.resize(boost::extents[4][2][2]);
+    BOOST_TEST(r.count(mai::resize) == 1);
+    BOOST_TEST(!r.last(mai::resize).fast_path);
+    BOOST_TEST(r.count(mai::copy) == 1);
+    BOOST_TEST(r.count(mai::allocation) == 1);
+    BOOST_TEST(r.count(mai::deallocation) == 1);
+    // the copy ends inside the resize
+    BOOST_TEST(r.events.back().kind == mai::resize);
+  }
+
+  // the summary
+  {
+    mai::summary_collector summary;
+    {
+      mai::scoped_observer scope(summary);
+      array A(boost::extents[2][3][4]);
+      array B(boost::extents[2][3][4]);
+      B = A;
+      array C(A);
+      A.resize(boost::extents[2][2][2]);
+    }
+    BOOST_TEST(summary.get(mai::allocation).count == 4);
+    BOOST_TEST(summary.get(mai::deallocation).count == 4);
+    BOOST_TEST(summary.get(mai::copy).count == 3);
+    BOOST_TEST(summary.get(mai::copy).fast_paths == 2);
+    BOOST_TEST(summary.get(mai::resize).count == 1);
+    BOOST_TEST(summary.copies(mai::c_contiguous,mai::c_contiguous) == 2);
+    BOOST_TEST(summary.peak_bytes() == (3 * 24 + 8) * sizeof(double));
+
+    std::ostringstream os;
+    summary.report(os);
+    BOOST_TEST(os.str().find("allocation") != std::string::npos);
+    BOOST_TEST(os.str().find("c -> c: 2") != std::string::npos);
+
+    summary.reset();
+    BOOST_TEST(summary.get(mai::copy).count == 0);
+  }
+
+  // the Chrome trace
+  {
+    mai::chrome_trace_collector trace;
+    {
+      mai::scoped_observer scope(trace);
+      array A(boost::extents[2][3][4]);
+      array B(A);
+    }
+    // two allocations and two deallocations, each with a counter, and a
+    // copy
+    BOOST_TEST(trace.size() == 9);
+
+    std::ostringstream os;
+    trace.write(os);
+    const std::string json = os.str();
+    BOOST_TEST(json.find("{\"traceEvents\":[") == 0);
+    BOOST_TEST(json.find("\"ph\":\"X\",\"name\":\"copy\"") !=
+               std::string::npos);
+    BOOST_TEST(json.find("\"fast_path\":true") != std::string::npos);
+    BOOST_TEST(json.find("\"name\":\"allocated bytes\"") !=
+               std::string::npos);
+
+    trace.clear();
+    BOOST_TEST(trace.size() == 0);
+  }
+
+  return boost::report_errors();
+}
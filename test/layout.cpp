@@ -0,0 +1,152 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// layout.cpp - Test of the layout queries and of the flat copies and
+// comparisons they allow
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+typedef boost::multi_array<int,3> array;
+typedef boost::multi_array_types::index_range range;
+
+void fill(array& A) {
+  for (std::size_t i = 0; i != A.num_elements(); ++i)
+    A.data()[i] = int(i);
+}
+
+int
+main()
+{
+  // arrays, in either order, are contiguous
+  {
+    array A(boost::extents[2][3][4]);
+    BOOST_TEST(A.is_contiguous());
+    BOOST_TEST(A.is_c_contiguous());
+    BOOST_TEST(!A.is_f_contiguous());
+    BOOST_TEST(A.contiguous_inner_extent() == 24);
+    BOOST_TEST(A.memory_span() == 24);
+    array::collapsed_shape_type dims = A.collapsed_shape();
+    BOOST_TEST(dims.num_dims == 1);
+    BOOST_TEST(dims.extents[0] == 24);
+    BOOST_TEST(dims.strides[0] == 1);
+
+    array F(boost::extents[2][3][4],boost::fortran_storage_order());
+    BOOST_TEST(F.is_contiguous());
+    BOOST_TEST(!F.is_c_contiguous());
+    BOOST_TEST(F.is_f_contiguous());
+    BOOST_TEST(F.contiguous_inner_extent() == 1);
+    BOOST_TEST(F.memory_span() == 24);
+    BOOST_TEST(F.collapsed_shape().num_dims == 3);
+
+    // extents of one do not count, whatever their strides
+    array R(boost::extents[1][1][4]);
+    BOOST_TEST(R.is_c_contiguous());
+    BOOST_TEST(R.is_f_contiguous());
+
+    // descending storage: dense, but in neither order
+    bool ascending[] = { false, true, true };
+    array::size_type ordering[] = { 2, 1, 0 };
+    array D(boost::extents[2][3][4],
+            boost::general_storage_order<3>(ordering,ascending));
+    BOOST_TEST(D.is_contiguous());
+    BOOST_TEST(!D.is_c_contiguous());
+    BOOST_TEST(D.contiguous_inner_extent() == 12);
+    BOOST_TEST(D.memory_span() == 24);
+  }
+
+  // sub-arrays and views
+  {
+    array A(boost::extents[2][3][4]);
+    BOOST_TEST(A[1].is_c_contiguous());
+    BOOST_TEST(A[1].contiguous_inner_extent() == 12);
+    BOOST_TEST(A[1].memory_span() == 12);
+
+    array::array_view<3>::type rows =
+      A[boost::indices[range()][range(0,2)][range()]];
+    BOOST_TEST(!rows.is_contiguous());
+    BOOST_TEST(rows.contiguous_inner_extent() == 8);
+    BOOST_TEST(rows.memory_span() == 20);
+    BOOST_TEST(rows.collapsed_shape().num_dims == 2);
+
+    array::array_view<2>::type column = A[boost::indices[range()][range()][1]];
+    BOOST_TEST(!column.is_contiguous());
+    BOOST_TEST(column.contiguous_inner_extent() == 1);
+    BOOST_TEST(column.memory_span() == 21);
+
+    array::array_view<3>::type reversed =
+      A[boost::indices[range()][range()][range(3,-1,-1)]];
+    BOOST_TEST(reversed.is_contiguous());
+    BOOST_TEST(!reversed.is_c_contiguous());
+    BOOST_TEST(reversed.contiguous_inner_extent() == 1);
+    BOOST_TEST(reversed.memory_span() == 24);
+
+    array::array_view<3>::type none =
+      A[boost::indices[range()][range(1,1)][range()]];
+    BOOST_TEST(none.is_contiguous());
+    BOOST_TEST(none.is_c_contiguous());
+    BOOST_TEST(none.contiguous_inner_extent() == 0);
+    BOOST_TEST(none.memory_span() == 0);
+
+    // sub-arrays of arrays in other orders, reached through operator[]
+    // or an iterator
+    array F(boost::extents[2][3][4],boost::fortran_storage_order());
+    BOOST_TEST(!F[1].is_contiguous());
+    BOOST_TEST(!F.begin()->is_contiguous());
+    BOOST_TEST(F[1][2].memory_span() == 19);
+
+    bool ascending[] = { true, true, true };
+    array::size_type ordering[] = { 1, 2, 0 };
+    array G(boost::extents[2][3][4],
+            boost::general_storage_order<3>(ordering,ascending));
+    BOOST_TEST(G[1].is_contiguous());
+    BOOST_TEST(!G[1].is_c_contiguous());
+    BOOST_TEST(G.begin()->is_contiguous());
+    BOOST_TEST(!G[1][0].is_contiguous());
+  }
+
+  // copies and comparisons between arrays of the same layout, flat or
+  // not, agree with the element by element ones
+  {
+    array A(boost::extents[2][3][4]);
+    fill(A);
+
+    array B(boost::extents[2][3][4]);
+    B = A;
+    BOOST_TEST(B == A);
+    B[1][2][3] = -1;
+    BOOST_TEST(B != A);
+
+    array F(boost::extents[2][3][4],boost::fortran_storage_order());
+    F = A;
+    BOOST_TEST(F == A);
+    BOOST_TEST(F[1][2][3] == 23);
+
+    boost::const_multi_array_ref<int,3> Fr(F.data(),boost::extents[2][3][4],
+                                          boost::fortran_storage_order());
+    array G(Fr,boost::fortran_storage_order());
+    BOOST_TEST(G == F);
+
+    array::array_view<3>::type v =
+      B[boost::indices[range(0,1)][range()][range()]];
+    v = A[boost::indices[range(1,2)][range()][range()]];
+    BOOST_TEST(B[0] == A[1]);
+
+    array::array_view<3>::type w =
+      B[boost::indices[range()][range(0,2)][range()]];
+    w = A[boost::indices[range()][range(1,3)][range()]];
+    BOOST_TEST(B[1][0][0] == A[1][1][0]);
+    BOOST_TEST(B[1][1][3] == A[1][2][3]);
+
+    boost::multi_array<int,2> C(A[1]);
+    BOOST_TEST(C[2][3] == 23);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,131 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// mdspan.cpp - Test of conversions to and from std::mdspan
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/multi_array/mdspan.hpp>
+#include <boost/core/lightweight_test.hpp>
+
+#if defined(BOOST_MULTI_ARRAY_HAS_MDSPAN)
+
+#include <cstddef>
+
+int
+main()
+{
+  typedef boost::multi_array<int,3> array;
+  typedef array::index_range range;
+
+  array A(boost::extents[2][3][4]);
+  for (int i = 0; i != 2*3*4; ++i)
+    A.data()[i] = i;
+
+  // C ordered arrays, as layout_stride and as layout_right
+  {
+    auto m = boost::to_mdspan(A);
+    BOOST_TEST(m.data_handle() == A.data());
+    BOOST_TEST(m.extent(0) == 2 && m.extent(2) == 4);
+    BOOST_TEST(m.stride(0) == 12 && m.stride(2) == 1);
+    BOOST_TEST((m[1,2,3] == 23));
+    m[0,1,2] = -6;
+    BOOST_TEST(A[0][1][2] == -6);
+
+    auto r = boost::to_mdspan<std::layout_right>(A);
+    BOOST_TEST((r[1,0,1] == 13));
+
+    // static extents
+    auto s = boost::to_mdspan<std::layout_right,
+                              std::extents<std::ptrdiff_t,2,3,4> >(A);
+    static_assert(decltype(s)::extents_type::static_extent(1) == 3);
+    BOOST_TEST((s[1,1,1] == 17));
+
+    const array& cA = A;
+    auto c = boost::to_mdspan(cA);
+    static_assert(std::is_const_v<decltype(c)::element_type>);
+    BOOST_TEST((c[1,2,3] == 23));
+  }
+
+  // Fortran ordered arrays, subarrays and strided views
+  {
+    array F(boost::extents[2][3][4],boost::fortran_storage_order());
+    F[1][2][3] = 5;
+    auto f = boost::to_mdspan<std::layout_left>(F);
+    BOOST_TEST((f[1,2,3] == 5));
+
+    auto sub = boost::to_mdspan(A[1]);
+    BOOST_TEST(sub.rank() == 2);
+    BOOST_TEST((sub[2,3] == 23));
+
+    auto v = boost::to_mdspan(A[boost::indices[range()][range(0,3,2)][1]]);
+    BOOST_TEST(v.rank() == 2 && v.extent(1) == 2);
+    BOOST_TEST(v.stride(1) == 8);
+    BOOST_TEST((v[1,1] == 21));
+  }
+
+  // non-zero index bases: the mdspan starts at the first element
+  {
+    typedef array::extent_range erange;
+    array B(boost::extents[erange(1,3)][3][4]);
+    B[1][0][0] = 42;
+    auto b = boost::to_mdspan(B);
+    BOOST_TEST((b[0,0,0] == 42));
+  }
+
+  // empty arrays, whose strides may be zero, and dimensions of extent
+  // one, whose strides are never used
+  {
+    array E(boost::extents[3][0][4]);
+    auto e = boost::to_mdspan(E);
+    BOOST_TEST(e.extent(0) == 3 && e.extent(1) == 0 && e.extent(2) == 4);
+    BOOST_TEST(e.size() == 0);
+    BOOST_TEST(e.is_unique());
+    BOOST_TEST(boost::to_mdspan<std::layout_right>(E).size() == 0);
+    BOOST_TEST(boost::to_mdspan<std::layout_left>(E).size() == 0);
+
+    auto one = boost::to_mdspan(A[boost::indices[range(1,0,-1)][range()]
+                                                [range()]]);
+    BOOST_TEST(one.extent(0) == 1 && one.stride(0) == 1);
+    BOOST_TEST((one[0,2,3] == 23));
+  }
+
+  // mdspans as views
+  {
+    int raw[12];
+    for (int i = 0; i != 12; ++i) raw[i] = i;
+    std::mdspan<int,std::dextents<std::ptrdiff_t,2> > m(raw,3,4);
+    auto view = boost::make_array_view(m);
+    BOOST_TEST(view[2][3] == 11);
+    view[1][1] = 100;
+    BOOST_TEST(raw[5] == 100);
+
+    std::mdspan<const int,std::dextents<std::ptrdiff_t,2>,
+                std::layout_left> l(raw,3,4);
+    auto cview = boost::make_array_view(l);
+    BOOST_TEST(cview[1][1] == 4);
+    BOOST_TEST(cview[2][0] == 2);
+
+    // and back again
+    auto round_trip = boost::to_mdspan(view);
+    BOOST_TEST(round_trip.data_handle() == raw);
+    BOOST_TEST((round_trip[1,1] == 100));
+  }
+
+  return boost::report_errors();
+}
+
+#else
+
+#include <boost/config/pragma_message.hpp>
+
+BOOST_PRAGMA_MESSAGE("Skipping test: <mdspan> is not available")
+
+int main() { return 0; }
+
+#endif
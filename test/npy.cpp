@@ -0,0 +1,228 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// npy.cpp - Test of save_npy(), load_npy() and mapped_npy_array
+//
+
+#include <boost/multi_array/npy.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+typedef boost::multi_array<int,3> array;
+typedef array::index_range range;
+
+template <typename Array>
+void fill_pattern(Array& A) {
+  for (array::index i = 0; i != 2; ++i)
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k)
+        A[i][j][k] = int(i*100 + j*10 + k);
+}
+
+template <typename Array>
+bool has_pattern(const Array& A) {
+  for (array::index i = 0; i != 2; ++i)
+    for (array::index j = 0; j != 3; ++j)
+      for (array::index k = 0; k != 4; ++k)
+        if (A[i][j][k] != i*100 + j*10 + k) return false;
+  return true;
+}
+
+// a .npy file as NumPy would write it, around the given dictionary
+std::string npy_file(const std::string& dict, const void* data,
+                     std::size_t size) {
+  std::string text = dict;
+  text.append(64 - (10 + text.size() + 1) % 64,' ');
+  text += '\n';
+  std::string file("\x93NUMPY\x01\x00",8);
+  file += char(text.size() & 0xff);
+  file += char(text.size() >> 8);
+  return file + text + std::string(static_cast<const char*>(data),size);
+}
+
+int
+main()
+{
+  // the header NumPy expects
+  {
+    array A(boost::extents[2][3][4]);
+    fill_pattern(A);
+    std::stringstream stream;
+    boost::save_npy(stream,A);
+    const std::string bytes = stream.str();
+    BOOST_TEST(bytes.size() == 128 + 24*sizeof(int));
+    BOOST_TEST(bytes.compare(0,8,std::string("\x93NUMPY\x01\x00",8)) == 0);
+    BOOST_TEST(bytes[8] == 118 && bytes[9] == 0);
+    const std::string dict = bytes.substr(10,118);
+    const char order = boost::detail::multi_array::host_is_little_endian() ?
+      '<' : '>';
+    const std::string expected = std::string("{'descr': '") + order +
+      "i4', 'fortran_order': False, 'shape': (2, 3, 4), }";
+    BOOST_TEST(dict.compare(0,expected.size(),expected) == 0);
+    BOOST_TEST(dict.find_first_not_of(' ',expected.size()) == 117);
+    BOOST_TEST(dict[117] == '\n');
+    BOOST_TEST(std::memcmp(bytes.data() + 128,A.data(),24*sizeof(int)) == 0);
+
+    boost::multi_array<double,1> V(boost::extents[5]);
+    std::stringstream vstream;
+    boost::save_npy(vstream,V);
+    BOOST_TEST(vstream.str().find("'shape': (5,), }") != std::string::npos);
+  }
+
+  // C and Fortran ordered arrays round trip into either order
+  {
+    boost::general_storage_order<3> orders[] = {
+      boost::c_storage_order(), boost::fortran_storage_order()
+    };
+    for (int from = 0; from != 2; ++from)
+      for (int to = 0; to != 2; ++to) {
+        array A(boost::extents[2][3][4],orders[from]);
+        fill_pattern(A);
+        std::stringstream stream;
+        boost::save_npy(stream,A);
+        BOOST_TEST((stream.str().find("'fortran_order': True") !=
+                    std::string::npos) == (from == 1));
+        array B(boost::extents[1][1][1],orders[to]);
+        boost::load_npy(stream,B);
+        BOOST_TEST(has_pattern(B));
+      }
+  }
+
+  // strided views and subarrays
+  {
+    array A(boost::extents[4][3][8]);
+    for (array::index i = 0; i != 4; ++i)
+      for (array::index j = 0; j != 3; ++j)
+        for (array::index k = 0; k != 8; ++k)
+          A[i][j][k] = int(i*1000 + j*10 + k);
+    std::stringstream stream;
+    boost::save_npy(stream,
+                    A[boost::indices[range(0,4,2)][range()][range(7,-1,-2)]]);
+    array B(boost::extents[2][3][4]);
+    boost::load_npy(stream,B);
+    for (array::index i = 0; i != 2; ++i)
+      for (array::index j = 0; j != 3; ++j)
+        for (array::index k = 0; k != 4; ++k)
+          BOOST_TEST(B[i][j][k] == A[2*i][j][7-2*k]);
+
+    array C(boost::extents[2][3][8]);
+    stream.clear();
+    stream.seekg(0);
+    boost::load_npy(stream,C[boost::indices[range()][range()][range(0,8,2)]]);
+    BOOST_TEST(C[1][2][6] == A[2][2][1]);
+  }
+
+  // files written by NumPy: Fortran order, the other byte order, a
+  // different key order and Python 2 long integers
+  {
+    const short data[] = { 0x0100, 0x0200, 0x0300, 0x0400, 0x0500, 0x0600 };
+    const char order = boost::detail::multi_array::host_is_little_endian() ?
+      '>' : '<';
+    std::stringstream stream(npy_file(
+      std::string("{'shape': (2L, 3L), 'fortran_order': True, 'descr': '") +
+      order + "i2'}",data,sizeof(data)));
+    boost::multi_array<short,2> A;
+    boost::load_npy(stream,A);
+    BOOST_TEST(A.shape()[0] == 2 && A.shape()[1] == 3);
+    BOOST_TEST(A[0][0] == 1 && A[1][0] == 2 && A[0][1] == 3 &&
+               A[1][2] == 6);
+  }
+
+  // malformed and mismatching files
+  {
+    array A(boost::extents[2][3][4]);
+    std::stringstream stream;
+    boost::save_npy(stream,A);
+    const std::string bytes = stream.str();
+
+    boost::multi_array<float,3> F;
+    std::stringstream wrong_type(bytes);
+    BOOST_TEST_THROWS(boost::load_npy(wrong_type,F),std::ios_base::failure);
+
+    boost::multi_array<int,2> R;
+    std::stringstream wrong_rank(bytes);
+    BOOST_TEST_THROWS(boost::load_npy(wrong_rank,R),std::ios_base::failure);
+
+    array S(boost::extents[2][3][5]);
+    std::stringstream wrong_shape(bytes);
+    BOOST_TEST_THROWS(boost::load_npy(wrong_shape,
+                        S[boost::indices[range()][range()][range(0,5)]]),
+                      std::ios_base::failure);
+
+    // a failed load leaves the array as it was
+    array B(boost::extents[2][3][4]);
+    fill_pattern(B);
+    std::stringstream truncated(bytes.substr(0,bytes.size() - 1));
+    BOOST_TEST_THROWS(boost::load_npy(truncated,B),std::ios_base::failure);
+    BOOST_TEST(B.num_elements() == 24 && has_pattern(B));
+
+    std::stringstream garbage("not an npy file, not at all");
+    BOOST_TEST_THROWS(boost::load_npy(garbage,B),std::ios_base::failure);
+  }
+
+  // shapes too large: an extent past 2^64, and extents whose product
+  // wraps to 4 elements
+  {
+    const unsigned char data[16] = { 0 };
+    boost::multi_array<unsigned char,3> B(boost::extents[1][1][1]);
+    std::stringstream too_long(npy_file(
+      "{'descr': '|u1', 'fortran_order': False, "
+      "'shape': (18446744073709551616, 1, 1), }",data,sizeof(data)));
+    BOOST_TEST_THROWS(boost::load_npy(too_long,B),std::ios_base::failure);
+    std::stringstream wraps(npy_file(
+      "{'descr': '|u1', 'fortran_order': True, "
+      "'shape': (4611686018427387905, 4, 1), }",data,sizeof(data)));
+    BOOST_TEST_THROWS(boost::load_npy(wraps,B),std::ios_base::failure);
+    BOOST_TEST(B.num_elements() == 1);
+
+#ifdef BOOST_MULTI_ARRAY_HAS_MMAP
+    const char* path = "npy_test_wrapped.npy";
+    {
+      std::ofstream file(path,std::ios::binary);
+      file << npy_file("{'descr': '|u1', 'fortran_order': True, "
+                       "'shape': (4611686018427387905, 4, 1), }",
+                       data,sizeof(data));
+    }
+    typedef boost::mapped_npy_array<unsigned char,3> mapped;
+    BOOST_TEST_THROWS(mapped M(path),std::ios_base::failure);
+    std::remove(path);
+#endif
+  }
+
+#ifdef BOOST_MULTI_ARRAY_HAS_MMAP
+  // mapping a file in place
+  {
+    const char* path = "npy_test_mapped.npy";
+    array A(boost::extents[2][3][4],boost::fortran_storage_order());
+    fill_pattern(A);
+    {
+      std::ofstream file(path,std::ios::binary);
+      boost::save_npy(file,A);
+    }
+    {
+      boost::mapped_npy_array<int,3> M(path);
+      BOOST_TEST(M.storage_order() ==
+                 boost::general_storage_order<3>(
+                   boost::fortran_storage_order()));
+      BOOST_TEST(has_pattern(M));
+      const boost::const_multi_array_ref<int,3>& ref = M;
+      BOOST_TEST(ref.data() == M.data() && ref[1][2][3] == 123);
+    }
+    typedef boost::mapped_npy_array<double,3> wrong_type;
+    BOOST_TEST_THROWS(wrong_type M(path),std::ios_base::failure);
+    std::remove(path);
+  }
+#endif
+
+  return boost::report_errors();
+}
@@ -0,0 +1,202 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// paged_array.cpp - Test of paged_array
+//
+
+#include <boost/multi_array/paged_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/config/pragma_message.hpp>
+
+#ifndef BOOST_MULTI_ARRAY_HAS_PAGED_ARRAY
+
+BOOST_PRAGMA_MESSAGE("paged_array is not available, test skipped")
+
+int main() { return 0; }
+
+#else
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+typedef boost::paged_array<int,3> paged;
+typedef boost::array<paged::index,3> index3;
+typedef boost::multi_array_types::index_range range;
+
+int value(paged::index i, paged::index j, paged::index k) {
+  return int(i*10000 + j*100 + k);
+}
+
+// Overwrites the two 64-bit header fields at offset with a and b.
+void patch(const char* path, std::streamoff offset,
+           boost::uint64_t a, boost::uint64_t b) {
+  std::fstream f(path,std::ios_base::in | std::ios_base::out |
+                      std::ios_base::binary);
+  f.seekp(offset);
+  f.write(reinterpret_cast<const char*>(&a),sizeof(a));
+  f.write(reinterpret_cast<const char*>(&b),sizeof(b));
+}
+
+int
+main()
+{
+  const char* path = "paged_array_test.bin";
+  const index3 extents = {{10,9,7}};
+  const index3 tile_extents = {{4,4,4}};
+
+  {
+    paged A(path,extents,tile_extents,3);
+    BOOST_TEST(A.num_tiles() == 3*3*2);
+    BOOST_TEST(A.tile_counts()[1] == 3);
+    BOOST_TEST(A.num_elements() == 10*9*7);
+
+    // a fresh array is zero
+    index3 idx = {{9,8,6}};
+    BOOST_TEST(A.get(idx) == 0);
+
+    // write through the proxy, in row-major order: far more tiles than
+    // the cache holds, so dirty tiles are written back
+    for (idx[0] = 0; idx[0] != 10; ++idx[0])
+      for (idx[1] = 0; idx[1] != 9; ++idx[1])
+        for (idx[2] = 0; idx[2] != 7; ++idx[2])
+          A(idx) = value(idx[0],idx[1],idx[2]);
+    BOOST_TEST(A.statistics().writebacks != 0);
+    BOOST_TEST(A.statistics().misses != 0);
+
+    bool all = true;
+    for (idx[0] = 9; idx[0] >= 0; --idx[0])
+      for (idx[1] = 0; idx[1] != 9; ++idx[1])
+        for (idx[2] = 0; idx[2] != 7; ++idx[2])
+          all = all && A(idx) == value(idx[0],idx[1],idx[2]);
+    BOOST_TEST(all);
+
+    // proxy to proxy assignment
+    const index3 from = {{1,2,3}}, to = {{8,7,6}};
+    A(to) = A(from);
+    BOOST_TEST(A.get(to) == value(1,2,3));
+    A.set(to,value(8,7,6));
+  }
+
+  // reopen: everything was written back
+  {
+    paged A(path,2);
+    BOOST_TEST(A.shape()[0] == 10 && A.shape()[2] == 7);
+    BOOST_TEST(A.tile_shape()[1] == 4);
+    bool all = true;
+    index3 idx;
+    for (idx[0] = 0; idx[0] != 10; ++idx[0])
+      for (idx[1] = 0; idx[1] != 9; ++idx[1])
+        for (idx[2] = 0; idx[2] != 7; ++idx[2])
+          all = all && A.get(idx) == value(idx[0],idx[1],idx[2]);
+    BOOST_TEST(all);
+  }
+
+  // tiles: multi_array_refs with array-wide index bases
+  {
+    paged A(path,2);
+    const index3 position = {{2,1,1}};
+    {
+      paged::tile_handle t = A.tile(position);
+      boost::multi_array_ref<int,3>& tile = t.array();
+      BOOST_TEST(tile.index_bases()[0] == 8 && tile.index_bases()[1] == 4 &&
+                 tile.index_bases()[2] == 4);
+      // the edge tile is clipped
+      BOOST_TEST(tile.shape()[0] == 2 && tile.shape()[1] == 4 &&
+                 tile.shape()[2] == 3);
+      BOOST_TEST(tile[9][5][6] == value(9,5,6));
+
+      // slicing, views and iterators within the tile
+      boost::multi_array_ref<int,3>::array_view<2>::type row =
+        tile[boost::indices[9][range()][range(4,7,2)]];
+      BOOST_TEST(row[1][1] == value(9,5,6));
+      int sum = 0;
+      for (boost::multi_array_ref<int,3>::iterator i = tile.begin();
+           i != tile.end(); ++i)
+        sum += (*i)[4][4];
+      BOOST_TEST(sum == value(8,4,4) + value(9,4,4));
+
+      tile[8][4][4] = -1;
+      const index3 written = {{8,4,4}};
+      BOOST_TEST(A.get(written) == -1);
+    }
+
+    // every slot pinned: no room for another tile
+    {
+      const index3 p0 = {{0,0,0}}, p1 = {{0,0,1}}, p2 = {{1,0,0}};
+      paged::const_tile_handle t0 = A.const_tile(p0);
+      paged::const_tile_handle t1 = A.const_tile(p1);
+      paged::const_tile_handle copy = t1;
+      BOOST_TEST(copy.array()[3][3][6] == value(3,3,6));
+      BOOST_TEST_THROWS(A.const_tile(p2),std::length_error);
+    }
+    const index3 p2 = {{1,0,0}};
+    BOOST_TEST(A.const_tile(p2).array()[4][0][0] == value(4,0,0));
+  }
+
+  // the written tile survived
+  {
+    paged A(path,1);
+    index3 idx = {{8,4,4}};
+    BOOST_TEST(A.get(idx) == -1);
+
+    // walking along a dimension announces the next tile
+    idx[1] = idx[2] = 0;
+    for (idx[0] = 0; idx[0] != 10; ++idx[0])
+      A.get(idx);
+    BOOST_TEST(A.statistics().prefetches == 1);
+    idx[0] = 9;
+    for (idx[1] = 0; idx[1] != 9; ++idx[1])
+      A.get(idx);
+    BOOST_TEST(A.statistics().prefetches == 2);
+  }
+
+  // damaged headers are refused before anything is sized from them; the
+  // extents of a 4x4 float array are at byte 16, its tile extents at 32
+  {
+    typedef boost::paged_array<float,2> paged2;
+    const char* damaged = "paged_array_damaged.bin";
+    const boost::array<paged2::size_type,2> e = {{4,4}}, t = {{2,2}};
+    { paged2 B(damaged,e,t,1); }
+
+    // tile extents whose product wraps to one element
+    patch(damaged,32,274177,boost::uint64_t(67280421310721ULL));
+    BOOST_TEST_THROWS(paged2 B(damaged,1),std::ios_base::failure);
+
+    // extents whose product overflows
+    patch(damaged,32,2,2);
+    patch(damaged,16,boost::uint64_t(1) << 40,boost::uint64_t(1) << 40);
+    BOOST_TEST_THROWS(paged2 B(damaged,1),std::ios_base::failure);
+
+    // tiles larger than the file holds
+    patch(damaged,16,4,4);
+    patch(damaged,32,4,boost::uint64_t(1) << 40);
+    BOOST_TEST_THROWS(paged2 B(damaged,1),std::ios_base::failure);
+
+    // a file cut short of its last tile
+    patch(damaged,32,2,2);
+    { paged2 B(damaged,1); }
+    BOOST_TEST(::truncate(damaged,4096 + 3 * 4 * sizeof(float)) == 0);
+    BOOST_TEST_THROWS(paged2 B(damaged,1),std::ios_base::failure);
+    std::remove(damaged);
+  }
+
+  // not a paged array
+  {
+    std::ofstream other(path);
+    other << std::string(5000,'x');
+  }
+  BOOST_TEST_THROWS(paged A(path,1),std::ios_base::failure);
+  std::remove(path);
+  BOOST_TEST_THROWS(paged A(path,1),std::ios_base::failure);
+
+  return boost::report_errors();
+}
+
+#endif
@@ -56,6 +56,15 @@ main()
           BOOST_TEST(B[i][j][k] == *ptr);
           BOOST_TEST(C[i][j][k] == *ptr++);
         }
+
+    // the sub-arrays take their sizes from the reshaped array
+    BOOST_TEST(A.num_elements() == 24);
+    BOOST_TEST(A[0].num_elements() == 6);
+    BOOST_TEST(B[3][2].num_elements() == 2);
+    BOOST_TEST(C[1].num_elements() == 6);
+    BOOST_TEST(A.begin()->num_elements() == 6);
+    BOOST_TEST(A[1].begin()->num_elements() == 2);
+    BOOST_TEST((*(C.end() - 1)).num_elements() == 6);
   }
 
   // Ensure that index bases are preserved over reshape
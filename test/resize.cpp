@@ -122,6 +122,72 @@ int main() {
       ar.resize(boost::extents[range(-3, 3)]);
   }
 
+  // growing the slowest varying dimension keeps the allocation when the
+  // capacity allows it, and shrinking never reallocates
+  {
+    marray A(boost::extents[2][3][4]);
+    A.assign(A_data,A_data+(2*3*4));
+    BOOST_TEST(A.capacity() == 2*3*4);
+    A.reserve(5*3*4);
+    BOOST_TEST(A.capacity() == 5*3*4);
+    BOOST_TEST(std::equal(A_data,A_data+(2*3*4),A.data()));
+
+    const int* storage = A.data();
+    A.resize(boost::extents[4][3][4]);
+    BOOST_TEST(A.data() == storage);
+    BOOST_TEST(std::equal(A_data,A_data+(2*3*4),A.data()));
+    BOOST_TEST(std::accumulate(A.data()+(2*3*4),A.data()+(4*3*4),0) == 0);
+
+    A[3][2][3] = 42;
+    A.resize(boost::extents[1][3][4]);
+    BOOST_TEST(A.data() == storage);
+    BOOST_TEST(A.num_elements() == 1*3*4);
+    BOOST_TEST(std::equal(A_data,A_data+(1*3*4),A.data()));
+
+    // elements uncovered again are value-initialized
+    A.resize(boost::extents[4][3][4]);
+    BOOST_TEST(A.data() == storage);
+    BOOST_TEST(A[3][2][3] == 0);
+
+    // growing past the capacity moves the elements once
+    A.resize(boost::extents[8][3][4]);
+    BOOST_TEST(A.capacity() == 8*3*4);
+    BOOST_TEST(std::equal(A_data,A_data+(1*3*4),A.data()));
+    BOOST_TEST(A[7][2][3] == 0);
+
+    // a resize that moves the elements carries the new sizes over too
+    A.resize(boost::extents[2][5][4]);
+    BOOST_TEST(A.num_elements() == 2*5*4);
+    BOOST_TEST(A[1].num_elements() == 5*4);
+    BOOST_TEST(A[1][4].num_elements() == 4);
+  }
+
+  // the slowest varying dimension follows the storage order
+  {
+    marray A(boost::extents[4][3][2],boost::fortran_storage_order());
+    for (int i = 0; i != 4; ++i)
+      for (int j = 0; j != 3; ++j)
+        for (int k = 0; k != 2; ++k)
+          A[i][j][k] = i*100 + j*10 + k;
+    A.reserve(4*3*5);
+    const int* storage = A.data();
+    A.resize(boost::extents[4][3][5]);
+    BOOST_TEST(A.data() == storage);
+    for (int i = 0; i != 4; ++i)
+      for (int j = 0; j != 3; ++j)
+        for (int k = 0; k != 5; ++k)
+          BOOST_TEST(A[i][j][k] == (k < 2 ? i*100 + j*10 + k : 0));
+  }
+
+  // changing the index bases in place
+  {
+    typedef marray::extent_range range;
+    marray A(boost::extents[2][3][4]);
+    A.assign(A_data,A_data+(2*3*4));
+    A.resize(boost::extents[range(1,3)][range(-1,2)][4]);
+    BOOST_TEST(A[1][-1][0] == 0);
+    BOOST_TEST(A[2][1][3] == 23);
+  }
 
   return boost::report_errors();
 }
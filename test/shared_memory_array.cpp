@@ -0,0 +1,122 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// shared_memory_array.cpp - Test of shared_memory_array
+//
+
+#include <boost/multi_array/shared_memory_array.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/config/pragma_message.hpp>
+
+#ifndef BOOST_MULTI_ARRAY_HAS_SHARED_MEMORY_ARRAY
+
+BOOST_PRAGMA_MESSAGE("shared_memory_array is not available, test skipped")
+
+int main() { return 0; }
+
+#else
+
+#include <algorithm>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+typedef boost::shared_memory_array<float,3> frame_type;
+typedef boost::multi_array_types::extent_range range;
+
+int
+main()
+{
+  std::ostringstream unique;
+  unique << "/boost_multi_array_test_" << ::getpid();
+  const std::string name = unique.str();
+  frame_type::remove(name);
+
+  {
+    boost::multi_array<float,3> frame(boost::extents[4][3][2]);
+    for (std::size_t i = 0; i != frame.num_elements(); ++i)
+      frame.data()[i] = float(i);
+
+    frame_type producer(name,boost::extents[4][3][2]);
+    BOOST_TEST(producer.sequence() == 0);
+    BOOST_TEST(producer[3][2][1] == 0);
+
+    // a second mapping, as another process would have, sees the shape
+    // and the elements the first writes
+    frame_type consumer(name);
+    BOOST_TEST(consumer.num_dimensions() == 3);
+    BOOST_TEST(consumer.shape()[0] == 4);
+    BOOST_TEST(consumer.shape()[2] == 2);
+    BOOST_TEST(consumer.data() != producer.data());
+
+    producer.begin_update();
+    BOOST_TEST(consumer.sequence() == 1);
+    producer = frame;
+    producer.end_update();
+    const frame_type::sequence_type seen = consumer.sequence();
+    BOOST_TEST(seen == 2);
+    BOOST_TEST(std::equal(frame.data(),frame.data() + frame.num_elements(),
+                          consumer.data()));
+
+    // and a plain multi_array_ref can be bound to it
+    boost::multi_array_ref<float,3>& ref = consumer;
+    ref[1][1][1] = 42;
+    BOOST_TEST(producer[1][1][1] == 42);
+    BOOST_TEST(consumer.sequence() == seen);
+
+    // the name exists until removed
+    typedef boost::array<std::size_t,3> shape_type;
+    shape_type shape = {{1,1,1}};
+    BOOST_TEST_THROWS(frame_type(name,shape),std::ios_base::failure);
+  }
+
+  {
+    // index bases and storage order travel with the segment
+    frame_type::remove(name);
+    frame_type created(name,boost::extents[range(1,3)][range(-1,2)][2],
+                       boost::fortran_storage_order());
+    created[2][-1][1] = 7;
+    frame_type opened(name);
+    BOOST_TEST(opened.index_bases()[0] == 1);
+    BOOST_TEST(opened.index_bases()[1] == -1);
+    BOOST_TEST(opened.strides()[0] == 1);
+    BOOST_TEST(opened.storage_order() == boost::fortran_storage_order());
+    BOOST_TEST(opened[2][-1][1] == 7);
+
+    // opening as the wrong type fails
+    typedef boost::shared_memory_array<int,3> int_array;
+    typedef boost::shared_memory_array<float,2> matrix;
+    BOOST_TEST_THROWS((void)int_array(name),std::ios_base::failure);
+    BOOST_TEST_THROWS((void)matrix(name),std::ios_base::failure);
+  }
+
+  {
+    // shapes too large for the index type, or whose bytes do not fit
+    // std::size_t, are refused without leaving a segment behind
+    frame_type::remove(name);
+    typedef frame_type::size_type size_type;
+    const size_type half = size_type(1) << (sizeof(size_type) * 4);
+    BOOST_TEST_THROWS(frame_type(name,boost::extents[half][half][1]),
+                      std::length_error);
+    if (sizeof(size_type) == 8) {
+      const size_type quarter = size_type(1) << 31;
+      BOOST_TEST_THROWS(frame_type(name,boost::extents[quarter][quarter][1]),
+                        std::length_error);
+    }
+    BOOST_TEST_THROWS((void)frame_type(name),std::ios_base::failure);
+  }
+
+  frame_type::remove(name);
+  BOOST_TEST_THROWS((void)frame_type(name),std::ios_base::failure);
+
+  return boost::report_errors();
+}
+
+#endif
@@ -0,0 +1,134 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// slab_stream.cpp - Test of slab_reader and slab_writer
+//
+
+#include <boost/multi_array/slab_stream.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <sstream>
+#include <string>
+
+typedef boost::multi_array<int,3> array;
+
+int value(array::index i, array::index j, array::index k) { return int(i*10000 + j*100 + k); }
+
+// the slab holds exactly the rows [first,last) of the array
+bool holds(const boost::const_multi_array_ref<int,3>& slab,
+           array::index first, array::index last, array::index base) {
+  if (slab.index_bases()[0] != first ||
+      array::index(slab.shape()[0]) != last - first ||
+      slab.shape()[1] != 4 || slab.shape()[2] != 5)
+    return false;
+  for (array::index i = first; i != last; ++i)
+    for (array::index j = 0; j != 4; ++j)
+      for (array::index k = 0; k != 5; ++k)
+        if (slab[i][j][k] != value(i - base,j,k))
+          return false;
+  return true;
+}
+
+int
+main()
+{
+  array A(boost::extents[10][4][5]);
+  for (array::index i = 0; i != 10; ++i)
+    for (array::index j = 0; j != 4; ++j)
+      for (array::index k = 0; k != 5; ++k)
+        A[i][j][k] = value(i,j,k);
+
+  // slabs of three, the last one short
+  {
+    std::stringstream stream;
+    boost::save(stream,A);
+    boost::slab_reader<int,3> reader(stream,3);
+    BOOST_TEST(reader.num_slabs() == 4);
+    BOOST_TEST(reader.shape()[0] == 10);
+    array::index first = 0;
+    while (reader.next()) {
+      const array::index last = (std::min)(first + 3,array::index(10));
+      BOOST_TEST(holds(reader.slab(),first,last,0));
+      BOOST_TEST(reader.interior().start() == first &&
+                 reader.interior().finish() == last);
+      first = last;
+    }
+    BOOST_TEST(first == 10);
+    BOOST_TEST(!reader.next());
+  }
+
+  // halos of two, and array::index bases
+  {
+    array B(boost::extents[array::extent_range(5,15)][4][5]);
+    B = A;
+    std::stringstream stream;
+    boost::save(stream,B);
+    boost::slab_reader<int,3> reader(stream,3,2);
+    const array::index expected[][2] = { {5,10}, {6,13}, {9,15}, {12,15} };
+    for (int s = 0; s != 4; ++s) {
+      BOOST_TEST(reader.next());
+      BOOST_TEST(holds(reader.slab(),expected[s][0],expected[s][1],5));
+      BOOST_TEST(reader.interior().start() == 5 + 3*s);
+    }
+    BOOST_TEST(!reader.next());
+  }
+
+  // a raw stream, in one slab larger than the array
+  {
+    std::string bytes(reinterpret_cast<const char*>(A.data()),
+                      A.num_elements() * sizeof(int));
+    std::stringstream stream(bytes);
+    const boost::array<array::size_type,3> extents = {{10,4,5}};
+    boost::slab_reader<int,3> reader(stream,extents,100);
+    BOOST_TEST(reader.next());
+    BOOST_TEST(holds(reader.slab(),0,10,0));
+    BOOST_TEST(!reader.next());
+  }
+
+  // writing slab by slab produces what save() does
+  {
+    std::stringstream stream;
+    const boost::array<array::size_type,3> extents = {{10,4,5}};
+    {
+      boost::slab_writer<int,3> writer(stream,extents,4);
+      while (writer.next()) {
+        boost::multi_array_ref<int,3> slab = writer.slab();
+        for (array::index i = slab.index_bases()[0];
+             i != slab.index_bases()[0] + array::index(slab.shape()[0]); ++i)
+          for (array::index j = 0; j != 4; ++j)
+            for (array::index k = 0; k != 5; ++k)
+              slab[i][j][k] = value(i,j,k);
+      }
+      BOOST_TEST(!writer.next());
+    }
+    std::stringstream expected;
+    boost::save(expected,A);
+    BOOST_TEST(stream.str() == expected.str());
+
+    array B;
+    boost::load(stream,B);
+    BOOST_TEST(B == A);
+  }
+
+  // errors
+  {
+    array F(boost::extents[10][4][5],boost::fortran_storage_order());
+    std::stringstream fortran;
+    boost::save(fortran,F);
+    typedef boost::slab_reader<int,3> reader_type;
+    BOOST_TEST_THROWS(reader_type reader(fortran,3),std::ios_base::failure);
+
+    std::stringstream stream;
+    boost::save(stream,A);
+    std::stringstream truncated(stream.str().substr(0,
+                                  stream.str().size() - 4));
+    boost::slab_reader<int,3> reader(truncated,3);
+    BOOST_TEST_THROWS(while (reader.next()) { },std::ios_base::failure);
+  }
+
+  return boost::report_errors();
+}
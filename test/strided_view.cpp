@@ -0,0 +1,70 @@
+// Use, modification and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+//  Boost.MultiArray Library
+//  See http://www.boost.org/libs/multi_array for documentation.
+
+//
+// strided_view.cpp - Test of views over external memory with explicit
+// strides
+//
+
+#include <boost/multi_array.hpp>
+#include <boost/multi_array/fill.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/array.hpp>
+
+int
+main()
+{
+  typedef boost::multi_array_types::index index;
+  typedef boost::multi_array_types::size_type size_type;
+
+  // a 3x4 image stored with a row pitch of 6 pixels
+  int frame[3*6];
+  for (int i = 0; i != 3*6; ++i)
+    frame[i] = (i % 6 < 4) ? i : -1;
+
+  boost::array<size_type,2> shape = {{3,4}};
+  boost::array<index,2> pitched = {{6,1}};
+  boost::detail::multi_array::multi_array_view<int,2> image =
+    boost::make_array_view(frame,shape,pitched);
+  BOOST_TEST(image.num_elements() == 12);
+  BOOST_TEST(image[2][3] == 15);
+  BOOST_TEST(image[1][0] == 6);
+
+  // copies and fills go through the strides and never touch the padding
+  boost::multi_array<int,2> dense(image);
+  BOOST_TEST(dense[2][3] == 15);
+  boost::fill_elements(image,7);
+  BOOST_TEST(frame[4] == -1 && frame[5] == -1 && frame[17] == -1);
+  BOOST_TEST(frame[12] == 7 && frame[15] == 7);
+
+  // one channel of interleaved RGB data
+  unsigned char rgb[2*2*3] = { 1,2,3, 4,5,6, 7,8,9, 10,11,12 };
+  boost::array<size_type,2> pixels = {{2,2}};
+  boost::array<index,2> interleaved = {{6,3}};
+  boost::detail::multi_array::const_multi_array_view<unsigned char,2> green =
+    boost::make_const_array_view(rgb + 1,pixels,interleaved);
+  BOOST_TEST(green[0][0] == 2 && green[0][1] == 5);
+  BOOST_TEST(green[1][0] == 8 && green[1][1] == 11);
+
+  // negative strides: the same buffer seen upside down
+  boost::array<index,2> flipped = {{-6,1}};
+  boost::detail::multi_array::const_multi_array_view<int,2> upside_down =
+    boost::make_const_array_view(frame + 2*6,shape,flipped);
+  frame[2*6 + 1] = 99;
+  BOOST_TEST(upside_down[0][1] == 99);
+  BOOST_TEST(upside_down[2][0] == 7);
+
+  // views of strided views, and reindexing
+  boost::detail::multi_array::multi_array_view<int,1> column =
+    image[boost::indices[boost::multi_array_types::index_range()][2]];
+  BOOST_TEST(column.num_elements() == 3);
+  column.reindex(1);
+  column[3] = 5;
+  BOOST_TEST(frame[2*6 + 2] == 5);
+
+  return boost::report_errors();
+}